@@ -0,0 +1,23 @@
+#version 430
+
+// --- MUESTREO ADAPTATIVO: PASE GRUESO ---
+// Traza solo uno de cada u_step x u_step píxeles y guarda el RESULTADO del
+// rayo (no el color) en una rejilla pequeña. adaptive_refine.glsl decide
+// después, celda a celda, si basta con interpolar o hay que trazar todo.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform writeonly image2D imgCoarse;
+
+uniform ivec2 u_viewport;   // Tamaño de la imagen final
+uniform ivec2 u_coarseSize; // Puntos de la rejilla (cubre hasta el último píxel)
+uniform int u_step;
+
+#include "blackhole_common.glsl"
+
+void main() {
+    ivec2 coarse = ivec2(gl_GlobalInvocationID.xy);
+    if(coarse.x >= u_coarseSize.x || coarse.y >= u_coarseSize.y) return;
+
+    // El último punto puede caer fuera de la imagen: el rayo sigue siendo válido
+    vec2 uv = pixelUV(vec2(coarse * u_step), u_viewport);
+    imageStore(imgCoarse, coarse, traceOutcome(u_camPos, cameraRay(uv)));
+}
@@ -0,0 +1,117 @@
+#version 430
+
+// --- MUESTREO ADAPTATIVO: REFINADO ---
+// Cada píxel mira las 4 esquinas de su celda en la rejilla gruesa. Si las
+// esquinas "se parecen" (misma clase, deflexión suave, color parecido) se
+// interpola el resultado y se sombrea; si no, se traza la geodésica entera.
+// Todos los píxeles de una celda llegan a la misma decisión, así que el
+// trazado denso ocurre por bloques.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform writeonly image2D imgOutput;
+layout(rgba32f, binding = 1) uniform readonly image2D imgCoarse;
+
+// Rayos trazados en este pase (la CPU lo lee un frame después)
+layout(std430, binding = 3) buffer AdaptiveCounter {
+    uint tracedRays;
+};
+
+uniform ivec2 u_viewport;
+uniform ivec2 u_coarseSize;
+uniform int u_step;
+uniform float u_colorThreshold; // Diferencia máxima de color lineal entre esquinas
+
+#include "blackhole_common.glsl"
+
+// Deben coincidir con cpu_tracer.cpp
+const float MAX_DISK_RADIUS_SPAN = 0.15; // Saltos de radio en el disco (imágenes distintas)
+const float MAX_DISK_ANGLE_SPAN = 0.5;   // Radianes; también evita interpolar a través de ±π
+const float MAX_DEFLECTION_RATIO = 4.0;  // Apertura de salida / apertura de la cámara
+
+shared uint groupTraced;
+
+vec3 cornerRay(ivec2 coarse) {
+    return cameraRay(pixelUV(vec2(coarse * u_step), u_viewport));
+}
+
+// ¿Cambia la clase en los 4x4 puntos alrededor de la celda? Mirar también las
+// celdas vecinas recupera detalles finos (el anillo de fotones) que pasan
+// entre las 4 esquinas sin tocar ninguna.
+bool classChanges(ivec2 cell, float kind) {
+    for(int y = -1; y <= 2; y++) {
+        for(int x = -1; x <= 2; x++) {
+            ivec2 p = clamp(cell + ivec2(x, y), ivec2(0), u_coarseSize - 1);
+            if(imageLoad(imgCoarse, p).w != kind) return true;
+        }
+    }
+    return false;
+}
+
+bool needsRefine(vec4 o00, vec4 o10, vec4 o01, vec4 o11, ivec2 cell) {
+    // 1. Cambio de clase (borde de la sombra, borde del disco), también en las celdas vecinas
+    if(classChanges(cell, o00.w)) return true;
+    if(o00.w < OUTCOME_ESCAPED - 0.5) return false; // Todo sombra
+
+    if(o00.w > OUTCOME_DISK - 0.5) {
+        float minR = min(min(o00.x, o10.x), min(o01.x, o11.x));
+        float maxR = max(max(o00.x, o10.x), max(o01.x, o11.x));
+        float minA = min(min(o00.y, o10.y), min(o01.y, o11.y));
+        float maxA = max(max(o00.y, o10.y), max(o01.y, o11.y));
+        if(maxR - minR > MAX_DISK_RADIUS_SPAN || maxA - minA > MAX_DISK_ANGLE_SPAN) return true;
+    } else {
+        // 2. Gradiente de deflexión: cerca del anillo de fotones la lente amplifica
+        // muchísimo y la interpolación lineal de direcciones deja de valer
+        float outSpread = max(1.0 - dot(o00.xyz, o11.xyz), 1.0 - dot(o10.xyz, o01.xyz));
+        float camSpread = max(1.0 - dot(cornerRay(cell), cornerRay(cell + ivec2(1))),
+                              1.0 - dot(cornerRay(cell + ivec2(1, 0)), cornerRay(cell + ivec2(0, 1))));
+        if(outSpread > MAX_DEFLECTION_RATIO * MAX_DEFLECTION_RATIO * camSpread) return true;
+    }
+
+    // 3. Diferencia de color entre esquinas
+    vec3 c00 = shadeOutcome(o00, u_time), c10 = shadeOutcome(o10, u_time);
+    vec3 c01 = shadeOutcome(o01, u_time), c11 = shadeOutcome(o11, u_time);
+    vec3 lo = min(min(c00, c10), min(c01, c11));
+    vec3 hi = max(max(c00, c10), max(c01, c11));
+    return max(hi.r - lo.r, max(hi.g - lo.g, hi.b - lo.b)) > u_colorThreshold;
+}
+
+vec4 interpolateOutcome(vec4 o00, vec4 o10, vec4 o01, vec4 o11, vec2 f) {
+    vec4 o = mix(mix(o00, o10, f.x), mix(o01, o11, f.x), f.y);
+    if(o00.w > OUTCOME_DISK - 0.5) return vec4(o.xyz, OUTCOME_DISK);
+    if(o00.w > OUTCOME_ESCAPED - 0.5) return vec4(normalize(o.xyz), OUTCOME_ESCAPED);
+    return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+}
+
+void main() {
+    if(gl_LocalInvocationIndex == 0u) groupTraced = 0u;
+    barrier();
+
+    ivec2 pixel_coords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dims = u_viewport;
+    bool inside = pixel_coords.x < dims.x && pixel_coords.y < dims.y;
+
+    if(inside) {
+        ivec2 cell = pixel_coords / u_step;
+        ivec2 local = pixel_coords - cell * u_step;
+        vec4 o00 = imageLoad(imgCoarse, cell);
+
+        vec4 outcome;
+        if(local == ivec2(0)) {
+            outcome = o00; // Punto de la rejilla: ya trazado
+        } else {
+            vec4 o10 = imageLoad(imgCoarse, cell + ivec2(1, 0));
+            vec4 o01 = imageLoad(imgCoarse, cell + ivec2(0, 1));
+            vec4 o11 = imageLoad(imgCoarse, cell + ivec2(1, 1));
+            if(needsRefine(o00, o10, o01, o11, cell)) {
+                outcome = traceOutcome(u_camPos, cameraRay(pixelUV(vec2(pixel_coords), dims)));
+                atomicAdd(groupTraced, 1u);
+            } else {
+                outcome = interpolateOutcome(o00, o10, o01, o11, vec2(local) / float(u_step));
+            }
+        }
+        imageStore(imgOutput, pixel_coords, vec4(shadeOutcome(outcome, u_time), 1.0));
+    }
+
+    // Un solo atómico global por grupo
+    barrier();
+    if(gl_LocalInvocationIndex == 0u && groupTraced > 0u) atomicAdd(tracedRays, groupTraced);
+}
@@ -0,0 +1,131 @@
+// =========================================================
+//     SCHWARZSCHILD EN FORMA CERRADA (se incluye desde blackhole_common.glsl)
+// =========================================================
+// Solo se compila en la permutación con #define ANALYTIC (--analytic). Mismo
+// algoritmo que src/analytic.cpp: U = RS / r cumple (dU/dφ)² = U³ - U² + 1/B²
+// y se resuelve con funciones de Jacobi; el disco se busca en los nodos del
+// plano de la órbita (cada π). Sin bucle de MAX_STEPS.
+#include "elliptic.glsl"
+
+const int ANALYTIC_MAX_CROSSINGS = 4;
+const int ORBIT_OUTER = 0;   // Pasa por el periastro y vuelve al infinito
+const int ORBIT_INNER = 1;   // Dentro de la esfera de fotones, b por encima del crítico
+const int ORBIT_PLUNGE = 2;  // b por debajo del crítico
+
+struct Orbit {
+    int kind;
+    float u1, scale, m, K, rate, sign;
+    float xStart, xEnd;
+    bool captured;
+};
+
+float orbitInverse(Orbit o, float u) {
+    if (o.kind == ORBIT_OUTER) return ellipticF(asin(sqrt(clamp((u - o.u1) / o.scale, 0.0, 1.0))), o.m);
+    if (o.kind == ORBIT_INNER) return ellipticF(asin(sqrt(clamp(o.scale / (u - o.u1), 0.0, 1.0))), o.m);
+    float alpha = acos(clamp((u - o.u1 - o.scale) / (u - o.u1 + o.scale), -1.0, 1.0));
+    return alpha <= 1.5707963 ? ellipticF(alpha, o.m) : 2.0 * o.K - ellipticF(3.14159265 - alpha, o.m);
+}
+
+// (U, dU/dψ) en el parámetro x
+vec2 orbitAt(Orbit o, float x) {
+    if (o.kind == ORBIT_OUTER) {
+        vec3 j = jacobiSnCnDn(x, o.m);
+        return vec2(o.u1 + o.scale * j.x * j.x, 2.0 * o.rate * o.scale * j.x * j.y * j.z);
+    }
+    if (o.kind == ORBIT_INNER) {
+        vec3 j = jacobiSnCnDn(x, o.m);
+        return vec2(o.u1 + o.scale / (j.x * j.x), -2.0 * o.rate * o.scale * j.y * j.z / (j.x * j.x * j.x));
+    }
+    vec3 j = jacobiSnCnDn(o.sign * x, o.m);
+    float den = max(1.0 - j.y, 1e-12);
+    return vec2(o.u1 + o.scale * (1.0 + j.y) / den, -2.0 * o.scale * j.x * j.z / (den * den) * o.sign * o.rate);
+}
+
+Orbit solveOrbit(float beta, float u0, bool inward) {
+    Orbit o;
+    const float M_LIMIT = 1.0 - 1e-6;
+    float q = beta - 2.0 / 27.0;
+    if (q < 2.0 / 27.0) {
+        float theta = acos(clamp(-13.5 * q, -1.0, 1.0)) * (1.0 / 3.0);
+        float u3 = 1.0 / 3.0 + 2.0 / 3.0 * cos(theta);
+        float u2 = 1.0 / 3.0 + 2.0 / 3.0 * cos(theta - 2.0943951);
+        o.u1 = 1.0 / 3.0 + 2.0 / 3.0 * cos(theta - 4.1887902);
+        o.m = min((u2 - o.u1) / (u3 - o.u1), M_LIMIT);
+        o.K = ellipticK(o.m);
+        o.rate = 0.5 * sqrt(u3 - o.u1);
+        o.sign = 1.0;
+        if (u0 <= u2) {
+            o.kind = ORBIT_OUTER;
+            o.scale = u2 - o.u1;
+            float x0 = orbitInverse(o, u0);
+            o.xStart = inward ? x0 : 2.0 * o.K - x0;
+            o.xEnd = 2.0 * o.K - orbitInverse(o, 0.0);
+            o.captured = false;
+        } else {
+            o.kind = ORBIT_INNER;
+            o.scale = u3 - o.u1;
+            float x0 = orbitInverse(o, u0);
+            o.xStart = inward ? 2.0 * o.K - x0 : x0;
+            o.xEnd = 2.0 * o.K - orbitInverse(o, 1.0);
+            o.captured = true;
+        }
+    } else {
+        float disc = sqrt(q * q * 0.25 - 1.0 / 729.0);
+        float a = -0.5 * q + disc, b = -0.5 * q - disc;
+        o.u1 = sign(a) * pow(abs(a), 1.0 / 3.0) + sign(b) * pow(abs(b), 1.0 / 3.0) + 1.0 / 3.0;
+        float p = 0.5 * (1.0 - o.u1);
+        float modulus2 = -beta / o.u1;
+        float delta = p - o.u1;
+        float A = sqrt(max(delta * delta + modulus2 - p * p, 1e-12));
+        o.kind = ORBIT_PLUNGE;
+        o.scale = A;
+        o.m = min((A + delta) / (2.0 * A), M_LIMIT);
+        o.K = ellipticK(o.m);
+        o.rate = sqrt(A);
+        o.sign = inward ? -1.0 : 1.0;
+        o.xStart = o.sign * orbitInverse(o, u0);
+        o.xEnd = o.sign * orbitInverse(o, inward ? 1.0 : 0.0);
+        o.captured = inward;
+    }
+    return o;
+}
+
+vec4 traceOutcomeAnalytic(vec3 ro, vec3 rd) {
+    float r0 = length(ro);
+    if (r0 <= RS) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+
+    vec3 e1 = ro / r0;
+    vec3 d = normalize(rd);
+    float dr = dot(d, e1);
+    vec3 tangential = d - e1 * dr;
+    float dt = length(tangential);
+    if (dt < 1e-6) {
+        return dr < 0.0 ? vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED) : vec4(e1, OUTCOME_ESCAPED);
+    }
+    vec3 e2 = tangential / dt;
+
+    float B = r0 * dt / sqrt(dr * dr + (1.0 - RS / r0) * dt * dt) / RS;
+    Orbit orbit = solveOrbit(1.0 / (B * B), RS / r0, dr < 0.0);
+    float sweep = max(orbit.xEnd - orbit.xStart, 0.0) / orbit.rate;
+
+    float node = atan(-e1.y, e2.y);
+    if (node <= 1e-4) node += 3.14159265;
+    if (node <= 1e-4) node += 3.14159265;
+    for (int i = 0; i < ANALYTIC_MAX_CROSSINGS; i++) {
+        float psi = node + 3.14159265 * float(i);
+        if (psi >= sweep) break;
+        vec2 u = orbitAt(orbit, orbit.xStart + orbit.rate * psi);
+        float hitDist = RS / u.x;
+        if (hitDist > ISCO && hitDist < DISK_MAX) {
+            float c = cos(psi), s = sin(psi);
+            vec3 radial = e1 * c + e2 * s;
+            vec3 hitPoint = radial * hitDist;
+            vec3 vel = radial * (-u.y) + (e2 * c - e1 * s) * u.x;
+            vec3 diskTangent = normalize(vec3(-hitPoint.z, 0.0, hitPoint.x));
+            return vec4(hitDist, atan(hitPoint.z, hitPoint.x), dot(normalize(vel), diskTangent), OUTCOME_DISK);
+        }
+    }
+
+    if (orbit.captured) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+    return vec4(e1 * cos(sweep) + e2 * sin(sweep), OUTCOME_ESCAPED);
+}
@@ -0,0 +1,445 @@
+// =========================================================
+//   CÓDIGO COMÚN DEL TRAZADOR (se incluye con #include)
+// =========================================================
+// No es un shader independiente: raytracing.glsl, envmap_bake.glsl y
+// envmap_view.glsl lo incluyen. El cargador de main.cpp resuelve los
+// #include relativos a la carpeta del shader que los contiene.
+
+// --- VARIABLES GLOBALES ---
+// La cámara y el tiempo llegan en un uniform buffer que la CPU escribe justo
+// antes del dispatch (ver frame_pacing.h). Con std140, el vec3 y el float
+// comparten un mismo vec4.
+layout(std140, binding = 0) uniform FrameBlock {
+    vec3 u_camPos;
+    float u_time;
+    vec4 u_camRight;   // xyz = eje derecho de la cámara
+    vec4 u_camUp;      // xyz = eje arriba
+    vec4 u_camForward; // xyz = eje de visión, w = distancia focal (define el FOV)
+};
+uniform sampler2D skybox;        // Panorama equirectangular (unidad 0, --skybox-equirect)
+uniform samplerCube skyboxCube;  // El mismo cielo remuestreado a cubemap (unidad 2)
+uniform bool u_skyboxCube;
+
+// --- CONSTANTES DE AGUJERO NEGRO ---
+const float RS = 0.5;           // Radio de Schwarzschild
+const float ISCO = 3.0 * RS;    // Borde interno estable
+const float DISK_MAX = 6.0 * RS;// Borde externo del disco
+const int MAX_STEPS = 200;      // Calidad de la integración
+const float STEP_SIZE = 0.05;   // Paso de tiempo
+
+#ifdef FAST_MATH
+#include "fast_math.glsl"
+#endif
+
+// --- ESPACIO-TIEMPO (permutaciones, como src/spacetime.h) ---
+// METRIC_CHARGE: Reissner-Nordström, la órbita nula gana el término -2 Q² u³.
+// METRIC_ESCAPE: Schwarzschild-de Sitter; Λ no entra en la órbita de la luz, solo
+// en los horizontes, y lo que cruza el cosmológico cuenta como escapado.
+#ifdef METRIC_HORIZON
+const float HORIZON = METRIC_HORIZON;
+#else
+const float HORIZON = RS;
+#endif
+#ifdef METRIC_CHARGE
+const float CHARGE2 = (METRIC_CHARGE) * (METRIC_CHARGE);
+#endif
+
+// =========================================================
+//            RUIDO DEL DISCO (HORNEADO EN CPU)
+// =========================================================
+// El fbm de 5 octavas ya no se evalúa por impacto: está horneado en una
+// textura periódica en (ángulo, radio), ver disk_noise.h. Una vuelta del
+// disco y DISK_NOISE_PERIOD_V en radio ocupan la textura entera.
+uniform sampler2D diskNoise;      // Unidad 3, GL_REPEAT
+uniform vec2 u_diskNoisePeriod;   // Período (u, v) en coordenadas de ruido
+
+float diskNoiseAt(vec2 noise_uv) {
+    // fract antes de leer: con el tiempo las coordenadas crecen y perderían precisión
+    return textureLod(diskNoise, fract(noise_uv / u_diskNoisePeriod), 0.0).r;
+}
+
+// =========================================================
+//            FÍSICA Y RAYTRACING
+// =========================================================
+
+// Fondo de estrellas simple (con distorsión por lente gravitacional implícita)
+vec3 getBackground(vec3 dir) {
+    // Cubemap: búsqueda directa por dirección, sin atan/asin ni filas enteras leídas en los polos
+    if (u_skyboxCube) return textureLod(skyboxCube, dir, 0.0).rgb;
+
+    // Normalizamos por seguridad
+    vec3 d = normalize(dir);
+
+    // Mapeo de Esfera a Rectángulo (Coordenadas UV)
+    // atan(z, x) nos da el ángulo horizontal (longitud) -> U
+    // asin(y) nos da el ángulo vertical (latitud) -> V
+    
+#ifdef FAST_MATH
+    float u = 0.5 + fastAtan2(d.z, d.x) / (2.0 * 3.14159265);
+    float v = 0.5 + fastAsin(clamp(d.y, -1.0, 1.0)) / 3.14159265;
+#else
+    float u = 0.5 + atan(d.z, d.x) / (2.0 * 3.14159265);
+    float v = 0.5 + asin(d.y) / 3.14159265;
+#endif
+    
+    // texture() es la función de GLSL para leer píxeles interpolados
+    vec3 texColor = texture(skybox, vec2(u, v)).rgb;
+    
+    return texColor;
+}
+
+// Coordenadas de pantalla [-1, 1] de un píxel (x corregida por aspecto)
+vec2 pixelUV(vec2 pixel, ivec2 dims) {
+    vec2 uv = pixel / vec2(dims) * 2.0 - 1.0;
+    uv.x *= float(dims.x) / float(dims.y);
+    return uv;
+}
+
+// Dirección del rayo para unas coordenadas de pantalla [-1,1] (x ya corregida por aspecto).
+// La base de la cámara se calcula en la CPU (mira al agujero + giro del ratón).
+vec3 cameraRay(vec2 uv) {
+    return normalize(u_camRight.xyz * uv.x + u_camUp.xyz * uv.y + u_camForward.xyz * u_camForward.w);
+}
+
+#ifndef LENSES
+vec3 calculateAccel(vec3 pos){
+    float r2 = dot(pos,pos);
+#ifdef FAST_MATH
+    // 1 / r⁵ con la raíz inversa nativa, sin división
+    float inv = inversesqrt(r2);
+    float inv2 = inv * inv;
+#ifdef METRIC_CHARGE
+    return ((-1.5 * RS + 2.0 * CHARGE2 * inv) * inv * inv2 * inv2) * pos;
+#else
+    return (-1.5 * RS * inv * inv2 * inv2) * pos;
+#endif
+#else
+    float r = sqrt(r2);
+#ifdef METRIC_CHARGE
+    return (-1.5 * RS + 2.0 * CHARGE2 / r) * pos / (r2 * r2 * r);
+#else
+    // Gravedad Newtoniana modificada (Pseudo-Schwarzschild simple)
+    return -1.5 * RS * pos / (r2 * r2 * r);
+#endif
+#endif
+}
+#endif
+
+#ifdef LENSES
+// =========================================================
+//     VARIAS LENTES (--lenses / --binary, ver src/lenses.h)
+// =========================================================
+// Grupos y lentes en dos SSBO que sube uploadLensField. Cada invocación guarda
+// la lista de términos que cuentan en una bola alrededor de un ancla y solo la
+// rehace al salir; si no cabe en LENS_LIST_MAX, recorre los grupos en cada
+// evaluación (mismo resultado, más lento).
+struct LensGroup {
+    vec4 centerReach;  // xyz = centro de la esfera, w = alcance del grupo
+    vec4 centroidRs;   // xyz = centroide ponderado, w = Σ rs
+    float far;         // Más lejos: un solo término en el centroide
+    float pad;
+    int first;
+    int count;
+};
+struct LensEntry {
+    vec4 posRs;
+    float reach;
+    float pad0, pad1, pad2;
+};
+layout(std430, binding = 4) readonly buffer LensGroupBlock { LensGroup lensGroups[]; };
+layout(std430, binding = 5) readonly buffer LensBlock { LensEntry lenses[]; };
+
+const int LENS_LIST_MAX = 16;
+const float LENS_LIST_RADIUS = 0.5;   // Como en lenses.h
+const float LENS_CAPTURE_MARGIN = 1.01;
+
+vec4 lensList[LENS_LIST_MAX];         // xyz = posición, w = rs
+float lensHorizon2[LENS_LIST_MAX];    // 0 en los términos de campo lejano
+int lensCount = 0;
+bool lensOverflow = false;
+vec3 lensAnchor;
+
+vec3 lensTerm(vec3 d, float rs) {
+    float r2 = dot(d, d);
+#ifdef FAST_MATH
+    float inv = inversesqrt(r2);
+    float inv2 = inv * inv;
+    return (-1.5 * rs * inv * inv2 * inv2) * d;
+#else
+    return -1.5 * rs * d / (r2 * r2 * sqrt(r2));
+#endif
+}
+
+void buildLensList(vec3 pos) {
+    lensAnchor = pos;
+    lensCount = 0;
+    lensOverflow = false;
+    for (int g = 0; g < lensGroups.length(); g++) {
+        float d = length(pos - lensGroups[g].centerReach.xyz) - LENS_LIST_RADIUS;
+        if (d > lensGroups[g].centerReach.w) continue;
+        if (d > lensGroups[g].far) {
+            if (lensCount == LENS_LIST_MAX) { lensOverflow = true; return; }
+            lensList[lensCount] = lensGroups[g].centroidRs;
+            lensHorizon2[lensCount++] = 0.0;
+            continue;
+        }
+        for (int i = lensGroups[g].first; i < lensGroups[g].first + lensGroups[g].count; i++) {
+            if (length(pos - lenses[i].posRs.xyz) - LENS_LIST_RADIUS > lenses[i].reach) continue;
+            if (lensCount == LENS_LIST_MAX) { lensOverflow = true; return; }
+            float h = lenses[i].posRs.w * LENS_CAPTURE_MARGIN;
+            lensList[lensCount] = lenses[i].posRs;
+            lensHorizon2[lensCount++] = h * h;
+        }
+    }
+}
+
+// Sin lista: los mismos criterios, evaluados en 'pos'
+vec3 lensAccelAll(vec3 pos) {
+    vec3 acc = vec3(0.0);
+    for (int g = 0; g < lensGroups.length(); g++) {
+        float d = length(pos - lensGroups[g].centerReach.xyz);
+        if (d > lensGroups[g].centerReach.w) continue;
+        if (d > lensGroups[g].far) {
+            acc += lensTerm(pos - lensGroups[g].centroidRs.xyz, lensGroups[g].centroidRs.w);
+            continue;
+        }
+        for (int i = lensGroups[g].first; i < lensGroups[g].first + lensGroups[g].count; i++) {
+            vec3 dl = pos - lenses[i].posRs.xyz;
+            if (length(dl) <= lenses[i].reach) acc += lensTerm(dl, lenses[i].posRs.w);
+        }
+    }
+    return acc;
+}
+
+bool lensCaptured(vec3 pos) {
+    if (lensOverflow) {
+        for (int i = 0; i < lenses.length(); i++) {
+            vec3 d = pos - lenses[i].posRs.xyz;
+            float h = lenses[i].posRs.w * LENS_CAPTURE_MARGIN;
+            if (dot(d, d) < h * h) return true;
+        }
+        return false;
+    }
+    for (int i = 0; i < lensCount; i++) {
+        vec3 d = pos - lensList[i].xyz;
+        if (dot(d, d) < lensHorizon2[i]) return true;
+    }
+    return false;
+}
+
+vec3 calculateAccel(vec3 pos) {
+    vec3 moved = pos - lensAnchor;
+    if (dot(moved, moved) > LENS_LIST_RADIUS * LENS_LIST_RADIUS) buildLensList(pos);
+    if (lensOverflow) return lensAccelAll(pos);
+    vec3 acc = vec3(0.0);
+    for (int i = 0; i < lensCount; i++) acc += lensTerm(pos - lensList[i].xyz, lensList[i].w);
+    return acc;
+}
+#endif
+
+// Integrador RK4 (Runge-Kutta 4)
+void stepRK4(inout vec3 pos, inout vec3 vel, float dt) {
+    vec3 k1_v = vel;              vec3 k1_a = calculateAccel(pos);
+    vec3 pos2 = pos + k1_v*dt*0.5;vec3 k2_v = vel + k1_a*dt*0.5; vec3 k2_a = calculateAccel(pos2);
+    vec3 pos3 = pos + k2_v*dt*0.5;vec3 k3_v = vel + k2_a*dt*0.5; vec3 k3_a = calculateAccel(pos3);
+    vec3 pos4 = pos + k3_v*dt;    vec3 k4_v = vel + k3_a*dt;     vec3 k4_a = calculateAccel(pos4);
+    
+    pos += (k1_v + 2.0*k2_v + 2.0*k3_v + k4_v) / 6.0 * dt;
+    vel += (k1_a + 2.0*k2_a + 2.0*k3_a + k4_a) / 6.0 * dt;
+}
+
+// =========================================================
+//     RESULTADO DEL RAYO ("OUTCOME") Y SOMBREADO
+// =========================================================
+// Separar la geodésica (cara) del sombreado (barato) permite guardar el
+// resultado en caché: para una posición fija de la cámara, el resultado solo
+// depende de la dirección del rayo, no del tiempo.
+//   w = OUTCOME_CAPTURED -> cae en el horizonte
+//   w = OUTCOME_ESCAPED  -> xyz = dirección final de escape
+//   w = OUTCOME_DISK     -> x = radio del impacto, y = ángulo, z = doppler
+const float OUTCOME_CAPTURED = 0.0;
+const float OUTCOME_ESCAPED = 1.0;
+const float OUTCOME_DISK = 2.0;
+
+// --- DISCO SEMITRANSPARENTE (permutación DISK_OPACITY, como crossDisk en src/cpu_tracer.cpp) ---
+// El rayo sigue tras cruzar el disco y cada cruce se compone aquí mismo, de delante
+// hacia atrás: el resultado es lo que queda detrás (escapado o capturado) y
+// raytracing.glsl lo sombrea como diskEmission + diskTransmittance * cielo. El
+// sombreado depende del tiempo: sin caché de resultados (--adaptive, --interleave
+// y --envmap lo rechazan).
+#ifdef DISK_OPACITY
+const float DISK_OPACITY_CUTOFF = 0.99;
+vec3 diskEmission;
+float diskTransmittance;
+
+vec3 shadeDisk(float hitDist, float angle, float doppler, float time);
+
+// τ(r) = τ0 (1 + temp) / 2, con τ0 la del borde interno (diskCrossingOpacity en la CPU)
+float diskCrossingOpacity(float hitDist) {
+    float temp = (DISK_MAX - hitDist) / (DISK_MAX - ISCO);
+    return 1.0 - pow(1.0 - DISK_OPACITY, 0.5 * (1.0 + temp));
+}
+#endif
+
+#ifdef KERR
+#include "kerr.glsl"
+#endif
+#ifdef ANALYTIC
+#include "analytic.glsl"
+#endif
+
+vec4 traceOutcome(vec3 ro, vec3 rd) {
+#if defined(KERR)
+    return traceOutcomeKerr(ro, rd);
+#elif defined(ANALYTIC)
+    return traceOutcomeAnalytic(ro, rd);
+#else
+    vec3 pos = ro;
+    vec3 vel = rd;
+
+    // Clasificación previa (como classifyRay en src/cpu_tracer.cpp): E y h = |x × v|
+    // se conservan; V(r) = h²/(2r²) - RS/(2r³) tiene la barrera en r* = 1.5 RS / h².
+    float r0 = length(ro);
+    vec3 l = cross(ro, rd);
+    float h2 = dot(l, l);
+    float energy = 0.5 * dot(rd, rd) - 0.5 * RS / (r0 * r0 * r0);
+    bool inward = dot(ro, rd) < 0.0;
+    float rPeak = h2 > 0.0 ? 1.5 * RS / h2 : 1e30;
+    float vPeak = h2 * h2 * h2 / (13.5 * RS * RS);
+    // Condenado: r solo baja, así que por dentro de ISCO ya cuenta como capturado.
+    // Cambia el resultado de algunos rayos junto a la barrera, que sin clasificar no llegan
+    // al horizonte en MAX_STEPS y acaban en el cielo (NO_RAY_CLASSES: como antes)
+    bool doomed = inward && (r0 <= rPeak || energy > vPeak);
+    // Lejano: nunca baja de DISK_MAX, ni horizonte ni disco que comprobar
+    float rDisk = DISK_MAX * 1.01;
+    float barrier = rDisk >= rPeak ? 0.5 * h2 / (rDisk * rDisk) - 0.5 * RS / (rDisk * rDisk * rDisk) : vPeak;
+    bool clear = !doomed && r0 > rPeak && r0 > rDisk && (!inward || energy < barrier);
+#if defined(METRIC_CHARGE) || defined(LENSES) || defined(NO_RAY_CLASSES)
+    // Con carga el potencial es otro, y con varias lentes no hay simetría central:
+    // sin clasificación, bucle completo para todos (también con --no-ray-classes)
+    doomed = false;
+    clear = false;
+#endif
+#ifdef LENSES
+    buildLensList(ro);
+#endif
+#ifdef DISK_OPACITY
+    diskEmission = vec3(0.0);
+    diskTransmittance = 1.0;
+    int crossings = 0;
+#endif
+    float captureRadius = doomed ? ISCO : HORIZON * 1.01;
+
+    // Variable para guardar la posición del paso anterior
+    vec3 prevPos = pos;
+    
+    // Bucle de Raymarching (Paso a paso por el espacio-tiempo)
+    for(int i = 0; i < MAX_STEPS; i++){
+       // Guardamos posición antes de avanzar
+        prevPos = pos; 
+        
+        // Avanzamos la física
+        stepRK4(pos, vel, STEP_SIZE);
+        
+        float r = length(pos);
+#ifdef METRIC_ESCAPE
+        if(r > METRIC_ESCAPE) break; // Horizonte cosmológico: ya no vuelve
+#endif
+        if(clear) continue;
+
+        // 1. COLISIÓN CON HORIZONTE DE EVENTOS (Mejorada)
+#ifdef LENSES
+        if(lensCaptured(pos)) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED); // El de cualquier lente
+#else
+        if(r < HORIZON * 1.01){ // Un poco más grande que el horizonte para evitar ruido
+            return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+        }
+#endif
+
+        // 2. DETECCIÓN DE CRUCE DEL DISCO (SOLUCIÓN AL HALO)
+        // Si Y cambió de signo (uno positivo, otro negativo), cruzamos el plano.
+        if(prevPos.y * pos.y < 0.0) {
+            
+            // Interpolación: ¿En qué punto exacto Y fue 0?
+            // Matemáticas: t es el porcentaje del paso donde ocurrió el cruce.
+            float t = prevPos.y / (prevPos.y - pos.y);
+            vec3 hitPoint = mix(prevPos, pos, t); // Punto exacto de choque
+            
+            float hitDist = length(hitPoint); // Distancia desde el centro
+
+            // Verificamos si ese punto exacto está dentro de los radios del disco
+            if(hitDist > ISCO && hitDist < DISK_MAX){
+                // Coordenadas polares del impacto
+#ifdef FAST_MATH
+                float angle = fastAtan2(hitPoint.z, hitPoint.x);
+#else
+                float angle = atan(hitPoint.z, hitPoint.x);
+#endif
+
+                // Doppler: producto punto entre la dirección del rayo y la tangente del disco
+                vec3 diskTangent = normalize(vec3(-hitPoint.z, 0.0, hitPoint.x));
+                float doppler = dot(normalize(vel), diskTangent); 
+
+#ifdef DISK_OPACITY
+                float alpha = diskCrossingOpacity(hitDist);
+                diskEmission += shadeDisk(hitDist, angle, doppler, u_time) * (diskTransmittance * alpha);
+                diskTransmittance *= 1.0 - alpha;
+                crossings++;
+                // Ya no se ve lo de detrás, o se llegó al orden máximo: se descarta (negro)
+                if(diskTransmittance <= 1.0 - DISK_OPACITY_CUTOFF || crossings >= DISK_ORDERS) {
+                    return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+                }
+#else
+                return vec4(hitDist, angle, doppler, OUTCOME_DISK);
+#endif
+            }
+        }
+
+        // 3. Condenado y ya por dentro del disco: no queda nada que pueda tocar
+        if(r < captureRadius) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+    }
+
+    return vec4(normalize(vel), OUTCOME_ESCAPED);
+#endif
+}
+
+// --- RENDERIZADO DEL DISCO ---
+vec3 shadeDisk(float hitDist, float angle, float doppler, float time) {
+    // B. Rotación Diferencial
+#ifdef FAST_MATH
+    float speed = 12.0 * inversesqrt(hitDist);
+#else
+    float speed = 12.0 / sqrt(hitDist); // Aumenté velocidad para efecto visual
+#endif
+    float rot_angle = angle + speed * time;
+    
+    // C. Mapeo UV para el ruido
+    vec2 noise_uv = vec2(rot_angle * 3.0, hitDist * 1.5 - time);
+    float noise = diskNoiseAt(noise_uv);
+    
+    // D. Temperatura y Doppler (Simplificado para debug visual)
+    float temp = (DISK_MAX - hitDist) / (DISK_MAX - ISCO);
+    float intensity = temp * noise * 2.0;
+    
+    // doppler > 0 se aleja (rojo), doppler < 0 se acerca (azul/brillante)
+#ifdef FAST_MATH
+    float base = 1.0 - doppler * 0.5;
+    float beaming = base * base * base; // Exponente entero: basta el producto
+#else
+    float beaming = pow(1.0 - doppler * 0.5, 3.0); 
+#endif
+    
+    intensity *= beaming;
+
+    vec3 fireColor = vec3(1.0, 0.6, 0.2) * intensity * 3.0;
+    // Gradiente térmico hacia blanco en el centro
+    fireColor += vec3(0.5, 0.5, 1.0) * smoothstep(0.0, 1.0, intensity - 1.0);
+    return fireColor;
+}
+
+// Color lineal (HDR) de un resultado
+vec3 shadeOutcome(vec4 outcome, float time) {
+    if(outcome.w > OUTCOME_DISK - 0.5) return shadeDisk(outcome.x, outcome.y, outcome.z, time);
+    if(outcome.w > OUTCOME_ESCAPED - 0.5) return getBackground(outcome.xyz);
+    return vec3(0.0);
+}
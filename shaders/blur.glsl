@@ -5,27 +5,39 @@ layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
 layout(rgba32f, binding = 0) uniform image2D imgInput;
 layout(rgba32f, binding = 1) uniform image2D imgOutput;
 
+// 1 = resolución completa, 2 = media resolución (la salida ocupa la esquina
+// inferior izquierda de imgOutput y se muestrea escalada en fragment_screen)
+uniform int u_downsample;
+// Solo los píxeles con luminancia lineal por encima del umbral generan bloom
+uniform float u_threshold;
+// Tamaño activo de imgInput (la textura puede tener más capacidad)
+uniform ivec2 u_viewport;
+
 void main() {
     ivec2 pixel_coords = ivec2(gl_GlobalInvocationID.xy);
-    ivec2 dims = imageSize(imgInput);
+    ivec2 dims = u_viewport;
+    ivec2 outDims = (dims + u_downsample - 1) / u_downsample;
 
-    if(pixel_coords.x >= dims.x || pixel_coords.y >= dims.y) return;
+    if(pixel_coords.x >= outDims.x || pixel_coords.y >= outDims.y) return;
 
     vec3 totalColor = vec3(0.0);
     float count = 0.0;
 
-    int radio = 4;
+    // Mantenemos la misma huella en píxeles de entrada: a media resolución
+    // se muestrea con paso 2 y la mitad de radio (25 lecturas en vez de 81)
+    ivec2 center = pixel_coords * u_downsample;
+    int radio = 4 / u_downsample;
 
     for(int x = -radio; x <= radio; x++) {
         for(int y = -radio; y <= radio; y++) {
-            ivec2 neighbor = pixel_coords + ivec2(x, y);
+            ivec2 neighbor = center + ivec2(x, y) * u_downsample;
             
             if(neighbor.x >= 0 && neighbor.x < dims.x && neighbor.y >= 0 && neighbor.y < dims.y) {
                 vec3 color = imageLoad(imgInput, neighbor).rgb;
                 float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
-                if(brightness > 1.0) color *= 1.5;
+                // Paso de brillo: lo que no supera el umbral no brilla
+                if(brightness > u_threshold) totalColor += color * 1.5;
 
-                totalColor += color;
                 count += 1.0;
             }
         }
@@ -34,4 +46,4 @@ void main() {
     vec3 blurColor = totalColor / count;
 
     imageStore(imgOutput, pixel_coords, vec4(blurColor, 1.0));
-}
\ No newline at end of file
+}
@@ -0,0 +1,55 @@
+// =========================================================
+//     FUNCIONES ELÍPTICAS (se incluye desde analytic.glsl)
+// =========================================================
+// Mismo código que src/elliptic.h: número fijo de iteraciones, sin ramas
+// que dependan del rayo (todos los hilos del grupo hacen lo mismo).
+const int ELLIPTIC_RF_ITERATIONS = 10;
+const int ELLIPTIC_AGM_ITERATIONS = 8;
+
+// Integral simétrica de Carlson R_F(x, y, z)
+float carlsonRF(float x, float y, float z) {
+    for (int i = 0; i < ELLIPTIC_RF_ITERATIONS; i++) {
+        float sx = sqrt(x), sy = sqrt(y), sz = sqrt(z);
+        float lambda = sx * (sy + sz) + sy * sz;
+        x = 0.25 * (x + lambda);
+        y = 0.25 * (y + lambda);
+        z = 0.25 * (z + lambda);
+    }
+    float mean = (x + y + z) * (1.0 / 3.0);
+    float dx = 1.0 - x / mean, dy = 1.0 - y / mean, dz = 1.0 - z / mean;
+    float e2 = dx * dy - dz * dz;
+    float e3 = dx * dy * dz;
+    return (1.0 - e2 * 0.1 + e3 * (1.0 / 14.0) + e2 * e2 * (1.0 / 24.0) - e2 * e3 * (3.0 / 44.0)) / sqrt(mean);
+}
+
+// K(m) y F(φ | m), m = k², φ en [0, π/2]
+float ellipticK(float m) {
+    return carlsonRF(0.0, 1.0 - m, 1.0);
+}
+
+float ellipticF(float phi, float m) {
+    float s = sin(phi), c = cos(phi);
+    return s * carlsonRF(c * c, 1.0 - m * s * s, 1.0);
+}
+
+// sn, cn, dn de Jacobi por la transformación descendente de Landen: (sn, cn, dn)
+vec3 jacobiSnCnDn(float u, float m) {
+    float a[ELLIPTIC_AGM_ITERATIONS + 1];
+    float c[ELLIPTIC_AGM_ITERATIONS + 1];
+    float an = 1.0, bn = sqrt(1.0 - m);
+    a[0] = an;
+    c[0] = sqrt(m);
+    for (int i = 1; i <= ELLIPTIC_AGM_ITERATIONS; i++) {
+        float next = 0.5 * (an + bn);
+        c[i] = 0.5 * (an - bn);
+        bn = sqrt(an * bn);
+        an = next;
+        a[i] = an;
+    }
+    float phi = float(1 << ELLIPTIC_AGM_ITERATIONS) * a[ELLIPTIC_AGM_ITERATIONS] * u;
+    for (int i = ELLIPTIC_AGM_ITERATIONS; i > 0; i--) {
+        phi = 0.5 * (phi + asin(clamp(c[i] / a[i] * sin(phi), -1.0, 1.0)));
+    }
+    float sn = sin(phi);
+    return vec3(sn, cos(phi), sqrt(1.0 - m * sn * sn));
+}
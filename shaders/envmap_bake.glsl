@@ -0,0 +1,35 @@
+#version 430
+
+// --- HORNEADO DEL MAPA DE ENTORNO LENSADO ---
+// Traza una geodésica por cada texel de un cubemap centrado en la cámara y
+// guarda el RESULTADO (no el color). Mientras la cámara no se traslade, esto
+// sirve para cualquier orientación y FOV, y el disco sigue animándose porque
+// el sombreado se hace después, en envmap_view.glsl.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform writeonly imageCube imgEnv;
+
+uniform vec3 u_bakePos; // Posición de la cámara en el momento del horneado
+uniform int u_faceSize;  // Resolución de cada cara
+
+#include "blackhole_common.glsl"
+
+// Dirección de un texel según la convención de caras de OpenGL
+vec3 cubeTexelDir(int face, vec2 st) {
+    if(face == 0) return vec3( 1.0, -st.y, -st.x); // +X
+    if(face == 1) return vec3(-1.0, -st.y,  st.x); // -X
+    if(face == 2) return vec3( st.x,  1.0,  st.y); // +Y
+    if(face == 3) return vec3( st.x, -1.0, -st.y); // -Y
+    if(face == 4) return vec3( st.x, -st.y,  1.0); // +Z
+    return vec3(-st.x, -st.y, -1.0);               // -Z
+}
+
+void main() {
+    ivec3 texel = ivec3(gl_GlobalInvocationID.xyz);
+    if(texel.x >= u_faceSize || texel.y >= u_faceSize) return;
+
+    // Centro del texel en [-1, 1]
+    vec2 st = (vec2(texel.xy) + 0.5) / float(u_faceSize) * 2.0 - 1.0;
+    vec3 rd = normalize(cubeTexelDir(texel.z, st));
+
+    imageStore(imgEnv, texel, traceOutcome(u_bakePos, rd));
+}
@@ -0,0 +1,25 @@
+#version 430
+
+// --- VISTA DESDE EL MAPA DE ENTORNO ---
+// Sin geodésicas: cada píxel busca el resultado de su dirección en el
+// cubemap horneado y lo sombrea con el tiempo actual.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform image2D imgOutput;
+
+uniform ivec2 u_viewport;
+// Filtro NEAREST: interpolar resultados de clases distintas (disco/cielo) no tiene sentido
+uniform samplerCube u_envMap;
+
+#include "blackhole_common.glsl"
+
+void main() {
+    ivec2 pixel_coords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dims = u_viewport;
+    if(pixel_coords.x >= dims.x || pixel_coords.y >= dims.y) return;
+
+    // Mismas coordenadas de pantalla que raytracing.glsl
+    vec2 uv = pixelUV(vec2(pixel_coords), dims);
+
+    vec4 outcome = textureLod(u_envMap, cameraRay(uv), 0.0);
+    imageStore(imgOutput, pixel_coords, vec4(shadeOutcome(outcome, u_time), 1.0));
+}
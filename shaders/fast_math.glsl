@@ -0,0 +1,25 @@
+// =========================================================
+//     MATEMÁTICA RÁPIDA (se incluye desde blackhole_common.glsl)
+// =========================================================
+// Solo en la permutación con #define FAST_MATH (--fast-math). Mismas
+// aproximaciones que src/fast_math.h (errores medidos allí, --bench-fast-math);
+// la raíz inversa es la nativa, inversesqrt.
+
+// atan(y, x) en (-π, π]: polinomio impar de grado 11 en [0, 1], error < 2e-6 rad
+float fastAtan2(float y, float x) {
+    float ax = abs(x), ay = abs(y);
+    float a = min(ax, ay) / max(max(ax, ay), 1e-30);
+    float s = a * a;
+    float r = a * (0.99997726 + s * (-0.33262347 + s * (0.19354346 + s * (-0.11643287 + s * (0.05265332 + s * -0.01172120)))));
+    r = ay > ax ? 1.5707963 - r : r;
+    r = x < 0.0 ? 3.14159265 - r : r;
+    return y < 0.0 ? -r : r;
+}
+
+// asin(x), x en [-1, 1]: Abramowitz-Stegun 4.4.45, error < 7e-5 rad
+float fastAsin(float x) {
+    float a = abs(x);
+    float p = ((-0.0187293 * a + 0.0742610) * a - 0.2121144) * a + 1.5707288;
+    float r = 1.5707963 - sqrt(1.0 - a) * p;
+    return x < 0.0 ? -r : r;
+}
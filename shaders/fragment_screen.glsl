@@ -3,26 +3,39 @@ out vec4 FragColor;
 in vec2 fragCoord;
 
 // Ahora recibimos DOS texturas
-uniform sampler2D texBase;  // La nítida (computeTexture)
+uniform sampler2D texBase;  // La nítida (computeTexture), color lineal HDR
 uniform sampler2D texBloom; // La borrosa (blurTexture)
 
+uniform float u_exposure;      // Exposición automática calculada a partir del histograma
+uniform float u_bloomStrength; // 0.0 cuando el bloom se ha saltado este frame
+uniform vec2 u_baseUVScale;    // Fracción de texBase ocupada por el viewport (pool de render targets)
+uniform vec2 u_bloomUVScale;   // Igual para texBloom (la mitad si se calculó a media resolución)
+
+// Escala la UV al sub-rectángulo y evita que el filtro lineal lea texels fuera de él
+vec2 subRectUV(vec2 uv, vec2 scale, sampler2D tex) {
+    vec2 halfTexel = 0.5 / vec2(textureSize(tex, 0));
+    return min(uv * scale, scale - halfTexel);
+}
+
 void main()
 {
     vec2 uv = fragCoord * 0.5 + 0.5;
 
     // 1. Leemos la imagen base (El agujero negro definido)
-    vec3 colorBase = texture(texBase, uv).rgb;
+    vec3 colorBase = texture(texBase, subRectUV(uv, u_baseUVScale, texBase)).rgb;
 
     // 2. Leemos el bloom (El resplandor celestial)
-    vec3 colorBloom = texture(texBloom, uv).rgb;
+    vec3 colorBloom = vec3(0.0);
+    if(u_bloomStrength > 0.0) colorBloom = texture(texBloom, subRectUV(uv, u_bloomUVScale, texBloom)).rgb * u_bloomStrength;
 
     // 3. MEZCLA ADITIVA (La clave de la luz)
     // Luz + Luz = MÁS Luz. 
-    // Sumamos la imagen normal + el resplandor.
-    vec3 finalColor = colorBase + colorBloom;
+    // Sumamos la imagen normal + el resplandor, todo en espacio lineal.
+    vec3 finalColor = (colorBase + colorBloom) * u_exposure;
 
-    // (Opcional) Tone Mapping simple para que no sature a blanco puro demasiado rápido
-    finalColor = vec3(1.0) - exp(-finalColor * 1.0);
+    // Tone Mapping (Reinhard) y corrección gamma: único sitio donde se hace
+    finalColor = finalColor / (finalColor + vec3(1.0));
+    finalColor = pow(finalColor, vec3(1.0/2.2));
 
     FragColor = vec4(finalColor, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,90 @@
+#version 430
+
+// --- RENDER ENTRELAZADO: RECONSTRUCCIÓN ---
+// Con la cámara quieta, el resultado de un rayo no depende del tiempo: los
+// píxeles de fases anteriores se vuelven a sombrear con u_time y la imagen
+// es idéntica a trazarlo todo. Las fases que aún no valen (la cámara se ha
+// movido desde que se trazaron) se reconstruyen con los vecinos trazados en
+// este frame.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform writeonly image2D imgOutput;
+layout(rgba32f, binding = 1) uniform readonly image2D imgOutcomes;
+
+uniform ivec2 u_viewport;
+uniform int u_factor;       // 2 o 4
+uniform int u_phase;        // Fase trazada en este frame
+uniform int u_validPhases;  // Bit i = la fase i se trazó con la cámara actual
+
+#include "blackhole_common.glsl"
+
+// Debe coincidir con interleave_trace.glsl
+int pixelPhase(ivec2 p) {
+    if(u_factor == 2) return (p.x + p.y) & 1;
+    return (p.x & 1) | ((p.y & 1) << 1);
+}
+
+vec3 shadeAt(ivec2 p) {
+    return shadeOutcome(imageLoad(imgOutcomes, p), u_time);
+}
+
+bool insideViewport(ivec2 p) {
+    return all(greaterThanEqual(p, ivec2(0))) && all(lessThan(p, u_viewport));
+}
+
+// Damero: los 4 vecinos directos son de la fase actual. Se interpola en la
+// dirección del borde (la pareja con menos diferencia) para no emborronarlo.
+vec3 reconstructCheckerboard(ivec2 p) {
+    ivec2 l = p - ivec2(1, 0), r = p + ivec2(1, 0);
+    ivec2 d = p - ivec2(0, 1), u = p + ivec2(0, 1);
+    bool hasH = insideViewport(l) && insideViewport(r);
+    bool hasV = insideViewport(d) && insideViewport(u);
+
+    if(hasH && hasV) {
+        vec3 cl = shadeAt(l), cr = shadeAt(r), cd = shadeAt(d), cu = shadeAt(u);
+        vec3 dh = abs(cl - cr), dv = abs(cd - cu);
+        float gh = dh.r + dh.g + dh.b, gv = dv.r + dv.g + dv.b;
+        if(gh < 0.5 * gv) return 0.5 * (cl + cr);
+        if(gv < 0.5 * gh) return 0.5 * (cd + cu);
+        return 0.25 * (cl + cr + cd + cu);
+    }
+    // Bordes de la imagen: media de los vecinos que existan
+    vec3 sum = vec3(0.0);
+    float count = 0.0;
+    if(insideViewport(l)) { sum += shadeAt(l); count += 1.0; }
+    if(insideViewport(r)) { sum += shadeAt(r); count += 1.0; }
+    if(insideViewport(d)) { sum += shadeAt(d); count += 1.0; }
+    if(insideViewport(u)) { sum += shadeAt(u); count += 1.0; }
+    return count > 0.0 ? sum / count : vec3(0.0);
+}
+
+// Cuartos: bilineal sobre la rejilla 2x2 de la fase actual
+vec3 reconstructQuarter(ivec2 p) {
+    ivec2 offset = ivec2(u_phase & 1, u_phase >> 1);
+    ivec2 maxIndex = (u_viewport - 1 - offset) / 2;
+    vec2 f = vec2(p - offset) * 0.5;
+    ivec2 i0 = ivec2(floor(f));
+    vec2 t = f - vec2(i0);
+    ivec2 a = clamp(i0, ivec2(0), maxIndex);
+    ivec2 b = clamp(i0 + 1, ivec2(0), maxIndex);
+
+    vec3 c00 = shadeAt(2 * a + offset);
+    vec3 c10 = shadeAt(2 * ivec2(b.x, a.y) + offset);
+    vec3 c01 = shadeAt(2 * ivec2(a.x, b.y) + offset);
+    vec3 c11 = shadeAt(2 * b + offset);
+    return mix(mix(c00, c10, t.x), mix(c01, c11, t.x), t.y);
+}
+
+void main() {
+    ivec2 pixel_coords = ivec2(gl_GlobalInvocationID.xy);
+    if(pixel_coords.x >= u_viewport.x || pixel_coords.y >= u_viewport.y) return;
+
+    vec3 col;
+    if(((u_validPhases >> pixelPhase(pixel_coords)) & 1) != 0) {
+        col = shadeAt(pixel_coords); // Trazado ahora o en un frame anterior con la misma cámara
+    } else if(u_factor == 2) {
+        col = reconstructCheckerboard(pixel_coords);
+    } else {
+        col = reconstructQuarter(pixel_coords);
+    }
+    imageStore(imgOutput, pixel_coords, vec4(col, 1.0));
+}
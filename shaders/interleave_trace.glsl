@@ -0,0 +1,29 @@
+#version 430
+
+// --- RENDER ENTRELAZADO: PASE DE RAYOS ---
+// Cada frame solo se traza una fase del patrón: la mitad de los píxeles
+// (damero, u_factor = 2) o uno de cada 2x2 (u_factor = 4). El dispatch cubre
+// solo esos píxeles y el RESULTADO del rayo se guarda en la textura de
+// historia; interleave_resolve.glsl rellena el resto y sombrea.
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform writeonly image2D imgOutcomes;
+
+uniform ivec2 u_viewport;
+uniform int u_factor;  // 2 o 4
+uniform int u_phase;   // Fase de este frame (0 .. u_factor - 1)
+
+#include "blackhole_common.glsl"
+
+// Debe coincidir con interleave_resolve.glsl
+ivec2 phasePixel(ivec2 id) {
+    if(u_factor == 2) return ivec2(2 * id.x + ((id.y + u_phase) & 1), id.y);
+    return 2 * id + ivec2(u_phase & 1, u_phase >> 1);
+}
+
+void main() {
+    ivec2 pixel_coords = phasePixel(ivec2(gl_GlobalInvocationID.xy));
+    if(pixel_coords.x >= u_viewport.x || pixel_coords.y >= u_viewport.y) return;
+
+    vec2 uv = pixelUV(vec2(pixel_coords), u_viewport);
+    imageStore(imgOutcomes, pixel_coords, traceOutcome(u_camPos, cameraRay(uv)));
+}
@@ -0,0 +1,138 @@
+// =========================================================
+//     MOTOR DE KERR (se incluye desde blackhole_common.glsl)
+// =========================================================
+// Solo se compila en la permutación con #define KERR (--kerr A). Mismo
+// algoritmo que src/kerr.cpp: E, L y Q son integrales primeras, en tiempo de
+// Mino solo se integran r y θ (ecuaciones de segundo orden) y φ se acumula.
+// Eje de giro = y; unidades internas M = RS / 2.
+uniform float u_kerrSpin;          // a / M
+
+const int KERR_MAX_STEPS = 1000;
+const float KERR_STEP = 0.03;
+const float KERR_ESCAPE_R = 100.0;
+
+// Estado: x = r, y = θ, z = dr/dλ, w = dθ/dλ (φ va aparte)
+// Constantes: x = a, y = a², z = L, w = K = Q + (L - a)²
+vec4 kerrDerivatives(vec4 s, vec4 c, out float dPhi) {
+    float r2 = s.x * s.x;
+    float sinT = max(sin(s.y), 1e-4);
+    float cosT = cos(s.y);
+    float sin2 = sinT * sinT;
+    float P = r2 + c.y - c.x * c.z;
+    float delta = r2 - 2.0 * s.x + c.y;
+    dPhi = c.x * P / delta - c.x + c.z / sin2;
+    return vec4(s.z, s.w,
+                2.0 * s.x * P - (s.x - 1.0) * c.w,
+                -c.y * cosT * sinT + c.z * c.z * cosT / (sinT * sin2));
+}
+
+void stepKerrRK4(inout vec4 s, inout float phi, vec4 c, float h) {
+    float p1, p2, p3, p4;
+    vec4 k1 = kerrDerivatives(s, c, p1);
+    vec4 k2 = kerrDerivatives(s + k1 * (h * 0.5), c, p2);
+    vec4 k3 = kerrDerivatives(s + k2 * (h * 0.5), c, p3);
+    vec4 k4 = kerrDerivatives(s + k3 * h, c, p4);
+    s += (k1 + 2.0 * k2 + 2.0 * k3 + k4) * (h / 6.0);
+    phi += (p1 + 2.0 * p2 + 2.0 * p3 + p4) * (h / 6.0);
+}
+
+vec3 kerrToCartesian(float r, float theta, float phi, float a2) {
+    float rho = sqrt(r * r + a2);
+    return vec3(rho * sin(theta) * cos(phi), r * cos(theta), rho * sin(theta) * sin(phi));
+}
+
+vec3 kerrCartesianVelocity(vec4 s, float phi, vec4 c) {
+    float dPhi;
+    vec4 d = kerrDerivatives(s, c, dPhi);
+    float rho = sqrt(s.x * s.x + c.y);
+    float sinT = sin(s.y), cosT = cos(s.y);
+    float sinP = sin(phi), cosP = cos(phi);
+    float dRho = s.x * d.x / rho;
+    return vec3(dRho * sinT * cosP + rho * cosT * cosP * d.y - rho * sinT * sinP * dPhi,
+                d.x * cosT - s.x * sinT * d.y,
+                dRho * sinT * sinP + rho * cosT * sinP * d.y + rho * sinT * cosP * dPhi);
+}
+
+// Cartesianas (en M) -> estado inicial y constantes. false = sin condición inicial válida.
+bool kerrInitialState(vec3 p, vec3 d, float a, out vec4 s, out float phi, out vec4 c) {
+    float a2 = a * a;
+    float w = dot(p, p) - a2;
+    float r2 = 0.5 * (w + sqrt(w * w + 4.0 * a2 * p.y * p.y));
+    float r = sqrt(r2);
+    float theta = acos(clamp(p.y / r, -1.0, 1.0));
+    phi = atan(p.z, p.x);
+    s = vec4(r, theta, 0.0, 0.0);
+    c = vec4(a, a2, 0.0, 0.0);
+
+    float rho = sqrt(r2 + a2);
+    float sinT = max(sin(theta), 1e-4), cosT = cos(theta);
+    float sinP = sin(phi), cosP = cos(phi);
+    vec3 jr = vec3(r / rho * sinT * cosP, cosT, r / rho * sinT * sinP);
+    vec3 jt = vec3(rho * cosT * cosP, -r * sinT, rho * cosT * sinP);
+    vec3 jp = vec3(-rho * sinT * sinP, 0.0, rho * sinT * cosP);
+    float det = dot(jr, cross(jt, jp));
+    if (abs(det) < 1e-12) return false;
+    float rDot = dot(d, cross(jt, jp)) / det;
+    float thetaDot = dot(jr, cross(d, jp)) / det;
+    float phiDot = dot(jr, cross(jt, d)) / det;
+
+    float sigma = r2 + a2 * cosT * cosT;
+    float delta = r2 - 2.0 * r + a2;
+    if (delta <= 0.0) return false;
+    float sin2 = sinT * sinT;
+    float gtt = -(1.0 - 2.0 * r / sigma);
+    float gtp = -2.0 * a * r * sin2 / sigma;
+    float gpp = (r2 + a2 + 2.0 * a2 * r * sin2 / sigma) * sin2;
+    float spatial = sigma / delta * rDot * rDot + sigma * thetaDot * thetaDot + gpp * phiDot * phiDot;
+    float disc = gtp * gtp * phiDot * phiDot - gtt * spatial;
+    if (gtt >= 0.0 || disc < 0.0) return false;
+    float tDot = (-gtp * phiDot - sqrt(disc)) / gtt;
+
+    float E = -(gtt * tDot + gtp * phiDot);
+    float L = (gtp * tDot + gpp * phiDot) / E;
+    float pTheta = sigma * thetaDot / E;
+    float Q = pTheta * pTheta + cosT * cosT * (L * L / sin2 - a2);
+    c.z = L;
+    c.w = Q + (L - a) * (L - a);
+    s.z = sigma * rDot / E;
+    s.w = pTheta;
+    return true;
+}
+
+vec4 traceOutcomeKerr(vec3 ro, vec3 rd) {
+    float M = 0.5 * RS;
+    float a = u_kerrSpin;
+    vec4 s, c;
+    float phi;
+    if (!kerrInitialState(ro / M, normalize(rd), a, s, phi, c)) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+
+    float horizon = (1.0 + sqrt(max(1.0 - a * a, 0.0))) * 1.01;
+    float escapeR = max(KERR_ESCAPE_R, 2.0 * s.x);
+    float prevY = s.x * cos(s.y);
+
+    for (int i = 0; i < KERR_MAX_STEPS; i++) {
+        vec4 prev = s;
+        float prevPhi = phi;
+        // Cerca del eje el término L² / sin³θ es rígido: paso más corto
+        float h = KERR_STEP * s.x / (s.x * s.x + c.y) * min(1.0, 0.05 + 4.0 * abs(sin(s.y)));
+        stepKerrRK4(s, phi, c, h);
+
+        if (s.x < horizon) return vec4(0.0, 0.0, 0.0, OUTCOME_CAPTURED);
+
+        float y = s.x * cos(s.y);
+        if (prevY * y < 0.0) {
+            float t = prevY / (prevY - y);
+            vec3 hitPoint = kerrToCartesian(mix(prev.x, s.x, t), 1.5707963, mix(prevPhi, phi, t), c.y) * M;
+            float hitDist = length(hitPoint);
+            if (hitDist > ISCO && hitDist < DISK_MAX) {
+                vec3 diskTangent = normalize(vec3(-hitPoint.z, 0.0, hitPoint.x));
+                float doppler = dot(normalize(kerrCartesianVelocity(s, phi, c)), diskTangent);
+                return vec4(hitDist, atan(hitPoint.z, hitPoint.x), doppler, OUTCOME_DISK);
+            }
+        }
+        prevY = y;
+
+        if (s.x > escapeR && s.z > 0.0) break;
+    }
+    return vec4(normalize(kerrCartesianVelocity(s, phi, c)), OUTCOME_ESCAPED);
+}
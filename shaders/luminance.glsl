@@ -0,0 +1,57 @@
+#version 430
+
+// --- REDUCCIÓN DE LUMINANCIA (HISTOGRAMA EN MEMORIA COMPARTIDA) ---
+// Cada grupo de trabajo construye su histograma local en memoria compartida
+// y solo al final hace un atomicAdd global por bin no vacío.
+layout(local_size_x = 16, local_size_y = 16, local_size_z = 1) in;
+layout(rgba32f, binding = 0) uniform readonly image2D imgInput;
+
+const int BINS = 64;          // Debe coincidir con LUM_HISTOGRAM_BINS (hdr.h)
+const float LOG_MIN = -10.0;  // LUM_LOG_MIN
+const float LOG_MAX = 6.0;    // LUM_LOG_MAX
+
+layout(std430, binding = 2) buffer LumStats {
+    uint histogram[BINS];
+    uint brightCount;
+    uint pixelCount;
+};
+
+uniform float u_threshold; // Luminancia lineal a partir de la cual hay bloom
+uniform ivec2 u_viewport;  // Sub-rectángulo activo de imgInput
+
+shared uint localHist[BINS];
+shared uint localBright;
+shared uint localCount;
+
+void main() {
+    uint li = gl_LocalInvocationIndex;
+    if(li < uint(BINS)) localHist[li] = 0u;
+    if(li == 0u) { localBright = 0u; localCount = 0u; }
+    barrier();
+
+    ivec2 pixel_coords = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dims = u_viewport;
+
+    // No podemos hacer "return" antes de barrier(): solo marcamos si el píxel es válido
+    if(pixel_coords.x < dims.x && pixel_coords.y < dims.y) {
+        vec3 color = imageLoad(imgInput, pixel_coords).rgb;
+        float lum = dot(color, vec3(0.2126, 0.7152, 0.0722));
+
+        // Bin 0 = negro (sombra), bins 1..BINS-1 = escala logarítmica
+        int bin = 0;
+        if(lum > exp2(LOG_MIN)) {
+            float t = (log2(lum) - LOG_MIN) / (LOG_MAX - LOG_MIN);
+            bin = 1 + clamp(int(t * float(BINS - 1)), 0, BINS - 2);
+        }
+        atomicAdd(localHist[bin], 1u);
+        if(lum > u_threshold) atomicAdd(localBright, 1u);
+        atomicAdd(localCount, 1u);
+    }
+    barrier();
+
+    if(li < uint(BINS) && localHist[li] > 0u) atomicAdd(histogram[li], localHist[li]);
+    if(li == 0u) {
+        atomicAdd(brightCount, localBright);
+        atomicAdd(pixelCount, localCount);
+    }
+}
@@ -0,0 +1,88 @@
+#include <glad/gl.h>
+#include "adaptive.h"
+#include <iostream>
+
+AdaptiveSampler createAdaptiveSampler(int step, float colorThreshold) {
+    AdaptiveSampler sampler;
+    sampler.step = step;
+    sampler.colorThreshold = colorThreshold;
+    glGenBuffers(2, sampler.counter);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sampler.counter[i]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int), NULL, GL_DYNAMIC_READ);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return sampler;
+}
+
+void destroyAdaptiveSampler(AdaptiveSampler& sampler, RenderTargetPool& pool) {
+    releaseRenderTarget(pool, sampler.coarse);
+    if (sampler.counter[0] != 0) glDeleteBuffers(2, sampler.counter);
+    sampler.counter[0] = sampler.counter[1] = 0;
+}
+
+void dispatchAdaptive(AdaptiveSampler& sampler, RenderTargetPool& pool, unsigned int coarseProgram,
+                      unsigned int refineProgram, unsigned int outputTexture, int width, int height) {
+    int coarseWidth = adaptiveCoarseSize(width, sampler.step);
+    int coarseHeight = adaptiveCoarseSize(height, sampler.step);
+    resizeRenderTarget(pool, sampler.coarse, coarseWidth, coarseHeight);
+
+    // 1. Rejilla dispersa
+    glUseProgram(coarseProgram);
+    glUniform2i(glGetUniformLocation(coarseProgram, "u_viewport"), width, height);
+    glUniform2i(glGetUniformLocation(coarseProgram, "u_coarseSize"), coarseWidth, coarseHeight);
+    glUniform1i(glGetUniformLocation(coarseProgram, "u_step"), sampler.step);
+    glBindImageTexture(0, sampler.coarse.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glDispatchCompute((coarseWidth + 7) / 8, (coarseHeight + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // 2. Refinado: contador limpio en el buffer de este frame
+    sampler.current = 1 - sampler.current;
+    unsigned int ssbo = sampler.counter[sampler.current];
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+    unsigned int zero = 0;
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, ssbo);
+
+    glUseProgram(refineProgram);
+    glUniform2i(glGetUniformLocation(refineProgram, "u_viewport"), width, height);
+    glUniform2i(glGetUniformLocation(refineProgram, "u_coarseSize"), coarseWidth, coarseHeight);
+    glUniform1i(glGetUniformLocation(refineProgram, "u_step"), sampler.step);
+    glUniform1f(glGetUniformLocation(refineProgram, "u_colorThreshold"), sampler.colorThreshold);
+    glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glBindImageTexture(1, sampler.coarse.texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    sampler.pendingGrid[sampler.current] = (uint64_t)coarseWidth * coarseHeight;
+    sampler.pendingPixels[sampler.current] = (uint64_t)width * height;
+}
+
+static uint64_t readCounter(AdaptiveSampler& sampler, int index) {
+    if (sampler.pendingPixels[index] == 0) return 0;
+
+    unsigned int refined = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, sampler.counter[index]);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(refined), &refined);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    uint64_t traced = sampler.pendingGrid[index] + refined;
+    sampler.frames++;
+    sampler.tracedRays += (long long)traced;
+    sampler.pixels += (long long)sampler.pendingPixels[index];
+    sampler.pendingGrid[index] = sampler.pendingPixels[index] = 0;
+    return traced;
+}
+
+uint64_t readAdaptiveStats(AdaptiveSampler& sampler, bool includeCurrent) {
+    uint64_t traced = readCounter(sampler, 1 - sampler.current);
+    if (includeCurrent) traced += readCounter(sampler, sampler.current);
+    return traced;
+}
+
+void printAdaptiveStats(const AdaptiveSampler& sampler) {
+    if (sampler.pixels == 0) return;
+    std::cout << "Muestreo adaptativo (" << sampler.step << "x" << sampler.step << "): "
+              << 100.0 * sampler.tracedRays / sampler.pixels << "% rayos trazados en " << sampler.frames
+              << " frames" << std::endl;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "render_targets.h"
+#include <cstdint>
+
+// --- MUESTREO ADAPTATIVO (SUBMUESTREO GUIADO POR BORDES) ---
+// La mayor parte de la imagen es cielo lensado suave o sombra negra. Primero
+// se traza una rejilla dispersa (un rayo cada N x N píxeles, adaptive_coarse.glsl)
+// y después cada celda decide (adaptive_refine.glsl): si sus 4 esquinas son
+// de la misma clase, la deflexión no se dispara y el color apenas cambia, se
+// interpola el resultado y se sombrea; si no, se trazan todos sus píxeles.
+// El trazador de CPU aplica el mismo criterio (CpuTracer::adaptiveStep).
+
+const int ADAPTIVE_MAX_STEP = 16;
+const float ADAPTIVE_DEFAULT_THRESHOLD = 0.08f;
+
+// Puntos de la rejilla en un eje: la celda del último píxel necesita su esquina siguiente
+inline int adaptiveCoarseSize(int pixels, int step) { return (pixels - 1) / step + 2; }
+
+// El contador de rayos refinados usa dos SSBO alternos, como las estadísticas
+// de luminancia: la CPU lee el del frame anterior sin esperar a la GPU.
+struct AdaptiveSampler {
+    int step = 0;                   // 0 = desactivado
+    float colorThreshold = ADAPTIVE_DEFAULT_THRESHOLD;
+    RenderTarget coarse;            // Resultados de la rejilla (RGBA32F, del pool)
+    unsigned int counter[2] = {0, 0};
+    uint64_t pendingGrid[2] = {0, 0};   // Rayos de la rejilla del frame que escribió cada contador
+    uint64_t pendingPixels[2] = {0, 0}; // 0 = ese contador no tiene nada pendiente
+    int current = 0;
+
+    long long frames = 0;           // Frames ya contabilizados
+    long long tracedRays = 0;       // Rejilla + píxeles refinados
+    long long pixels = 0;           // Píxeles de esos frames
+};
+
+AdaptiveSampler createAdaptiveSampler(int step, float colorThreshold);
+void destroyAdaptiveSampler(AdaptiveSampler& sampler, RenderTargetPool& pool);
+
+// Pase grueso + refinado sobre el sub-rectángulo width x height de 'outputTexture'
+// (el FrameBlock y las texturas del trazador ya deben estar conectados).
+void dispatchAdaptive(AdaptiveSampler& sampler, RenderTargetPool& pool, unsigned int coarseProgram,
+                      unsigned int refineProgram, unsigned int outputTexture, int width, int height);
+
+// Lee el contador del frame anterior (y también el del actual con includeCurrent,
+// al terminar). Devuelve los rayos trazados que había pendientes de contar.
+uint64_t readAdaptiveStats(AdaptiveSampler& sampler, bool includeCurrent);
+
+void printAdaptiveStats(const AdaptiveSampler& sampler);
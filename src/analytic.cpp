@@ -0,0 +1,182 @@
+#include "analytic.h"
+#include "elliptic.h"
+#include <algorithm>
+#include <cmath>
+
+// Unidades internas: U = rs / r, B = b / rs. La órbita cumple (dU/dφ)² = U³ - U² + 1/B².
+// Cada caso da U(x) con x = xStart + rate * ψ (ψ = ángulo barrido desde la cámara).
+enum class OrbitKind { Outer, Inner, Plunge };
+
+struct Orbit {
+    OrbitKind kind;
+    float u1;          // Raíz real menor de la cúbica (negativa)
+    float scale;       // Outer: U2 - U1; Inner: U3 - U1; Plunge: A
+    float m;           // Parámetro k² de las funciones de Jacobi
+    float K;           // K(m)
+    float rate;        // dx/dψ
+    float sign;        // Plunge: x = sign * X (X crece hacia fuera)
+    float xStart, xEnd;
+    bool captured;     // En xEnd: horizonte (true) o infinito (false)
+};
+
+// F(α | m) para α en [0, π] (la segunda mitad por simetría alrededor de K)
+static inline float ellipticFHalfTurn(float alpha, float m, float K) {
+    const float HALF_PI = 1.5707963f;
+    return alpha <= HALF_PI ? ellipticF(alpha, m) : 2.0f * K - ellipticF(3.14159265f - alpha, m);
+}
+
+// x donde la órbita pasa por U (rama creciente de x desde el valor de referencia)
+static inline float orbitInverse(const Orbit& o, float u) {
+    switch (o.kind) {
+        case OrbitKind::Outer: // U = U1 + (U2 - U1) sn²(x)
+            return ellipticF(std::asin(std::sqrt(std::clamp((u - o.u1) / o.scale, 0.0f, 1.0f))), o.m);
+        case OrbitKind::Inner: // U = U1 + (U3 - U1) / sn²(x)
+            return ellipticF(std::asin(std::sqrt(std::clamp(o.scale / (u - o.u1), 0.0f, 1.0f))), o.m);
+        case OrbitKind::Plunge: // U = U1 + A (1 + cn X) / (1 - cn X)
+        default: {
+            float c = (u - o.u1 - o.scale) / (u - o.u1 + o.scale);
+            return ellipticFHalfTurn(std::acos(std::clamp(c, -1.0f, 1.0f)), o.m, o.K);
+        }
+    }
+}
+
+// U y dU/dψ en el parámetro x
+static inline void orbitAt(const Orbit& o, float x, float& u, float& du) {
+    float sn, cn, dn;
+    switch (o.kind) {
+        case OrbitKind::Outer:
+            jacobiSnCnDn(x, o.m, sn, cn, dn);
+            u = o.u1 + o.scale * sn * sn;
+            du = 2.0f * o.rate * o.scale * sn * cn * dn;
+            break;
+        case OrbitKind::Inner:
+            jacobiSnCnDn(x, o.m, sn, cn, dn);
+            u = o.u1 + o.scale / (sn * sn);
+            du = -2.0f * o.rate * o.scale * cn * dn / (sn * sn * sn);
+            break;
+        case OrbitKind::Plunge:
+        default: {
+            jacobiSnCnDn(o.sign * x, o.m, sn, cn, dn);
+            float den = std::max(1.0f - cn, 1e-12f);
+            u = o.u1 + o.scale * (1.0f + cn) / den;
+            du = -2.0f * o.scale * sn * dn / (den * den) * o.sign * o.rate;
+            break;
+        }
+    }
+}
+
+// Raíces de U³ - U² + β y la parametrización que corresponde a la cámara (U0, hacia dentro o no)
+static Orbit solveOrbit(float beta, float u0, bool inward) {
+    Orbit o;
+    const float M_LIMIT = 1.0f - 1e-6f; // m = 1 solo en la órbita crítica (K infinita)
+    float q = beta - 2.0f / 27.0f;      // Cúbica reducida V³ - V/3 + q, U = V + 1/3
+
+    if (q < 2.0f / 27.0f) {
+        // Tres raíces reales U1 < U2 < U3 (b por encima del crítico)
+        float theta = std::acos(std::clamp(-13.5f * q, -1.0f, 1.0f)) * (1.0f / 3.0f);
+        float u3 = 1.0f / 3.0f + 2.0f / 3.0f * std::cos(theta);
+        float u2 = 1.0f / 3.0f + 2.0f / 3.0f * std::cos(theta - 2.0943951f);
+        o.u1 = 1.0f / 3.0f + 2.0f / 3.0f * std::cos(theta - 4.1887902f);
+        o.m = std::min((u2 - o.u1) / (u3 - o.u1), M_LIMIT);
+        o.K = ellipticK(o.m);
+        o.rate = 0.5f * std::sqrt(u3 - o.u1);
+        o.sign = 1.0f;
+        if (u0 <= u2) {
+            // Fuera de la esfera de fotones: pasa por el periastro (x = K) y vuelve al infinito
+            o.kind = OrbitKind::Outer;
+            o.scale = u2 - o.u1;
+            float x0 = orbitInverse(o, u0);
+            o.xStart = inward ? x0 : 2.0f * o.K - x0;
+            o.xEnd = 2.0f * o.K - orbitInverse(o, 0.0f);
+            o.captured = false;
+        } else {
+            // Dentro de la esfera de fotones: como mucho sube hasta U3 (x = K) y cae
+            o.kind = OrbitKind::Inner;
+            o.scale = u3 - o.u1;
+            float x0 = orbitInverse(o, u0);
+            o.xStart = inward ? 2.0f * o.K - x0 : x0;
+            o.xEnd = 2.0f * o.K - orbitInverse(o, 1.0f);
+            o.captured = true;
+        }
+    } else {
+        // Una raíz real U1 y un par complejo p ± i s (b por debajo del crítico): sin periastro
+        float disc = std::sqrt(q * q * 0.25f - 1.0f / 729.0f);
+        o.u1 = std::cbrt(-0.5f * q + disc) + std::cbrt(-0.5f * q - disc) + 1.0f / 3.0f;
+        float p = 0.5f * (1.0f - o.u1);          // Suma de raíces = 1
+        float modulus2 = -beta / o.u1;           // Producto de raíces = -β
+        float delta = p - o.u1;
+        float A = std::sqrt(std::max(delta * delta + modulus2 - p * p, 1e-12f));
+        o.kind = OrbitKind::Plunge;
+        o.scale = A;
+        o.m = std::min((A + delta) / (2.0f * A), M_LIMIT);
+        o.K = ellipticK(o.m);
+        o.rate = std::sqrt(A);
+        o.sign = inward ? -1.0f : 1.0f;
+        float x0 = orbitInverse(o, u0);
+        o.xStart = o.sign * x0;
+        o.xEnd = o.sign * orbitInverse(o, inward ? 1.0f : 0.0f);
+        o.captured = inward;
+    }
+    return o;
+}
+
+RayOutcome traceOutcomeAnalytic(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params) {
+    RayOutcome outcome;
+    steps = 0;
+    const float rs = params.rs;
+    float r0 = length(ro);
+    if (r0 <= rs) return outcome; // Cámara dentro del horizonte
+
+    // Plano de la órbita: e1 = hacia la cámara, e2 = parte tangencial de la dirección (φ crece con el rayo)
+    vec3 e1 = ro * (1.0f / r0);
+    vec3 d = normalize(rd);
+    float dr = dot(d, e1);
+    vec3 tangential = d - e1 * dr;
+    float dt = length(tangential);
+    if (dt < 1e-6f) {
+        // Rayo radial: cae o sale en línea recta
+        if (dr < 0.0f) return outcome;
+        outcome.kind = OutcomeKind::Escaped;
+        outcome.dir = e1;
+        return outcome;
+    }
+    vec3 e2 = tangential * (1.0f / dt);
+
+    // Parámetro de impacto b = L / E con la dirección como velocidad de coordenadas (igual que kerr.cpp)
+    float lapse = 1.0f - rs / r0;
+    float B = r0 * dt / std::sqrt(dr * dr + lapse * dt * dt) / rs;
+    Orbit orbit = solveOrbit(1.0f / (B * B), rs / r0, dr < 0.0f);
+    float sweep = std::max(orbit.xEnd - orbit.xStart, 0.0f) / orbit.rate; // Ángulo total barrido
+
+    // Nodos: y(ψ) ∝ cos ψ e1.y + sin ψ e2.y se anula cada π
+    float node = std::atan2(-e1.y, e2.y);
+    if (node <= 1e-4f) node += 3.14159265f;
+    if (node <= 1e-4f) node += 3.14159265f;
+    for (int i = 0; i < ANALYTIC_MAX_CROSSINGS; i++) {
+        float psi = node + 3.14159265f * i;
+        if (psi >= sweep) break;
+        steps++;
+        float u, du;
+        orbitAt(orbit, orbit.xStart + orbit.rate * psi, u, du);
+        float hitDist = rs / u;
+        if (hitDist > params.diskInner && hitDist < params.diskOuter) {
+            float c = std::cos(psi), s = std::sin(psi);
+            vec3 radial = e1 * c + e2 * s;
+            vec3 hitPoint = radial * hitDist;
+            // dr/dψ ∝ -dU/dψ, r dψ ∝ U (multiplicando ambos por U² / rs)
+            vec3 vel = radial * (-du) + (e2 * c - e1 * s) * u;
+            vec3 diskTangent = normalize({-hitPoint.z, 0.0f, hitPoint.x});
+            outcome.kind = OutcomeKind::Disk;
+            outcome.hitDist = hitDist;
+            outcome.angle = std::atan2(hitPoint.z, hitPoint.x);
+            outcome.doppler = dot(normalize(vel), diskTangent);
+            return outcome;
+        }
+    }
+
+    if (orbit.captured) return outcome;
+    // En el infinito el rayo va en la dirección radial del ángulo final
+    outcome.kind = OutcomeKind::Escaped;
+    outcome.dir = e1 * std::cos(sweep) + e2 * std::sin(sweep);
+    return outcome;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "cpu_tracer.h"
+
+// --- SCHWARZSCHILD EN FORMA CERRADA (SIN PASOS) ---
+// Una geodésica nula de Schwarzschild vive en el plano que forman el centro,
+// la cámara y la dirección del rayo, y su órbita u(φ) = rs / r cumple
+// (du/dφ)² = u³ - u² + (rs / b)²: la solución es una función elíptica de
+// Jacobi. Con las raíces de esa cúbica se sabe de antemano si el rayo cae o
+// escapa, cuánto ángulo barre y en qué ángulos corta el plano del disco (cada
+// π, a partir del primer nodo); basta evaluar r en esos ángulos. Coste fijo
+// por rayo, sin MAX_STEPS. Misma física que --kerr 0 (la dirección de la
+// cámara es la velocidad de coordenadas) y mismo algoritmo que shaders/analytic.glsl.
+
+const int ANALYTIC_MAX_CROSSINGS = 4;  // Cruces del plano del disco que se miran (imágenes de orden 0-3)
+
+// Parámetro de impacto crítico (sombra): b < ANALYTIC_CRITICAL_B * rs cae si va hacia dentro
+const float ANALYTIC_CRITICAL_B = 2.598076211f; // 3√3 / 2
+
+// Igual que traceOutcome, para la métrica de Schwarzschild exacta. 'steps' = cruces evaluados.
+RayOutcome traceOutcomeAnalytic(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params);
@@ -0,0 +1,224 @@
+#include <glad/gl.h>
+#include "bhsim.h"
+#include "config.h"
+#include "cpu_tracer.h"
+#include "gl_renderer.h"
+#include "hdr.h"
+#include "image_io.h"
+#include <chrono>
+#include <iostream>
+#include <new>
+
+struct bhsim_renderer {
+    bhsim_backend backend = BHSIM_BACKEND_CPU;
+    CpuTracer tracer;  // BHSIM_BACKEND_CPU
+    GlRenderer gl;     // BHSIM_BACKEND_GL
+    CameraState camera;
+    CpuFrameStats last;
+    bhsim_stats total = {0, 0, 0, 0.0};
+};
+
+// Backend GL: shaders y texturas en el contexto actual del que llama
+static bhsim_status createGlBackend(const bhsim_options& options, bhsim_renderer& r) {
+    if (!gladLoadGL((GLADloadfunc)options.gl_get_proc_address)) {
+        std::cout << "ERROR: bhsim: no se pudieron cargar las funciones GL (¿hay un contexto activo?)" << std::endl;
+        return BHSIM_ERROR_INIT;
+    }
+    AppConfig config;
+    config.threads = options.threads;
+    config.skyboxPath = options.skybox_path;
+    config.shaderDir = options.shader_dir;
+    config.equirectSkybox = options.skybox_face_size < 0;
+    config.skyboxFaceSize = options.skybox_face_size < 0 ? 0 : options.skybox_face_size;
+    config.diskNoiseSize = options.disk_noise_size;
+    config.diskOctaves = options.disk_octaves;
+    config.framesInFlight = 1; // Cada imagen se lee antes de volver: no hay frames en vuelo
+    if (!createGlRenderer(r.gl, config, nullptr, 1, 1)) {
+        destroyGlRenderer(r.gl);
+        return BHSIM_ERROR_INIT;
+    }
+    return BHSIM_OK;
+}
+
+static bhsim_status checkParams(const bhsim_params& params) {
+    if (!(params.rs > 0.0f) || !(params.disk_inner > 0.0f) || !(params.disk_outer > params.disk_inner)) {
+        std::cout << "ERROR: bhsim: hace falta rs > 0 y 0 < disk_inner < disk_outer" << std::endl;
+        return BHSIM_ERROR_INVALID_ARGUMENT;
+    }
+    return BHSIM_OK;
+}
+
+extern "C" {
+
+void bhsim_default_options(bhsim_options* options) {
+    if (!options) return;
+    AppConfig defaults;
+    options->backend = BHSIM_BACKEND_CPU;
+    options->threads = defaults.threads;
+    options->skybox_path = nullptr;
+    options->skybox_face_size = defaults.skyboxFaceSize;
+    options->disk_noise_size = defaults.diskNoiseSize;
+    options->disk_octaves = defaults.diskOctaves;
+    options->numa_nodes = 0;
+    options->shader_dir = nullptr;
+    options->gl_get_proc_address = nullptr;
+}
+
+bhsim_status bhsim_create(const bhsim_options* options, bhsim_renderer** renderer) {
+    if (!renderer) return BHSIM_ERROR_INVALID_ARGUMENT;
+    *renderer = nullptr;
+    // Sin valores por defecto para las rutas: relativas al directorio de trabajo solo tienen
+    // sentido para el ejecutable lanzado desde build/, no para quien enlaza la biblioteca
+    if (!options || !options->skybox_path) {
+        std::cout << "ERROR: bhsim: falta skybox_path" << std::endl;
+        return BHSIM_ERROR_INVALID_ARGUMENT;
+    }
+    bool gl = options->backend == BHSIM_BACKEND_GL;
+    if ((options->backend != BHSIM_BACKEND_CPU && !gl) || options->threads < 0 || options->numa_nodes < 0 ||
+        options->disk_noise_size < 64 || options->disk_noise_size > 8192 ||
+        options->disk_octaves < 1 || options->disk_octaves > 8) {
+        std::cout << "ERROR: bhsim: opciones no válidas" << std::endl;
+        return BHSIM_ERROR_INVALID_ARGUMENT;
+    }
+    if (gl && (!options->shader_dir || !options->gl_get_proc_address)) {
+        std::cout << "ERROR: bhsim: el backend GL necesita shader_dir y gl_get_proc_address" << std::endl;
+        return BHSIM_ERROR_INVALID_ARGUMENT;
+    }
+
+    bhsim_renderer* r = new (std::nothrow) bhsim_renderer();
+    if (!r) return BHSIM_ERROR_INIT;
+    r->backend = options->backend;
+    if (gl) {
+        bhsim_status status = createGlBackend(*options, *r);
+        if (status != BHSIM_OK) {
+            delete r;
+            return status;
+        }
+        *renderer = r;
+        return BHSIM_OK;
+    }
+    r->tracer.numaNodes = options->numa_nodes;
+    if (!startCpuTracer(r->tracer, options->threads, options->skybox_path, options->skybox_face_size,
+                        options->disk_noise_size, options->disk_octaves)) {
+        delete r;
+        return BHSIM_ERROR_INIT;
+    }
+    *renderer = r;
+    return BHSIM_OK;
+}
+
+void bhsim_destroy(bhsim_renderer* renderer) {
+    if (!renderer) return;
+    if (renderer->backend == BHSIM_BACKEND_GL) destroyGlRenderer(renderer->gl);
+    else stopCpuTracer(renderer->tracer);
+    delete renderer;
+}
+
+bhsim_status bhsim_set_camera(bhsim_renderer* renderer, const bhsim_camera* camera) {
+    if (!renderer || !camera) return BHSIM_ERROR_INVALID_ARGUMENT;
+    CameraState& c = renderer->camera;
+    c.x = camera->x; c.y = camera->y; c.z = camera->z;
+    c.yaw = camera->yaw; c.pitch = camera->pitch; c.focal = camera->focal;
+    return BHSIM_OK;
+}
+
+bhsim_status bhsim_set_params(bhsim_renderer* renderer, const bhsim_params* params) {
+    if (!renderer || !params) return BHSIM_ERROR_INVALID_ARGUMENT;
+    bhsim_status status = checkParams(*params);
+    if (status != BHSIM_OK) return status;
+    if (renderer->backend == BHSIM_BACKEND_GL) {
+        BlackHoleParams shader;
+        if (params->rs != shader.rs || params->disk_inner != shader.diskInner || params->disk_outer != shader.diskOuter) {
+            std::cout << "ERROR: bhsim: el backend GL solo traza rs = " << shader.rs << ", disco " << shader.diskInner
+                      << "-" << shader.diskOuter << " (constantes de blackhole_common.glsl)" << std::endl;
+            return BHSIM_ERROR_INVALID_ARGUMENT;
+        }
+        return BHSIM_OK;
+    }
+    renderer->tracer.params.rs = params->rs;
+    renderer->tracer.params.diskInner = params->disk_inner;
+    renderer->tracer.params.diskOuter = params->disk_outer;
+    return BHSIM_OK;
+}
+
+bhsim_status bhsim_set_adaptive(bhsim_renderer* renderer, int step, float threshold) {
+    if (!renderer || step > 16 || !(threshold > 0.0f)) return BHSIM_ERROR_INVALID_ARGUMENT;
+    if (renderer->backend == BHSIM_BACKEND_GL) {
+        return setGlAdaptive(renderer->gl, step, threshold) ? BHSIM_OK : BHSIM_ERROR_INIT;
+    }
+    renderer->tracer.adaptiveStep = step;
+    renderer->tracer.adaptiveThreshold = threshold;
+    return BHSIM_OK;
+}
+
+bhsim_status bhsim_render_region(bhsim_renderer* renderer, float time, int width, int height,
+                                 int x0, int y0, int x1, int y1, float* rgb) {
+    if (!renderer || !rgb || width <= 0 || height <= 0 || x0 < 0 || y0 < 0 || x1 > width || y1 > height ||
+        x0 >= x1 || y0 >= y1) {
+        return BHSIM_ERROR_INVALID_ARGUMENT;
+    }
+    CpuFrameStats& stats = renderer->last;
+    if (renderer->backend == BHSIM_BACKEND_GL) {
+        GlRenderer& gl = renderer->gl;
+        auto start = std::chrono::steady_clock::now();
+        waitGlFrameSlot(gl);
+        traceGlImage(gl, renderer->camera, time, width, height, false);
+        readGlImage(gl, x0, y0, x1 - x0, y1 - y0, rgb); // Espera a la GPU
+        endGlFrame(gl);
+        stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        // Adaptativo: la lectura ya esperó a la GPU, así que el contador del frame está listo
+        stats.rays = gl.adaptive.step > 1 ? (long long)readAdaptiveStats(gl.adaptive, true) : (long long)width * height;
+        stats.steps = 0;
+    } else {
+        renderRegionIntoCPU(renderer->tracer, renderer->camera, time, width, height, x0, y0, x1 - x0, y1 - y0, rgb,
+                            stats);
+    }
+    renderer->total.frames++;
+    renderer->total.rays += stats.rays;
+    renderer->total.steps += stats.steps;
+    renderer->total.ms += stats.ms;
+    return BHSIM_OK;
+}
+
+bhsim_status bhsim_render(bhsim_renderer* renderer, float time, int width, int height, float* rgb) {
+    return bhsim_render_region(renderer, time, width, height, 0, 0, width, height, rgb);
+}
+
+bhsim_status bhsim_get_stats(const bhsim_renderer* renderer, bhsim_stats* last, bhsim_stats* total) {
+    if (!renderer) return BHSIM_ERROR_INVALID_ARGUMENT;
+    if (last) {
+        last->frames = renderer->total.frames > 0 ? 1 : 0;
+        last->rays = renderer->last.rays;
+        last->steps = renderer->last.steps;
+        last->ms = renderer->last.ms;
+    }
+    if (total) *total = renderer->total;
+    return BHSIM_OK;
+}
+
+float bhsim_auto_exposure(const float* rgb, int width, int height) {
+    if (!rgb || width <= 0 || height <= 0) return 1.0f;
+    LuminanceStats stats = computeLuminanceStatsCPU(rgb, width * height, 1.0f);
+    return updateExposure(1.0f, stats, 1e6f); // dt enorme: directamente la exposición objetivo
+}
+
+void bhsim_tonemap_rgb8(const float* rgb, int width, int height, float exposure, int top_down,
+                        unsigned char* out) {
+    if (!rgb || !out || width <= 0 || height <= 0) return;
+    size_t rowFloats = (size_t)width * 3;
+    for (int y = 0; y < height; y++) {
+        int src = top_down ? height - 1 - y : y;
+        tonemapToRGB8(rgb + src * rowFloats, rowFloats, exposure, out + y * rowFloats);
+    }
+}
+
+const char* bhsim_status_string(bhsim_status status) {
+    switch (status) {
+        case BHSIM_OK: return "ok";
+        case BHSIM_ERROR_INVALID_ARGUMENT: return "argumento no válido";
+        case BHSIM_ERROR_INIT: return "no se pudo preparar el trazador";
+    }
+    return "estado desconocido";
+}
+
+}
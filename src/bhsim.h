@@ -0,0 +1,118 @@
+#ifndef BHSIM_H
+#define BHSIM_H
+#include <stddef.h>
+
+/* --- LIBBHSIM: API EN C ---
+ * Los trazadores (CPU o GPU con OpenGL) como biblioteca (estática o compartida)
+ * para llamarlos dentro del proceso en vez de lanzar el ejecutable por imagen.
+ * El renderer se crea una vez (hilos o shaders, cielo y ruido del disco quedan
+ * preparados) y cada bhsim_render escribe directamente en el buffer del que llama.
+ *
+ * Backend GL: el que llama crea el contexto (3.3 core + compute shaders, p. ej. una
+ * ventana oculta de GLFW) y lo tiene activo en el hilo de todas las llamadas,
+ * bhsim_destroy incluido. La biblioteca carga las funciones con gl_get_proc_address.
+ *
+ * Imágenes: RGB float lineal (HDR), 3 floats por píxel, fila 0 = abajo
+ * (igual que las texturas de GL y los PPM del modo sin ventana).
+ * Un renderer no es reentrante: una llamada a la vez por renderer. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(BHSIM_SHARED)
+#  ifdef BHSIM_BUILDING
+#    define BHSIM_API __declspec(dllexport)
+#  else
+#    define BHSIM_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define BHSIM_API __attribute__((visibility("default")))
+#else
+#  define BHSIM_API
+#endif
+
+#define BHSIM_API_VERSION 2
+
+typedef struct bhsim_renderer bhsim_renderer;
+
+typedef enum bhsim_status {
+    BHSIM_OK = 0,
+    BHSIM_ERROR_INVALID_ARGUMENT = 1,  /* Puntero nulo, tamaño o parámetro fuera de rango */
+    BHSIM_ERROR_INIT = 2               /* No se pudo preparar el trazador (p. ej. falta el cielo) */
+} bhsim_status;
+
+typedef enum bhsim_backend {
+    BHSIM_BACKEND_CPU = 0,             /* Trazador de CPU (cpu_tracer.h) */
+    BHSIM_BACKEND_GL = 1               /* Compute shaders en el contexto GL del que llama (gl_renderer.h) */
+} bhsim_backend;
+
+/* Cargador de funciones GL: compatible con glfwGetProcAddress, eglGetProcAddress... */
+typedef void (*bhsim_gl_proc)(void);
+typedef bhsim_gl_proc (*bhsim_gl_loader)(const char* name);
+
+typedef struct bhsim_options {
+    bhsim_backend backend;
+    int threads;                       /* 0 = todos los núcleos (GL: solo para preparar el cielo y el ruido) */
+    const char* skybox_path;           /* Obligatorio: panorama equirectangular del cielo */
+    int skybox_face_size;              /* 0 = automático, < 0 = panorama sin cubemap */
+    int disk_noise_size;               /* Resolución del ruido del disco horneado (64-8192) */
+    int disk_octaves;                  /* 1-8 */
+    int numa_nodes;                    /* 0 = sin NUMA; N = hilos fijados en los N primeros nodos (CPU) */
+    const char* shader_dir;            /* GL, obligatorio: carpeta de los .glsl (shaders/ del repositorio) */
+    bhsim_gl_loader gl_get_proc_address; /* GL, obligatorio */
+} bhsim_options;
+
+typedef struct bhsim_camera {
+    float x, y, z;                     /* Posición */
+    float yaw, pitch;                  /* Giro respecto a "mirar al origen" (radianes) */
+    float focal;                       /* Distancia focal del plano de imagen */
+} bhsim_camera;
+
+typedef struct bhsim_params {
+    float rs;                          /* Radio del horizonte */
+    float disk_inner, disk_outer;      /* Radios del disco */
+} bhsim_params;
+
+typedef struct bhsim_stats {
+    long long frames;
+    long long rays;                    /* Rayos trazados (menos que píxeles con muestreo adaptativo) */
+    long long steps;                   /* Pasos del integrador (GL: 0, la GPU no los cuenta) */
+    double ms;                         /* Tiempo de trazado */
+} bhsim_stats;
+
+/* Rellena los valores por defecto (los mismos que el ejecutable sin opciones).
+ * Las rutas y el cargador GL quedan a NULL: las pone el que llama. */
+BHSIM_API void bhsim_default_options(bhsim_options* options);
+BHSIM_API bhsim_status bhsim_create(const bhsim_options* options, bhsim_renderer** renderer);
+BHSIM_API void bhsim_destroy(bhsim_renderer* renderer);
+
+BHSIM_API bhsim_status bhsim_set_camera(bhsim_renderer* renderer, const bhsim_camera* camera);
+/* GL: rs y el disco son constantes de los shaders; otros valores devuelven BHSIM_ERROR_INVALID_ARGUMENT */
+BHSIM_API bhsim_status bhsim_set_params(bhsim_renderer* renderer, const bhsim_params* params);
+/* step <= 1 desactiva el muestreo adaptativo */
+BHSIM_API bhsim_status bhsim_set_adaptive(bhsim_renderer* renderer, int step, float threshold);
+
+/* Traza una imagen de width x height en rgb (width * height * 3 floats) */
+BHSIM_API bhsim_status bhsim_render(bhsim_renderer* renderer, float time, int width, int height, float* rgb);
+/* Solo el rectángulo [x0, x1) x [y0, y1) de la imagen; rgb tiene (x1 - x0) * (y1 - y0) * 3 floats.
+ * GL: se traza la imagen entera y se copia el rectángulo. */
+BHSIM_API bhsim_status bhsim_render_region(bhsim_renderer* renderer, float time, int width, int height,
+                                           int x0, int y0, int x1, int y1, float* rgb);
+
+/* last: la última llamada a bhsim_render*; total: desde bhsim_create. Cualquiera puede ser NULL. */
+BHSIM_API bhsim_status bhsim_get_stats(const bhsim_renderer* renderer, bhsim_stats* last, bhsim_stats* total);
+
+/* Exposición automática ya adaptada a la imagen (como --sweep) */
+BHSIM_API float bhsim_auto_exposure(const float* rgb, int width, int height);
+/* Exposición, Reinhard y gamma 2.2 (como los PPM). top_down != 0 invierte las filas (fila 0 = arriba). */
+BHSIM_API void bhsim_tonemap_rgb8(const float* rgb, int width, int height, float exposure, int top_down,
+                                  unsigned char* out);
+
+BHSIM_API const char* bhsim_status_string(bhsim_status status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BHSIM_H */
@@ -0,0 +1,20 @@
+#include "camera.h"
+#include <algorithm>
+
+CameraBasis computeCameraBasis(const CameraState& cam) {
+    vec3 pos = {cam.x, cam.y, cam.z};
+    vec3 toHole = normalize(pos * -1.0f);
+
+    // Pasamos a ángulos, sumamos el giro y volvemos a vector
+    const float maxPitch = 1.55f; // ~89°: evita el polo donde "arriba" deja de estar definido
+    float azimuth = std::atan2(toHole.x, toHole.z) + cam.yaw;
+    float elevation = std::asin(std::clamp(toHole.y, -1.0f, 1.0f)) + cam.pitch;
+    elevation = std::clamp(elevation, -maxPitch, maxPitch);
+
+    CameraBasis basis;
+    basis.forward = {std::cos(elevation) * std::sin(azimuth), std::sin(elevation), std::cos(elevation) * std::cos(azimuth)};
+    basis.right = normalize(basis.forward.cross({0.0f, 1.0f, 0.0f}));
+    basis.up = basis.right.cross(basis.forward);
+    basis.focal = cam.focal;
+    return basis;
+}
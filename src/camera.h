@@ -0,0 +1,19 @@
+#pragma once
+#include "vec3.h"
+
+// --- ESTADO Y BASE DE LA CÁMARA ---
+// Compartido por el trazador de GPU (FrameBlock), el de CPU y las grabaciones.
+struct CameraState {
+    float x = 0.0f, y = 0.0f, z = 5.0f; // Posición
+    float yaw = 0.0f;                   // Giro horizontal respecto a "mirar al origen" (radianes)
+    float pitch = 0.0f;                 // Giro vertical (radianes)
+    float focal = 2.0f;                 // Distancia focal del plano de imagen
+};
+
+struct CameraBasis {
+    vec3 right, up, forward;
+    float focal;
+};
+
+// Mirar al agujero (como el antiguo setCamera del shader) más el giro del ratón
+CameraBasis computeCameraBasis(const CameraState& cam);
@@ -0,0 +1,86 @@
+#include "camera_path.h"
+#include "metrics.h"
+#include <iostream>
+#include <cstring>
+
+static const char CAMERA_PATH_MAGIC[4] = {'B', 'H', 'C', 'P'};
+static const std::streamoff FRAME_COUNT_OFFSET = 12; // magic + versión + dt
+
+template <typename T>
+static void writeRaw(std::ofstream& file, const T& value) {
+    file.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+static bool readRaw(std::ifstream& file, T& value) {
+    return (bool)file.read((char*)&value, sizeof(T));
+}
+
+bool openCameraPathRecorder(CameraPathRecorder& recorder, const std::string& path, float fixedDt) {
+    recorder.file.open(path, std::ios::binary);
+    if (!recorder.file) {
+        std::cout << "ERROR: No se pudo crear la grabación: " << path << std::endl;
+        return false;
+    }
+    recorder.file.write(CAMERA_PATH_MAGIC, 4);
+    writeRaw(recorder.file, CAMERA_PATH_VERSION);
+    writeRaw(recorder.file, fixedDt);
+    writeRaw(recorder.file, (uint32_t)0); // Se corrige al cerrar
+    recorder.frames = 0;
+    std::cout << "Grabando recorrido de cámara en " << path << std::endl;
+    return true;
+}
+
+void recordCameraPathFrame(CameraPathRecorder& recorder, const CameraPathFrame& frame) {
+    if (!recorder.file) return;
+    const CameraState& c = frame.camera;
+    float values[6] = {c.x, c.y, c.z, c.yaw, c.pitch, c.focal};
+    recorder.file.write((const char*)values, sizeof(values));
+    writeRaw(recorder.file, (uint8_t)(frame.animateDisk ? CAMERA_PATH_ANIMATE : 0));
+    recorder.frames++;
+    countMetric(MetricCounter::BytesWritten, sizeof(values) + 1);
+}
+
+void closeCameraPathRecorder(CameraPathRecorder& recorder) {
+    if (!recorder.file.is_open()) return;
+    recorder.file.seekp(FRAME_COUNT_OFFSET);
+    writeRaw(recorder.file, recorder.frames);
+    recorder.file.close();
+    std::cout << "Recorrido grabado: " << recorder.frames << " frames" << std::endl;
+}
+
+bool loadCameraPath(const std::string& path, CameraPath& cameraPath) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR: No se pudo abrir la grabación: " << path << std::endl;
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, frameCount = 0;
+    if (!file.read(magic, 4) || std::memcmp(magic, CAMERA_PATH_MAGIC, 4) != 0 ||
+        !readRaw(file, version) || version != CAMERA_PATH_VERSION ||
+        !readRaw(file, cameraPath.fixedDt) || !readRaw(file, frameCount)) {
+        std::cout << "ERROR: Grabación no válida o de otra versión: " << path << std::endl;
+        return false;
+    }
+
+    cameraPath.frames.clear();
+    cameraPath.frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        float values[6];
+        uint8_t flags = 0;
+        if (!file.read((char*)values, sizeof(values)) || !readRaw(file, flags)) {
+            std::cout << "ERROR: Grabación truncada en el frame " << i << ": " << path << std::endl;
+            return false;
+        }
+        CameraPathFrame frame;
+        frame.camera.x = values[0]; frame.camera.y = values[1]; frame.camera.z = values[2];
+        frame.camera.yaw = values[3]; frame.camera.pitch = values[4]; frame.camera.focal = values[5];
+        frame.animateDisk = (flags & CAMERA_PATH_ANIMATE) != 0;
+        cameraPath.frames.push_back(frame);
+    }
+
+    std::cout << "Recorrido cargado: " << frameCount << " frames, dt fijo " << cameraPath.fixedDt << " s" << std::endl;
+    return true;
+}
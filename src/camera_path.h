@@ -0,0 +1,39 @@
+#pragma once
+#include "camera.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+// --- GRABACIÓN Y REPRODUCCIÓN DE RECORRIDOS DE CÁMARA ---
+// Formato binario compacto (little-endian, como las máquinas donde corre):
+//   cabecera: "BHCP" | uint32 versión | float dt fijo | uint32 número de frames
+//   frame:    float x, y, z, yaw, pitch, focal | uint8 flags (bit 0 = disco animado)
+// Al reproducir se usa el dt fijo de la cabecera en lugar del reloj real,
+// así dos ejecuciones generan exactamente la misma secuencia de frames.
+
+const uint32_t CAMERA_PATH_VERSION = 1;
+const uint8_t CAMERA_PATH_ANIMATE = 1;
+
+struct CameraPathFrame {
+    CameraState camera;
+    bool animateDisk = true;
+};
+
+struct CameraPath {
+    float fixedDt = 1.0f / 60.0f;
+    std::vector<CameraPathFrame> frames;
+};
+
+// Grabación incremental: cada frame se escribe al momento (no se pierde nada si se cierra mal)
+struct CameraPathRecorder {
+    std::ofstream file;
+    uint32_t frames = 0;
+};
+
+bool openCameraPathRecorder(CameraPathRecorder& recorder, const std::string& path, float fixedDt);
+void recordCameraPathFrame(CameraPathRecorder& recorder, const CameraPathFrame& frame);
+// Reescribe el número de frames en la cabecera y cierra
+void closeCameraPathRecorder(CameraPathRecorder& recorder);
+
+bool loadCameraPath(const std::string& path, CameraPath& cameraPath);
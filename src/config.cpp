@@ -0,0 +1,367 @@
+#include "config.h"
+#include "integrators.h"
+#include "spacetime.h"
+#include "cpu_tracer.h"
+#include "farm.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage(const char* exe) {
+    std::cout << "Uso: " << exe << " [opciones]\n"
+              << "  --swap-interval N      Intervalo de swap (0 = sin VSync, 1 = VSync)\n"
+              << "  --frames-in-flight N   Máximo de frames encolados en la GPU (1-4)\n"
+              << "  --latency-log FICHERO  Guarda la latencia entrada->swap de cada frame (CSV)\n"
+              << "  --background-fps N     Límite de fps cuando la ventana no tiene foco (0 = sin límite)\n"
+              << "  --no-animation         Empieza con la animación del disco congelada (tecla P)\n"
+              << "  --envmap               Modo 360°: traza un cubemap una vez y gira la vista gratis (tecla M)\n"
+              << "  --envmap-size N        Resolución de cada cara del cubemap (por defecto 1024)\n"
+              << "  --record FICHERO       Graba el recorrido de la cámara (binario)\n"
+              << "  --replay FICHERO       Reproduce un recorrido grabado con dt fijo\n"
+              << "  --fixed-dt S           dt fijo que se guarda al grabar (por defecto 1/60)\n"
+              << "  --report FICHERO       Informe CSV de tiempos por frame de la reproducción\n"
+              << "  --headless             Sin ventana: traza en CPU (requiere --replay)\n"
+              << "  --width N / --height N Resolución del modo sin ventana (800x600)\n"
+              << "  --threads N            Hilos del trazador de CPU (0 = todos)\n"
+              << "  --output-dir DIR       Guarda cada frame del modo sin ventana como PPM\n"
+              << "  --metrics-port N       Sirve métricas de Prometheus en 127.0.0.1:N\n"
+              << "  --trace FICHERO        Guarda una línea de tiempo (JSON de Chrome/Perfetto)\n"
+              << "  --convert-skybox IMG   Preprocesa el cielo (mipmaps incluidos) en IMG.bhsky y sale\n"
+              << "  --skybox IMG           Panorama equirectangular del cielo (../textures/background.jpg)\n"
+              << "  --shader-dir DIR       Carpeta de los shaders de la ventana (../shaders/)\n"
+              << "  --skybox-equirect      Cielo equirectangular (sin remuestrear a cubemap)\n"
+              << "  --skybox-face N        Resolución de las caras del cubemap del cielo (0 = ancho/4)\n"
+              << "  --bench-background     Mide el coste de buscar el cielo (panorama vs cubemap) y sale\n"
+              << "  --disk-noise-size N    Resolución del ruido del disco horneado (N x N, por defecto 1024)\n"
+              << "  --disk-octaves N       Octavas del ruido del disco (1-8, por defecto 5)\n"
+              << "  --bench-disk           Mide el coste del ruido del disco (fbm vs textura horneada) y sale\n"
+              << "  --adaptive N           Traza 1 de cada N x N píxeles y refina solo en los bordes (2-16)\n"
+              << "  --adaptive-threshold T Diferencia de color entre esquinas que obliga a refinar (0.08)\n"
+              << "  --interleave N         Traza 1/N de los píxeles por frame y reconstruye el resto (2 o 4)\n"
+              << "  --numa                 Trazador CPU: fija los hilos por nodo NUMA y replica el cielo en cada nodo\n"
+              << "  --numa-nodes N         Usa solo los N primeros nodos NUMA (implica --numa)\n"
+              << "  --huge-pages           Copias del cielo del trazador CPU con páginas enormes (THP)\n"
+              << "  --bench-numa           Mide el escalado del trazador CPU de 1 nodo NUMA a todos y sale\n"
+              << "  --farm-coordinator P   Reparte --replay entre trabajadores conectados al puerto P\n"
+              << "  --farm-bind DIR        Dirección en la que escucha el coordinador (127.0.0.1)\n"
+              << "  --farm-tile N          Trabajos de N x N píxeles (0 = un frame entero por trabajo)\n"
+              << "  --farm-local N         Lanza N trabajadores en este nodo (solo POSIX)\n"
+              << "  --farm-worker H:P      Trabajador de la granja: traza en CPU lo que mande el coordinador\n"
+              << "  --farm-timeout S       Segundos sin noticias de un trabajador para darlo por colgado (30)\n"
+              << "  --sweep FICHERO        Una imagen por fila de la tabla CSV (cámara, rs, disco, spin, tiempo) y sale\n"
+              << "  --kerr A               Agujero en rotación (spin a/M entre -0.999 y 0.999), CPU y GPU\n"
+              << "  --analytic             Schwarzschild exacto en forma cerrada (funciones elípticas, sin pasos)\n"
+              << "  --charge Q             Agujero con carga (Reissner-Nordström, |Q| < rs / 2), CPU y GPU\n"
+              << "  --lambda L             Constante cosmológica (Schwarzschild-de Sitter), CPU y GPU\n"
+              << "  --lenses FICHERO       Varias lentes (una por línea: x y z rs) en lugar del agujero único, CPU y GPU\n"
+              << "  --binary D             Binaria: dos agujeros de rs / 2 separados D (mayor que rs)\n"
+              << "  --lens-tolerance T     Aceleración a partir de la cual se poda una lente o se agrupa (1e-4, 0 = nunca)\n"
+              << "  --bench-engines        Mide el coste por rayo de cada motor (pseudo-newtoniano, analítico, Kerr) y sale\n"
+              << "  --integrator NOMBRE    rk4 | verlet | yoshida4 | rkf45 (trazador de CPU; la GPU siempre usa rk4)\n"
+              << "  --null-renorm          Conserva la energía del rayo reescalando la velocidad en cada paso (CPU)\n"
+              << "  --no-ray-classes       Sin clasificar rayos (condenados, lejanos): el bucle completo de antes, para comparar\n"
+              << "  --bench-integrators    Precisión frente a evaluaciones de la aceleración por rayo y sale\n"
+              << "  --fast-math            Aproximaciones rápidas (rsqrt, atan2, asin) en el trazador, CPU y GPU\n"
+              << "  --bench-fast-math      Error máximo y aceleración de --fast-math (funciones e imagen) y sale\n"
+              << "  --disk-opacity A       Disco semitransparente (0 < A < 1): el rayo lo atraviesa y se ven los anillos de detrás\n"
+              << "  --disk-orders N        Cruces del disco semitransparente como máximo (1-" << DISK_MAX_ORDER << ", por defecto "
+              << DISK_MAX_ORDER << ")\n";
+}
+
+// Lee el valor entero que sigue a una opción
+static bool readInt(int argc, char** argv, int& i, int& out) {
+    if (i + 1 >= argc) {
+        std::cout << "ERROR: Falta el valor de " << argv[i] << std::endl;
+        return false;
+    }
+    char* end = nullptr;
+    long value = std::strtol(argv[++i], &end, 10);
+    if (*end != '\0') {
+        std::cout << "ERROR: Valor no numérico para " << argv[i - 1] << ": " << argv[i] << std::endl;
+        return false;
+    }
+    out = (int)value;
+    return true;
+}
+
+static bool readFloat(int argc, char** argv, int& i, float& out) {
+    if (i + 1 >= argc) {
+        std::cout << "ERROR: Falta el valor de " << argv[i] << std::endl;
+        return false;
+    }
+    char* end = nullptr;
+    float value = std::strtof(argv[++i], &end);
+    if (*end != '\0') {
+        std::cout << "ERROR: Valor no numérico para " << argv[i - 1] << ": " << argv[i] << std::endl;
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+static bool readString(int argc, char** argv, int& i, std::string& out) {
+    if (i + 1 >= argc) {
+        std::cout << "ERROR: Falta el valor de " << argv[i] << std::endl;
+        return false;
+    }
+    out = argv[++i];
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, AppConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool ok = true;
+
+        if (std::strcmp(arg, "--swap-interval") == 0) ok = readInt(argc, argv, i, config.swapInterval);
+        else if (std::strcmp(arg, "--frames-in-flight") == 0) ok = readInt(argc, argv, i, config.framesInFlight);
+        else if (std::strcmp(arg, "--latency-log") == 0) ok = readString(argc, argv, i, config.latencyLogPath);
+        else if (std::strcmp(arg, "--background-fps") == 0) {
+            int fps = 0;
+            ok = readInt(argc, argv, i, fps);
+            config.backgroundFps = (float)fps;
+        }
+        else if (std::strcmp(arg, "--no-animation") == 0) config.animateDisk = false;
+        else if (std::strcmp(arg, "--envmap") == 0) config.envMapMode = true;
+        else if (std::strcmp(arg, "--envmap-size") == 0) ok = readInt(argc, argv, i, config.envMapSize);
+        else if (std::strcmp(arg, "--record") == 0) ok = readString(argc, argv, i, config.recordPath);
+        else if (std::strcmp(arg, "--replay") == 0) ok = readString(argc, argv, i, config.replayPath);
+        else if (std::strcmp(arg, "--fixed-dt") == 0) ok = readFloat(argc, argv, i, config.fixedDt);
+        else if (std::strcmp(arg, "--report") == 0) ok = readString(argc, argv, i, config.reportPath);
+        else if (std::strcmp(arg, "--headless") == 0) config.headless = true;
+        else if (std::strcmp(arg, "--width") == 0) ok = readInt(argc, argv, i, config.width);
+        else if (std::strcmp(arg, "--height") == 0) ok = readInt(argc, argv, i, config.height);
+        else if (std::strcmp(arg, "--threads") == 0) ok = readInt(argc, argv, i, config.threads);
+        else if (std::strcmp(arg, "--output-dir") == 0) ok = readString(argc, argv, i, config.outputDir);
+        else if (std::strcmp(arg, "--skybox") == 0) ok = readString(argc, argv, i, config.skyboxPath);
+        else if (std::strcmp(arg, "--shader-dir") == 0) ok = readString(argc, argv, i, config.shaderDir);
+        else if (std::strcmp(arg, "--skybox-equirect") == 0) config.equirectSkybox = true;
+        else if (std::strcmp(arg, "--skybox-face") == 0) ok = readInt(argc, argv, i, config.skyboxFaceSize);
+        else if (std::strcmp(arg, "--bench-background") == 0) config.benchBackground = true;
+        else if (std::strcmp(arg, "--disk-noise-size") == 0) ok = readInt(argc, argv, i, config.diskNoiseSize);
+        else if (std::strcmp(arg, "--disk-octaves") == 0) ok = readInt(argc, argv, i, config.diskOctaves);
+        else if (std::strcmp(arg, "--bench-disk") == 0) config.benchDisk = true;
+        else if (std::strcmp(arg, "--convert-skybox") == 0) ok = readString(argc, argv, i, config.convertSkyboxPath);
+        else if (std::strcmp(arg, "--trace") == 0) ok = readString(argc, argv, i, config.tracePath);
+        else if (std::strcmp(arg, "--metrics-port") == 0) ok = readInt(argc, argv, i, config.metricsPort);
+        else if (std::strcmp(arg, "--adaptive") == 0) ok = readInt(argc, argv, i, config.adaptiveStep);
+        else if (std::strcmp(arg, "--adaptive-threshold") == 0) ok = readFloat(argc, argv, i, config.adaptiveThreshold);
+        else if (std::strcmp(arg, "--interleave") == 0) ok = readInt(argc, argv, i, config.interleave);
+        else if (std::strcmp(arg, "--numa") == 0) config.numa = true;
+        else if (std::strcmp(arg, "--numa-nodes") == 0) {
+            ok = readInt(argc, argv, i, config.numaNodes);
+            config.numa = true;
+        }
+        else if (std::strcmp(arg, "--huge-pages") == 0) config.hugePages = true;
+        else if (std::strcmp(arg, "--bench-numa") == 0) config.benchNuma = true;
+        else if (std::strcmp(arg, "--farm-coordinator") == 0) ok = readInt(argc, argv, i, config.farmCoordinatorPort);
+        else if (std::strcmp(arg, "--farm-bind") == 0) ok = readString(argc, argv, i, config.farmBind);
+        else if (std::strcmp(arg, "--farm-tile") == 0) ok = readInt(argc, argv, i, config.farmTile);
+        else if (std::strcmp(arg, "--farm-local") == 0) ok = readInt(argc, argv, i, config.farmLocal);
+        else if (std::strcmp(arg, "--farm-worker") == 0) ok = readString(argc, argv, i, config.farmWorker);
+        else if (std::strcmp(arg, "--farm-timeout") == 0) ok = readFloat(argc, argv, i, config.farmTimeout);
+        else if (std::strcmp(arg, "--sweep") == 0) ok = readString(argc, argv, i, config.sweepPath);
+        else if (std::strcmp(arg, "--kerr") == 0) {
+            ok = readFloat(argc, argv, i, config.kerrSpin);
+            config.kerr = true;
+        }
+        else if (std::strcmp(arg, "--analytic") == 0) config.analytic = true;
+        else if (std::strcmp(arg, "--charge") == 0) ok = readFloat(argc, argv, i, config.charge);
+        else if (std::strcmp(arg, "--lambda") == 0) ok = readFloat(argc, argv, i, config.lambda);
+        else if (std::strcmp(arg, "--lenses") == 0) ok = readString(argc, argv, i, config.lensesPath);
+        else if (std::strcmp(arg, "--binary") == 0) ok = readFloat(argc, argv, i, config.binarySeparation);
+        else if (std::strcmp(arg, "--lens-tolerance") == 0) ok = readFloat(argc, argv, i, config.lensTolerance);
+        else if (std::strcmp(arg, "--bench-engines") == 0) config.benchEngines = true;
+        else if (std::strcmp(arg, "--integrator") == 0) ok = readString(argc, argv, i, config.integrator);
+        else if (std::strcmp(arg, "--null-renorm") == 0) config.nullRenorm = true;
+        else if (std::strcmp(arg, "--no-ray-classes") == 0) config.rayClasses = false;
+        else if (std::strcmp(arg, "--bench-integrators") == 0) config.benchIntegrators = true;
+        else if (std::strcmp(arg, "--fast-math") == 0) config.fastMath = true;
+        else if (std::strcmp(arg, "--bench-fast-math") == 0) config.benchFastMath = true;
+        else if (std::strcmp(arg, "--disk-opacity") == 0) ok = readFloat(argc, argv, i, config.diskOpacity);
+        else if (std::strcmp(arg, "--disk-orders") == 0) ok = readInt(argc, argv, i, config.diskOrders);
+        else if (std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return false;
+        } else {
+            std::cout << "ERROR: Opción desconocida: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+
+        if (!ok) return false;
+    }
+
+    if (config.framesInFlight < 1 || config.framesInFlight > 4) {
+        std::cout << "ERROR: --frames-in-flight debe estar entre 1 y 4" << std::endl;
+        return false;
+    }
+    if (config.headless && config.replayPath.empty()) {
+        std::cout << "ERROR: --headless necesita un recorrido (--replay FICHERO)" << std::endl;
+        return false;
+    }
+    if (!config.recordPath.empty() && !config.replayPath.empty()) {
+        std::cout << "ERROR: --record y --replay no se pueden usar a la vez" << std::endl;
+        return false;
+    }
+    if (config.fixedDt <= 0.0f) {
+        std::cout << "ERROR: --fixed-dt debe ser positivo" << std::endl;
+        return false;
+    }
+    if (config.width <= 0 || config.height <= 0) {
+        std::cout << "ERROR: --width y --height deben ser positivos" << std::endl;
+        return false;
+    }
+    if (config.envMapSize < 16 || config.envMapSize > 8192) {
+        std::cout << "ERROR: --envmap-size debe estar entre 16 y 8192" << std::endl;
+        return false;
+    }
+    if (config.backgroundFps < 0.0f) {
+        std::cout << "ERROR: --background-fps no puede ser negativo" << std::endl;
+        return false;
+    }
+    if (config.skyboxFaceSize < 0 || config.skyboxFaceSize > 8192) {
+        std::cout << "ERROR: --skybox-face debe estar entre 0 y 8192" << std::endl;
+        return false;
+    }
+    if (config.diskNoiseSize < 64 || config.diskNoiseSize > 8192) {
+        std::cout << "ERROR: --disk-noise-size debe estar entre 64 y 8192" << std::endl;
+        return false;
+    }
+    if (config.diskOctaves < 1 || config.diskOctaves > 8) {
+        std::cout << "ERROR: --disk-octaves debe estar entre 1 y 8" << std::endl;
+        return false;
+    }
+    if (config.metricsPort < 0 || config.metricsPort > 65535) {
+        std::cout << "ERROR: --metrics-port debe estar entre 0 y 65535" << std::endl;
+        return false;
+    }
+    if (config.adaptiveStep < 0 || config.adaptiveStep > 16) {
+        std::cout << "ERROR: --adaptive debe estar entre 0 y 16 (0 o 1 = trazar todos los píxeles)" << std::endl;
+        return false;
+    }
+    if (config.adaptiveThreshold <= 0.0f) {
+        std::cout << "ERROR: --adaptive-threshold debe ser positivo" << std::endl;
+        return false;
+    }
+    if (config.interleave != 0 && config.interleave != 2 && config.interleave != 4) {
+        std::cout << "ERROR: --interleave debe ser 2 (damero) o 4 (cuartos)" << std::endl;
+        return false;
+    }
+    if (config.interleave != 0 && config.adaptiveStep > 1) {
+        std::cout << "ERROR: --interleave y --adaptive no se pueden usar a la vez" << std::endl;
+        return false;
+    }
+    if (config.numaNodes < 0) {
+        std::cout << "ERROR: --numa-nodes no puede ser negativo" << std::endl;
+        return false;
+    }
+    if (config.farmCoordinatorPort < 0 || config.farmCoordinatorPort > 65535) {
+        std::cout << "ERROR: --farm-coordinator debe estar entre 1 y 65535" << std::endl;
+        return false;
+    }
+    if (config.farmCoordinatorPort > 0 && config.replayPath.empty()) {
+        std::cout << "ERROR: --farm-coordinator necesita un recorrido (--replay FICHERO)" << std::endl;
+        return false;
+    }
+    if (config.farmTile < 0 || config.farmLocal < 0) {
+        std::cout << "ERROR: --farm-tile y --farm-local no pueden ser negativos" << std::endl;
+        return false;
+    }
+    if (config.farmTimeout < 3.0 * FARM_HEARTBEAT_S) {
+        std::cout << "ERROR: --farm-timeout debe ser de al menos " << 3.0 * FARM_HEARTBEAT_S
+                  << " s (tres latidos de los trabajadores)" << std::endl;
+        return false;
+    }
+    if (config.farmLocal > 0 && config.farmCoordinatorPort == 0) {
+        std::cout << "ERROR: --farm-local necesita --farm-coordinator" << std::endl;
+        return false;
+    }
+    if (!config.farmWorker.empty()) {
+        size_t colon = config.farmWorker.rfind(':');
+        int port = colon == std::string::npos ? 0 : std::atoi(config.farmWorker.c_str() + colon + 1);
+        if (colon == 0 || port <= 0 || port > 65535) {
+            std::cout << "ERROR: --farm-worker espera HOST:PUERTO" << std::endl;
+            return false;
+        }
+    }
+    if (config.kerrSpin < -0.999f || config.kerrSpin > 0.999f) {
+        std::cout << "ERROR: --kerr debe estar entre -0.999 y 0.999" << std::endl;
+        return false;
+    }
+    IntegratorKind integrator;
+    if (!parseIntegratorKind(config.integrator, integrator)) {
+        std::cout << "ERROR: --integrator espera rk4, verlet, yoshida4 o rkf45" << std::endl;
+        return false;
+    }
+    if (config.kerr && config.analytic) {
+        std::cout << "ERROR: --analytic es solo para Schwarzschild (sin --kerr)" << std::endl;
+        return false;
+    }
+    if (config.charge != 0.0f || config.lambda != 0.0f) {
+        float horizon, escape;
+        if (config.charge != 0.0f && config.lambda != 0.0f) {
+            std::cout << "ERROR: --charge y --lambda no se pueden combinar" << std::endl;
+            return false;
+        }
+        if (config.kerr || config.analytic) {
+            std::cout << "ERROR: --charge y --lambda son del motor pseudo-newtoniano (sin --kerr ni --analytic)"
+                      << std::endl;
+            return false;
+        }
+        if (!spacetimeHorizons(spacetimeFor(config.charge, config.lambda), RS, config.charge, config.lambda, horizon,
+                               escape)) {
+            std::cout << "ERROR: sin horizonte: hace falta |--charge| < " << 0.5f * RS << " y 0 <= --lambda < "
+                      << 4.0f / (9.0f * RS * RS) << std::endl;
+            return false;
+        }
+    }
+    if (!config.lensesPath.empty() || config.binarySeparation != 0.0f) {
+        if (!config.lensesPath.empty() && config.binarySeparation != 0.0f) {
+            std::cout << "ERROR: --lenses y --binary no se pueden combinar" << std::endl;
+            return false;
+        }
+        if (config.kerr || config.analytic || config.charge != 0.0f || config.lambda != 0.0f) {
+            std::cout << "ERROR: --lenses y --binary son del motor pseudo-newtoniano de Schwarzschild (sin --kerr, "
+                         "--analytic, --charge ni --lambda)" << std::endl;
+            return false;
+        }
+        if (config.farmCoordinatorPort > 0) {
+            std::cout << "ERROR: las escenas con varias lentes no se reparten en la granja" << std::endl;
+            return false;
+        }
+        if (config.binarySeparation != 0.0f && config.binarySeparation <= RS * LENS_CAPTURE_MARGIN) {
+            std::cout << "ERROR: --binary debe ser mayor que " << RS * LENS_CAPTURE_MARGIN
+                      << " (los dos horizontes no se pueden tocar)" << std::endl;
+            return false;
+        }
+    }
+    if (config.lensTolerance < 0.0f) {
+        std::cout << "ERROR: --lens-tolerance no puede ser negativo" << std::endl;
+        return false;
+    }
+    if (config.diskOpacity <= 0.0f || config.diskOpacity > 1.0f) {
+        std::cout << "ERROR: --disk-opacity debe estar en (0, 1] (1 = disco opaco)" << std::endl;
+        return false;
+    }
+    if (config.diskOrders < 1 || config.diskOrders > DISK_MAX_ORDER) {
+        std::cout << "ERROR: --disk-orders debe estar entre 1 y " << DISK_MAX_ORDER << std::endl;
+        return false;
+    }
+    if (config.diskOpacity < 1.0f) {
+        if (config.kerr || config.analytic) {
+            std::cout << "ERROR: --disk-opacity es del motor pseudo-newtoniano (sin --kerr ni --analytic)" << std::endl;
+            return false;
+        }
+        // Guardan o interpolan un único cruce por píxel
+        if (config.adaptiveStep > 1 || config.interleave != 0 || config.envMapMode) {
+            std::cout << "ERROR: --disk-opacity no admite --adaptive, --interleave ni --envmap" << std::endl;
+            return false;
+        }
+    }
+    if (config.swapInterval < 0) {
+        std::cout << "ERROR: --swap-interval no puede ser negativo" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+
+// --- CONFIGURACIÓN DE LÍNEA DE COMANDOS ---
+// Todo tiene un valor por defecto razonable: lanzar el ejecutable sin
+// argumentos sigue funcionando igual que siempre.
+struct AppConfig {
+    int swapInterval = 1;        // --swap-interval N  (0 = sin VSync)
+    int framesInFlight = 2;      // --frames-in-flight N  (frames que la CPU puede adelantarse a la GPU)
+    std::string latencyLogPath;  // --latency-log FICHERO  (CSV con la latencia entrada->swap por frame)
+    float backgroundFps = 10.0f; // --background-fps N  (límite de fps sin foco, 0 = sin límite)
+    bool animateDisk = true;     // --no-animation  (empieza con el disco congelado; tecla P para alternar)
+    bool envMapMode = false;     // --envmap  (modo 360°: cubemap de resultados + búsqueda; tecla M)
+    int envMapSize = 1024;       // --envmap-size N  (resolución de cada cara del cubemap)
+
+    // Recorridos de cámara reproducibles
+    std::string recordPath;      // --record FICHERO  (graba la cámara de cada frame trazado)
+    std::string replayPath;      // --replay FICHERO  (reproduce con dt fijo en vez de leer el teclado)
+    float fixedDt = 1.0f / 60.0f;// --fixed-dt S  (dt que se guarda en las grabaciones nuevas)
+    std::string reportPath;      // --report FICHERO  (CSV de tiempos por frame de la reproducción)
+
+    // Modo sin ventana: trazador de CPU, reproduciendo un recorrido
+    bool headless = false;       // --headless  (requiere --replay)
+    int width = 800;             // --width N  (resolución del modo sin ventana)
+    int height = 600;            // --height N
+    int threads = 0;             // --threads N  (0 = todos los núcleos)
+    std::string outputDir;       // --output-dir DIR  (guarda cada frame como PPM)
+
+    // Rutas de los recursos (por defecto, relativas a build/ como siempre)
+    std::string skyboxPath = "../textures/background.jpg"; // --skybox IMAGEN  (cielo, panorama equirectangular)
+    std::string shaderDir = "../shaders/"; // --shader-dir DIR  (carpeta de los .glsl del trazador de GPU)
+
+    bool equirectSkybox = false; // --skybox-equirect  (cielo sin cubemap: atan/asin por píxel)
+    int skyboxFaceSize = 0;      // --skybox-face N  (resolución de cada cara del cubemap del cielo, 0 = auto)
+    bool benchBackground = false;// --bench-background  (compara las dos búsquedas del cielo en CPU y sale)
+    int diskNoiseSize = 1024;    // --disk-noise-size N  (resolución del ruido del disco horneado, N x N)
+    int diskOctaves = 5;         // --disk-octaves N  (octavas del fbm horneado, 1-8)
+    bool benchDisk = false;      // --bench-disk  (compara fbm por impacto con la textura horneada y sale)
+    std::string convertSkyboxPath; // --convert-skybox IMAGEN  (genera IMAGEN.bhsky y sale)
+    std::string tracePath;       // --trace FICHERO  (línea de tiempo en JSON para Perfetto)
+    int metricsPort = 0;         // --metrics-port N  (Prometheus en 127.0.0.1:N, 0 = desactivado)
+    int adaptiveStep = 0;        // --adaptive N  (rejilla de N x N píxeles + refinado en bordes, 0 = todo)
+    float adaptiveThreshold = 0.08f; // --adaptive-threshold T  (diferencia de color que obliga a refinar)
+    int interleave = 0;          // --interleave N  (2 = damero, 4 = cuartos: fracción de píxeles trazada por frame)
+    bool numa = false;           // --numa  (trazador CPU: hilos fijados por nodo NUMA, cielo replicado)
+    int numaNodes = 0;           // --numa-nodes N  (usar solo los N primeros nodos, 0 = todos; implica --numa)
+    bool hugePages = false;      // --huge-pages  (copias del cielo con páginas enormes transparentes)
+    bool benchNuma = false;      // --bench-numa  (escalado del trazador CPU de 1 nodo a todos y sale)
+
+    // Granja de render (ver farm.h)
+    int farmCoordinatorPort = 0; // --farm-coordinator PORT  (reparte --replay entre trabajadores TCP)
+    std::string farmBind = "127.0.0.1"; // --farm-bind DIR  (dirección en la que escucha el coordinador)
+    int farmTile = 0;            // --farm-tile N  (trabajos de N x N píxeles, 0 = un frame por trabajo)
+    int farmLocal = 0;           // --farm-local N  (lanza N trabajadores en este nodo)
+    std::string farmWorker;      // --farm-worker HOST:PORT  (traza trabajos del coordinador)
+    float farmTimeout = 30.0f;   // --farm-timeout S  (silencio tras el que un trabajador se da por colgado)
+
+    bool kerr = false;           // --kerr A  (agujero en rotación: geodésicas de Kerr con spin a/M = A)
+    float kerrSpin = 0.0f;
+    bool analytic = false;       // --analytic  (Schwarzschild exacto en forma cerrada: sin MAX_STEPS)
+    float charge = 0.0f;         // --charge Q  (Reissner-Nordström, motor pseudo-newtoniano; |Q| < RS / 2)
+    float lambda = 0.0f;         // --lambda L  (Schwarzschild-de Sitter: constante cosmológica, 0 <= L < 4 / (9 RS²))
+    std::string lensesPath;      // --lenses FICHERO  (varias lentes, una por línea "x y z rs"; ver lenses.h)
+    float binarySeparation = 0.0f; // --binary D  (dos agujeros de RS / 2 separados D en el eje x)
+    float lensTolerance = 1e-4f; // --lens-tolerance T  (aceleración por debajo de la cual se poda una lente, 0 = nunca)
+    bool benchEngines = false;   // --bench-engines  (coste por rayo de cada motor de geodésicas y sale)
+    std::string integrator = "rk4"; // --integrator rk4|verlet|yoshida4|rkf45  (motor pseudo-newtoniano de CPU)
+    bool nullRenorm = false;     // --null-renorm  (reescala la velocidad cada paso para conservar la energía del rayo)
+    bool rayClasses = true;      // --no-ray-classes  (sin clasificar: todos los rayos hasta el horizonte o MAX_STEPS)
+    bool benchIntegrators = false; // --bench-integrators  (precisión frente a evaluaciones por rayo y sale)
+    bool fastMath = false;       // --fast-math  (aproximaciones de fast_math.h en CPU y GPU en lugar de libm/GLSL)
+    bool benchFastMath = false;  // --bench-fast-math  (error y velocidad de las aproximaciones y sale)
+    float diskOpacity = 1.0f;    // --disk-opacity A  (opacidad de un cruce en el borde interno; < 1: imágenes de orden superior)
+    int diskOrders = 4;          // --disk-orders N  (cruces del disco semitransparente como máximo, 1-4)
+
+    std::string sweepPath;       // --sweep FICHERO  (tabla CSV de parámetros: una imagen por fila, ver sweep.h)
+};
+
+// Devuelve false si algún argumento no es válido (ya se ha informado por consola)
+bool parseArgs(int argc, char** argv, AppConfig& config);
@@ -0,0 +1,550 @@
+#include "cpu_tracer.h"
+#include "ray_loop.h"
+#include "kerr.h"
+#include "analytic.h"
+#include "fast_math.h"
+// DEFINIR ESTO SOLO EN UN ARCHIVO .CPP ANTES DE INCLUIR LA LIBRERÍA (la usa también main.cpp)
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "metrics.h"
+#include "trace.h"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cfloat>
+
+static const float PI = 3.14159265f;
+
+// =========================================================
+//            FÍSICA Y RAYTRACING
+// =========================================================
+
+bool loadCpuSkybox(const char* path, CpuSkybox& skybox) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 3);
+    if (!data) {
+        std::cout << "ERROR: No se pudo cargar la textura: " << path << std::endl;
+        return false;
+    }
+    skybox.width = width;
+    skybox.height = height;
+    skybox.pixels.assign(data, data + (size_t)width * height * 3);
+    stbi_image_free(data);
+    std::cout << "Textura cargada en CPU: " << path << " (" << width << "x" << height << ")" << std::endl;
+    return true;
+}
+
+// Lectura bilineal con REPEAT en horizontal y CLAMP en vertical (como loadTexture)
+static vec3 sampleSkybox(const CpuSkybox& skybox, float u, float v) {
+    if (skybox.width == 0) return {0.0f, 0.0f, 0.0f};
+
+    float x = u * skybox.width - 0.5f;
+    float y = std::clamp(v * skybox.height - 0.5f, 0.0f, float(skybox.height - 1));
+    int x0 = (int)std::floor(x);
+    int y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+    int y1 = std::min(y0 + 1, skybox.height - 1);
+
+    auto texel = [&](int tx, int ty) {
+        tx = ((tx % skybox.width) + skybox.width) % skybox.width;
+        const unsigned char* p = &skybox.pixels[((size_t)ty * skybox.width + tx) * 3];
+        return vec3{p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f};
+    };
+
+    vec3 top = texel(x0, y0) * (1.0f - fx) + texel(x0 + 1, y0) * fx;
+    vec3 bottom = texel(x0, y1) * (1.0f - fx) + texel(x0 + 1, y1) * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
+
+vec3 getBackground(const vec3& dir, const CpuSkybox& skybox, bool fastMath) {
+    // Cubemap: búsqueda directa por dirección, sin funciones trascendentes
+    if (skybox.useCube) return sampleCubeSkybox(skybox.cube, dir);
+
+    vec3 d = normalize(dir);
+    // Mapeo de Esfera a Rectángulo (Coordenadas UV)
+    float y = std::clamp(d.y, -1.0f, 1.0f);
+    float u = 0.5f + (fastMath ? fastAtan2(d.z, d.x) : std::atan2(d.z, d.x)) / (2.0f * PI);
+    float v = 0.5f + (fastMath ? fastAsin(y) : std::asin(y)) / PI;
+    return sampleSkybox(skybox, u, v);
+}
+
+template <class Integrator>
+static inline RayOutcome traceIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                         const BlackHoleParams& params) {
+    switch (params.spacetime) {
+        case SpacetimeKind::ReissnerNordstrom:
+            return traceIntegrated<Integrator, SpacetimeReissnerNordstrom>(ro, rd, steps, evals, params);
+        case SpacetimeKind::SchwarzschildDeSitter:
+            return traceIntegrated<Integrator, SpacetimeSchwarzschildDeSitter>(ro, rd, steps, evals, params);
+        case SpacetimeKind::Schwarzschild:
+        default: return traceIntegrated<Integrator, SpacetimeSchwarzschild>(ro, rd, steps, evals, params);
+    }
+}
+
+RayOutcome traceOutcomeIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                  const BlackHoleParams& params) {
+    if (params.spacetime == SpacetimeKind::MultiLens && params.lenses) {
+        return traceOutcomeMultiLens(ro, rd, steps, evals, params);
+    }
+    switch (params.integrator) {
+        case IntegratorKind::Verlet: return traceIntegrated<IntegratorVerlet>(ro, rd, steps, evals, params);
+        case IntegratorKind::Yoshida4: return traceIntegrated<IntegratorYoshida4>(ro, rd, steps, evals, params);
+        case IntegratorKind::RKF45: return traceIntegrated<IntegratorRKF45>(ro, rd, steps, evals, params);
+        case IntegratorKind::RK4:
+        default: return traceIntegrated<IntegratorRK4>(ro, rd, steps, evals, params);
+    }
+}
+
+RayOutcome traceOutcome(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params) {
+    // Una comprobación por rayo, fuera del bucle de integración
+    if (params.kerr) return traceOutcomeKerr(ro, rd, steps, params);
+    if (params.analytic) return traceOutcomeAnalytic(ro, rd, steps, params);
+    int evals;
+    return traceOutcomeIntegrated(ro, rd, steps, evals, params);
+}
+
+static vec3 shadeDisk(float hitDist, float angle, float doppler, float time, const DiskNoise& diskNoise,
+                      const BlackHoleParams& params) {
+    // Rotación diferencial
+    float speed = params.fastMath ? 12.0f * fastRsqrt(hitDist) : 12.0f / std::sqrt(hitDist);
+    float rotAngle = angle + speed * time;
+
+    float noise = sampleDiskNoise(diskNoise, rotAngle * 3.0f, hitDist * 1.5f - time);
+
+    // Temperatura y Doppler (igual que el shader)
+    float temp = (params.diskOuter - hitDist) / (params.diskOuter - params.diskInner);
+    float intensity = temp * noise * 2.0f;
+    float base = 1.0f - doppler * 0.5f;
+    float beaming = params.fastMath ? base * base * base : std::pow(base, 3.0f); // Exponente entero: basta el producto
+    intensity *= beaming;
+
+    vec3 fireColor = vec3{1.0f, 0.6f, 0.2f} * (intensity * 3.0f);
+    float t = std::clamp(intensity - 1.0f, 0.0f, 1.0f);
+    fireColor = fireColor + vec3{0.5f, 0.5f, 1.0f} * (t * t * (3.0f - 2.0f * t));
+    return fireColor;
+}
+
+// Profundidad óptica de un cruce τ(r) = τ0 (1 + temp) / 2: el borde interno (más caliente y denso)
+// tapa más que el externo. τ0 es la del borde interno: α = 1 - e^-τ = 1 - (1 - opacidad)^((1 + temp) / 2)
+float diskCrossingOpacity(float hitDist, const BlackHoleParams& params) {
+    if (params.diskOpacity >= 1.0f) return 1.0f;
+    float temp = (params.diskOuter - hitDist) / (params.diskOuter - params.diskInner);
+    return 1.0f - std::pow(1.0f - params.diskOpacity, 0.5f * (1.0f + temp));
+}
+
+bool crossDisk(RayOutcome& outcome, float& transmittance, const DiskCrossing& crossing,
+               const BlackHoleParams& params) {
+    if (outcome.crossings == 0) {
+        outcome.kind = OutcomeKind::Disk;
+        outcome.hitDist = crossing.hitDist;
+        outcome.angle = crossing.angle;
+        outcome.doppler = crossing.doppler;
+    } else {
+        outcome.higher[outcome.crossings - 1] = crossing;
+    }
+    outcome.crossings++;
+    transmittance *= 1.0f - diskCrossingOpacity(crossing.hitDist, params);
+    if (transmittance > 1.0f - DISK_OPACITY_CUTOFF && outcome.crossings < params.diskOrders) return false;
+    endDiskLayers(outcome, OutcomeKind::Captured);
+    return true;
+}
+
+void endDiskLayers(RayOutcome& outcome, OutcomeKind kind) {
+    outcome.behind = kind;
+    countMetric(MetricCounter::CpuDiskCrossings, (uint64_t)outcome.crossings);
+}
+
+// Disco semitransparente: cruces de delante hacia atrás, cada uno tapa una parte de lo que queda detrás
+static vec3 shadeDiskLayers(const RayOutcome& outcome, float time, const CpuSkybox& skybox,
+                            const DiskNoise& diskNoise, const BlackHoleParams& params) {
+    vec3 color = {0.0f, 0.0f, 0.0f};
+    float transmittance = 1.0f;
+    for (int i = 0; i < outcome.crossings; i++) {
+        DiskCrossing c = i == 0 ? DiskCrossing{outcome.hitDist, outcome.angle, outcome.doppler} : outcome.higher[i - 1];
+        float alpha = diskCrossingOpacity(c.hitDist, params);
+        color = color + shadeDisk(c.hitDist, c.angle, c.doppler, time, diskNoise, params) * (transmittance * alpha);
+        transmittance *= 1.0f - alpha;
+    }
+    if (outcome.behind == OutcomeKind::Escaped) {
+        color = color + getBackground(outcome.dir, skybox, params.fastMath) * transmittance;
+    }
+    return color;
+}
+
+vec3 shadeOutcome(const RayOutcome& outcome, float time, const CpuSkybox& skybox, const DiskNoise& diskNoise,
+                  const BlackHoleParams& params) {
+    switch (outcome.kind) {
+        case OutcomeKind::Disk:
+            // Kerr y --analytic paran en el primer cruce (crossings = 0): siempre opaco
+            if (params.diskOpacity < 1.0f && outcome.crossings > 0) {
+                return shadeDiskLayers(outcome, time, skybox, diskNoise, params);
+            }
+            return shadeDisk(outcome.hitDist, outcome.angle, outcome.doppler, time, diskNoise, params);
+        case OutcomeKind::Escaped: return getBackground(outcome.dir, skybox, params.fastMath);
+        default: return {0.0f, 0.0f, 0.0f};
+    }
+}
+
+vec3 pixelRay(const CameraBasis& basis, int px, int py, int width, int height) {
+    // Coordenadas UV normalizadas [-1, 1]
+    float u = float(px) / float(width) * 2.0f - 1.0f;
+    float v = float(py) / float(height) * 2.0f - 1.0f;
+    u *= float(width) / float(height);
+    return normalize(basis.right * u + basis.up * v + basis.forward * basis.focal);
+}
+
+// Copia un buffer a memoria nueva sin tocar antes de la copia: la escritura la
+// hace el hilo que llama (fijado a su nodo) y puede pedir páginas enormes.
+template <typename Buffer>
+static void copyBufferLocal(const Buffer& src, Buffer& dst, bool hugePages) {
+    Buffer().swap(dst);
+    dst.reserve(src.size());
+    if (hugePages) adviseHugePages(dst.data(), src.size() * sizeof(src[0]));
+    dst.assign(src.begin(), src.end());
+}
+
+// Una copia del cielo por nodo, hecha por el primer hilo de cada nodo
+static void replicateSkybox(CpuTracer& tracer) {
+    TRACE_SCOPE("replicateSkybox");
+    const CpuSkybox& source = tracer.skybox;
+    tracer.nodeSkyboxes.resize(tracer.pool.nodeCount);
+    runOnPool(tracer.pool, [&](int worker) {
+        int node = tracer.pool.workerNode[worker];
+        if (worker > 0 && tracer.pool.workerNode[worker - 1] == node) return;
+
+        CpuSkybox& copy = tracer.nodeSkyboxes[node];
+        copy.width = source.width;
+        copy.height = source.height;
+        copy.useCube = source.useCube;
+        copy.cube.faceSize = source.cube.faceSize;
+        copyBufferLocal(source.pixels, copy.pixels, tracer.hugePages);
+        for (int face = 0; face < 6; face++) copyBufferLocal(source.cube.faces[face], copy.cube.faces[face], tracer.hugePages);
+    });
+    // El original (tocado por el hilo principal) ya no se lee
+    std::vector<unsigned char>().swap(tracer.skybox.pixels);
+    for (auto& face : tracer.skybox.cube.faces) std::vector<unsigned char>().swap(face);
+}
+
+const CpuSkybox& workerSkybox(const CpuTracer& tracer, int worker) {
+    if (tracer.nodeSkyboxes.empty()) return tracer.skybox;
+    return tracer.nodeSkyboxes[tracer.pool.workerNode[worker]];
+}
+
+bool startCpuTracer(CpuTracer& tracer, int threads, const char* skyboxPath, int cubeFaceSize,
+                    int diskNoiseSize, int diskOctaves) {
+    if (!loadCpuSkybox(skyboxPath, tracer.skybox)) return false;
+    if (tracer.numaNodes > 0) {
+        NumaTopology topology = detectNumaTopology();
+        printNumaTopology(topology);
+        startThreadPoolNuma(tracer.pool, threads, topology, tracer.numaNodes);
+        std::cout << "Trazador CPU: " << threadPoolSize(tracer.pool) << " hilos fijados en "
+                  << tracer.pool.nodeCount << " nodo(s)" << std::endl;
+    } else {
+        startThreadPool(tracer.pool, threads);
+        std::cout << "Trazador CPU: " << threadPoolSize(tracer.pool) << " hilos" << std::endl;
+    }
+
+    if (cubeFaceSize >= 0) {
+        CpuSkybox& skybox = tracer.skybox;
+        if (cubeFaceSize == 0) cubeFaceSize = defaultCubeFaceSize(skybox.width);
+        equirectToCube(skybox.pixels.data(), skybox.width, skybox.height, 3, cubeFaceSize, tracer.pool, skybox.cube);
+        skybox.useCube = true;
+        // El panorama ya no hace falta: con cielos de 16k son cientos de MB
+        std::vector<unsigned char>().swap(skybox.pixels);
+    }
+    if (tracer.numaNodes > 0 || tracer.hugePages) replicateSkybox(tracer);
+    bakeDiskNoise(tracer.diskNoise, diskNoiseSize, diskNoiseSize, diskOctaves, tracer.pool);
+    return true;
+}
+
+void stopCpuTracer(CpuTracer& tracer) {
+    stopThreadPool(tracer.pool);
+}
+
+// =========================================================
+//            MUESTREO ADAPTATIVO
+// =========================================================
+// Deben coincidir con adaptive_refine.glsl
+static const float MAX_DISK_RADIUS_SPAN = 0.15f;
+static const float MAX_DISK_ANGLE_SPAN = 0.5f;
+static const float MAX_DEFLECTION_RATIO = 4.0f;
+
+// ¿Cambia la clase en los 4x4 puntos de la rejilla alrededor de la celda (cx, cy)?
+// Las celdas vecinas cuentan para no perder detalles finos entre las 4 esquinas.
+static bool classChanges(const std::vector<RayOutcome>& coarse, int coarseWidth, int coarseHeight, int cx, int cy) {
+    OutcomeKind kind = coarse[(size_t)cy * coarseWidth + cx].kind;
+    for (int y = std::max(cy - 1, 0); y <= std::min(cy + 2, coarseHeight - 1); y++) {
+        for (int x = std::max(cx - 1, 0); x <= std::min(cx + 2, coarseWidth - 1); x++) {
+            if (coarse[(size_t)y * coarseWidth + x].kind != kind) return true;
+        }
+    }
+    return false;
+}
+
+// Esquinas de la celda en el orden 00, 10, 01, 11; camDirs son los rayos de cámara de esas esquinas.
+// El cambio de clase (borde de la sombra o del disco) ya se ha comprobado con classChanges.
+static bool needsRefine(const RayOutcome* corners[4], const vec3 camDirs[4], float time, const CpuTracer& tracer,
+                        const CpuSkybox& skybox) {
+    OutcomeKind kind = corners[0]->kind;
+    if (kind == OutcomeKind::Captured) return false;
+
+    if (kind == OutcomeKind::Disk) {
+        float minR = corners[0]->hitDist, maxR = minR, minA = corners[0]->angle, maxA = minA;
+        for (int i = 1; i < 4; i++) {
+            minR = std::min(minR, corners[i]->hitDist); maxR = std::max(maxR, corners[i]->hitDist);
+            minA = std::min(minA, corners[i]->angle);   maxA = std::max(maxA, corners[i]->angle);
+        }
+        if (maxR - minR > MAX_DISK_RADIUS_SPAN || maxA - minA > MAX_DISK_ANGLE_SPAN) return true;
+    } else {
+        // Gradiente de deflexión (cerca del anillo de fotones)
+        float outSpread = std::max(1.0f - dot(corners[0]->dir, corners[3]->dir), 1.0f - dot(corners[1]->dir, corners[2]->dir));
+        float camSpread = std::max(1.0f - dot(camDirs[0], camDirs[3]), 1.0f - dot(camDirs[1], camDirs[2]));
+        if (outSpread > MAX_DEFLECTION_RATIO * MAX_DEFLECTION_RATIO * camSpread) return true;
+    }
+
+    // Diferencia de color entre esquinas
+    vec3 lo = shadeOutcome(*corners[0], time, skybox, tracer.diskNoise, tracer.params), hi = lo;
+    for (int i = 1; i < 4; i++) {
+        vec3 c = shadeOutcome(*corners[i], time, skybox, tracer.diskNoise, tracer.params);
+        lo = {std::min(lo.x, c.x), std::min(lo.y, c.y), std::min(lo.z, c.z)};
+        hi = {std::max(hi.x, c.x), std::max(hi.y, c.y), std::max(hi.z, c.z)};
+    }
+    return std::max(hi.x - lo.x, std::max(hi.y - lo.y, hi.z - lo.z)) > tracer.adaptiveThreshold;
+}
+
+static RayOutcome interpolateOutcome(const RayOutcome* corners[4], float fx, float fy) {
+    float w[4] = {(1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy, fx * fy};
+    RayOutcome outcome;
+    outcome.kind = corners[0]->kind;
+    for (int i = 0; i < 4; i++) {
+        outcome.dir = outcome.dir + corners[i]->dir * w[i];
+        outcome.hitDist += corners[i]->hitDist * w[i];
+        outcome.angle += corners[i]->angle * w[i];
+        outcome.doppler += corners[i]->doppler * w[i];
+    }
+    if (outcome.kind == OutcomeKind::Escaped) outcome.dir = normalize(outcome.dir);
+    return outcome;
+}
+
+// Rejilla dispersa + refinado por celdas. Una fila de celdas por tarea.
+static void renderFrameAdaptive(CpuTracer& tracer, const CameraBasis& basis, const vec3& ro, float time,
+                                int width, int height, float* rgb, std::vector<long long>& workerSteps,
+                                std::vector<long long>& workerRays) {
+    const int step = tracer.adaptiveStep;
+    const int coarseWidth = (width - 1) / step + 2;
+    const int coarseHeight = (height - 1) / step + 2;
+    std::vector<RayOutcome> coarse((size_t)coarseWidth * coarseHeight);
+
+    // 1. Rejilla (el último punto puede caer fuera de la imagen: el rayo sigue siendo válido)
+    NodeWorkQueue rows;
+    initNodeWorkQueue(rows, coarseHeight, tracer.pool.nodeCount);
+    runOnPool(tracer.pool, [&](int worker) {
+        TRACE_SCOPE("adaptiveCoarse");
+        int node = tracer.pool.workerNode[worker];
+        for (int cy = takeNodeWork(rows, node); cy >= 0; cy = takeNodeWork(rows, node)) {
+            for (int cx = 0; cx < coarseWidth; cx++) {
+                int steps = 0;
+                coarse[(size_t)cy * coarseWidth + cx] =
+                    traceOutcome(ro, pixelRay(basis, cx * step, cy * step, width, height), steps,
+                                 tracer.params);
+                workerSteps[worker] += steps;
+            }
+            workerRays[worker] += coarseWidth;
+        }
+    });
+
+    // 2. Refinado
+    initNodeWorkQueue(rows, coarseHeight - 1, tracer.pool.nodeCount);
+    runOnPool(tracer.pool, [&](int worker) {
+        TRACE_SCOPE("adaptiveRefine");
+        int node = tracer.pool.workerNode[worker];
+        const CpuSkybox& skybox = workerSkybox(tracer, worker);
+        for (int cy = takeNodeWork(rows, node); cy >= 0; cy = takeNodeWork(rows, node)) {
+            for (int cx = 0; cx < coarseWidth - 1; cx++) {
+                const RayOutcome* corners[4] = {
+                    &coarse[(size_t)cy * coarseWidth + cx], &coarse[(size_t)cy * coarseWidth + cx + 1],
+                    &coarse[(size_t)(cy + 1) * coarseWidth + cx], &coarse[(size_t)(cy + 1) * coarseWidth + cx + 1]};
+                vec3 camDirs[4];
+                for (int i = 0; i < 4; i++) {
+                    camDirs[i] = pixelRay(basis, (cx + i % 2) * step, (cy + i / 2) * step, width, height);
+                }
+                bool refine = classChanges(coarse, coarseWidth, coarseHeight, cx, cy) ||
+                              needsRefine(corners, camDirs, time, tracer, skybox);
+
+                int x0 = cx * step, y0 = cy * step;
+                int x1 = std::min(x0 + step, width), y1 = std::min(y0 + step, height);
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        RayOutcome outcome;
+                        if (x == x0 && y == y0) {
+                            outcome = *corners[0]; // Punto de la rejilla: ya trazado
+                        } else if (refine) {
+                            int steps = 0;
+                            outcome = traceOutcome(ro, pixelRay(basis, x, y, width, height), steps,
+                                                   tracer.params);
+                            workerSteps[worker] += steps;
+                            workerRays[worker]++;
+                        } else {
+                            outcome = interpolateOutcome(corners, float(x - x0) / step, float(y - y0) / step);
+                        }
+                        vec3 col = shadeOutcome(outcome, time, skybox, tracer.diskNoise, tracer.params);
+                        float* out = &rgb[((size_t)y * width + x) * 3];
+                        out[0] = col.x; out[1] = col.y; out[2] = col.z;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Núcleo de renderRegionCPU: escribe en memoria del que llama (width x height x 3 floats)
+void renderRegionIntoCPU(CpuTracer& tracer, const CameraState& camera, float time, int fullWidth, int fullHeight,
+                         int originX, int originY, int width, int height, float* rgb, CpuFrameStats& stats) {
+    TRACE_SCOPE("renderFrameCPU");
+    auto start = std::chrono::steady_clock::now();
+
+    int tilesX = (width + CPU_TILE_SIZE - 1) / CPU_TILE_SIZE;
+    int tilesY = (height + CPU_TILE_SIZE - 1) / CPU_TILE_SIZE;
+    int tileCount = tilesX * tilesY;
+
+    CameraBasis basis = computeCameraBasis(camera);
+    vec3 ro = {camera.x, camera.y, camera.z};
+
+    std::vector<long long> workerSteps(threadPoolSize(tracer.pool), 0);
+    std::vector<long long> workerRays(threadPoolSize(tracer.pool), 0);
+
+    // El muestreo adaptativo necesita la rejilla de la imagen entera
+    bool wholeFrame = originX == 0 && originY == 0 && width == fullWidth && height == fullHeight;
+    if (tracer.adaptiveStep > 1 && wholeFrame) {
+        renderFrameAdaptive(tracer, basis, ro, time, width, height, rgb, workerSteps, workerRays);
+    } else {
+        // Reparto dinámico: cada hilo coge la siguiente tesela libre de la franja de su
+        // nodo (la misma que tocó primero el framebuffer) y después ayuda a los demás
+        NodeWorkQueue tiles;
+        initNodeWorkQueue(tiles, tileCount, tracer.pool.nodeCount);
+        std::atomic<int> tilesTaken(0);
+
+        runOnPool(tracer.pool, [&](int worker) {
+            long long localSteps = 0;
+            int node = tracer.pool.workerNode[worker];
+            const CpuSkybox& skybox = workerSkybox(tracer, worker);
+            for (int tile = takeNodeWork(tiles, node); tile >= 0; tile = takeNodeWork(tiles, node)) {
+                setMetricGauge(MetricGauge::CpuTilesPending, tileCount - ++tilesTaken);
+                TRACE_SCOPE("tile");
+                int x0 = (tile % tilesX) * CPU_TILE_SIZE;
+                int y0 = (tile / tilesX) * CPU_TILE_SIZE;
+                int x1 = std::min(x0 + CPU_TILE_SIZE, width);
+                int y1 = std::min(y0 + CPU_TILE_SIZE, height);
+
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        int steps = 0;
+                        vec3 rd = pixelRay(basis, originX + x, originY + y, fullWidth, fullHeight);
+                        RayOutcome outcome = traceOutcome(ro, rd, steps, tracer.params);
+                        vec3 col = shadeOutcome(outcome, time, skybox, tracer.diskNoise, tracer.params);
+                        localSteps += steps;
+
+                        float* out = &rgb[((size_t)y * width + x) * 3];
+                        out[0] = col.x; out[1] = col.y; out[2] = col.z;
+                    }
+                }
+                workerRays[worker] += (long long)(x1 - x0) * (y1 - y0);
+            }
+            workerSteps[worker] = localSteps;
+        });
+    }
+
+    stats.pixels = (long long)width * height;
+    stats.rays = 0;
+    stats.steps = 0;
+    for (long long r : workerRays) stats.rays += r;
+    for (long long s : workerSteps) stats.steps += s;
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    countMetric(MetricCounter::CpuRays, (uint64_t)stats.rays);
+    countMetric(MetricCounter::CpuRaySteps, (uint64_t)stats.steps);
+    observeMetric(MetricHistogram::CpuTrace, stats.ms / 1000.0);
+}
+
+void renderRegionCPU(CpuTracer& tracer, const CameraState& camera, float time, int fullWidth, int fullHeight,
+                     int originX, int originY, CpuFrame& frame, CpuFrameStats& stats) {
+    int tilesX = (frame.width + CPU_TILE_SIZE - 1) / CPU_TILE_SIZE;
+    int tilesY = (frame.height + CPU_TILE_SIZE - 1) / CPU_TILE_SIZE;
+    int tileCount = tilesX * tilesY;
+
+    size_t frameFloats = (size_t)frame.width * frame.height * 3;
+    if (frame.rgb.size() != frameFloats) {
+        // Memoria nueva sin tocar: cada nodo pone a cero su franja de teselas (first touch)
+        decltype(frame.rgb)().swap(frame.rgb);
+        frame.rgb.resize(frameFloats);
+        NodeWorkQueue touch;
+        initNodeWorkQueue(touch, tileCount, tracer.pool.nodeCount);
+        runOnPool(tracer.pool, [&](int worker) {
+            int node = tracer.pool.workerNode[worker];
+            for (int tile = touch.next[node]++; tile < touch.end[node]; tile = touch.next[node]++) {
+                int x0 = (tile % tilesX) * CPU_TILE_SIZE, y0 = (tile / tilesX) * CPU_TILE_SIZE;
+                int x1 = std::min(x0 + CPU_TILE_SIZE, frame.width), y1 = std::min(y0 + CPU_TILE_SIZE, frame.height);
+                for (int y = y0; y < y1; y++) {
+                    std::fill_n(&frame.rgb[((size_t)y * frame.width + x0) * 3], (x1 - x0) * 3, 0.0f);
+                }
+            }
+        });
+    }
+    renderRegionIntoCPU(tracer, camera, time, fullWidth, fullHeight, originX, originY, frame.width, frame.height,
+                        frame.rgb.data(), stats);
+}
+
+void renderFrameCPU(CpuTracer& tracer, const CameraState& camera, float time, CpuFrame& frame,
+                    CpuFrameStats& stats) {
+    renderRegionCPU(tracer, camera, time, frame.width, frame.height, 0, 0, frame, stats);
+}
+
+void traceOutcomesCPU(CpuTracer& tracer, const CameraState& camera, int width, int height,
+                      std::vector<RayOutcome>& outcomes, CpuFrameStats& stats) {
+    TRACE_SCOPE("traceOutcomesCPU");
+    auto start = std::chrono::steady_clock::now();
+    outcomes.resize((size_t)width * height);
+    CameraBasis basis = computeCameraBasis(camera);
+    vec3 ro = {camera.x, camera.y, camera.z};
+
+    std::vector<long long> workerSteps(threadPoolSize(tracer.pool), 0);
+    NodeWorkQueue rows;
+    initNodeWorkQueue(rows, height, tracer.pool.nodeCount);
+    runOnPool(tracer.pool, [&](int worker) {
+        int node = tracer.pool.workerNode[worker];
+        for (int y = takeNodeWork(rows, node); y >= 0; y = takeNodeWork(rows, node)) {
+            for (int x = 0; x < width; x++) {
+                int steps = 0;
+                outcomes[(size_t)y * width + x] =
+                    traceOutcome(ro, pixelRay(basis, x, y, width, height), steps, tracer.params);
+                workerSteps[worker] += steps;
+            }
+        }
+    });
+
+    stats.pixels = stats.rays = (long long)width * height;
+    stats.steps = 0;
+    for (long long s : workerSteps) stats.steps += s;
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    countMetric(MetricCounter::CpuRays, (uint64_t)stats.rays);
+    countMetric(MetricCounter::CpuRaySteps, (uint64_t)stats.steps);
+}
+
+void shadeOutcomesCPU(CpuTracer& tracer, const std::vector<RayOutcome>& outcomes, float time, CpuFrame& frame) {
+    TRACE_SCOPE("shadeOutcomesCPU");
+    frame.rgb.resize((size_t)frame.width * frame.height * 3);
+    NodeWorkQueue rows;
+    initNodeWorkQueue(rows, frame.height, tracer.pool.nodeCount);
+    runOnPool(tracer.pool, [&](int worker) {
+        int node = tracer.pool.workerNode[worker];
+        const CpuSkybox& skybox = workerSkybox(tracer, worker);
+        for (int y = takeNodeWork(rows, node); y >= 0; y = takeNodeWork(rows, node)) {
+            for (int x = 0; x < frame.width; x++) {
+                size_t i = (size_t)y * frame.width + x;
+                vec3 col = shadeOutcome(outcomes[i], time, skybox, tracer.diskNoise, tracer.params);
+                frame.rgb[i * 3 + 0] = col.x; frame.rgb[i * 3 + 1] = col.y; frame.rgb[i * 3 + 2] = col.z;
+            }
+        }
+    });
+}
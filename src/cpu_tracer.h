@@ -0,0 +1,163 @@
+#pragma once
+#include "vec3.h"
+#include "camera.h"
+#include "thread_pool.h"
+#include "skybox_cube.h"
+#include "disk_noise.h"
+#include "numa.h"
+#include "integrators.h"
+#include "spacetime.h"
+#include "lenses.h"
+#include <memory>
+#include <vector>
+
+// --- MOTOR DE FÍSICA RELATIVISTA (CPU) ---
+// Port del trazador de blackhole_common.glsl. Sirve para el modo sin
+// ventana (--headless) y como referencia: mismas constantes, mismo
+// integrador y mismo sombreado que la GPU.
+
+//Constantes físicas del sistema (Unidades Naturales: G=1, c=1)
+const float RS = 0.5f; // Radio de Schwarzschild (Horizonte de eventos)
+const float ISCO = 3.0f * RS; // Órbita Circular Estable Más Interna (para el disco)
+const float DISK_MAX = 6.0f * RS; // Borde externo del disco
+const int MAX_STEPS = 200;        // Calidad de la integración
+const float STEP_SIZE = 0.05f;    // Paso de tiempo
+
+const int CPU_TILE_SIZE = 16;     // Teselas cuadradas que se reparten entre hilos
+
+// Disco semitransparente (--disk-opacity < 1): el rayo sigue tras cruzar el disco y
+// acumula emisión y opacidad, así aparecen las imágenes de orden superior (el anillo
+// de fotones por detrás). Termina al pasar DISK_OPACITY_CUTOFF o al llegar a
+// diskOrders cruces; lo que queda detrás se descarta (negro).
+const int DISK_MAX_ORDER = 4;             // Cruces guardados como máximo (imágenes de orden 0 a 3)
+const float DISK_OPACITY_CUTOFF = 0.99f;  // Opacidad acumulada a partir de la cual lo de detrás ya no cuenta
+
+// Parámetros del agujero que se pueden variar sin reiniciar el trazador (--sweep).
+// Por defecto, los mismos valores que las constantes del shader.
+struct BlackHoleParams {
+    float rs = RS;               // Radio del horizonte
+    float diskInner = ISCO;      // Radio interno del disco
+    float diskOuter = DISK_MAX;  // Radio externo del disco
+    bool kerr = false;           // Geodésicas exactas de Kerr (kerr.h) en vez de la fuerza pseudo-newtoniana
+    float spin = 0.0f;           // Kerr: a / M, entre -1 y 1 (positivo = gira con el disco)
+    bool analytic = false;       // Schwarzschild exacto en forma cerrada (analytic.h), sin pasos
+    // Motor pseudo-newtoniano: espacio-tiempo (spacetime.h)
+    SpacetimeKind spacetime = SpacetimeKind::Schwarzschild;
+    float charge = 0.0f;         // Reissner-Nordström: Q en las mismas unidades que rs (|Q| < rs / 2)
+    float lambda = 0.0f;         // Schwarzschild-de Sitter: constante cosmológica Λ
+    std::shared_ptr<const LensField> lenses; // MultiLens: la escena (lenses.h); rs deja de usarse
+    // Motor pseudo-newtoniano: integrador (integrators.h), paso y renormalización nula
+    IntegratorKind integrator = IntegratorKind::RK4;
+    bool nullRenorm = false;     // Reescala |vel| cada paso para conservar la energía del rayo
+    bool rayClasses = true;      // Clasificación previa del rayo (ray_loop.h); false = bucle completo para todos
+    float stepSize = STEP_SIZE;  // Paso fijo (RKF45: paso inicial)
+    float tolerance = INTEGRATOR_TOLERANCE; // RKF45
+    bool fastMath = false;       // Aproximaciones de fast_math.h en la aceleración, el disco y el cielo
+    // Motor pseudo-newtoniano: opacidad de un cruce en el borde interno del disco (1 = opaco, el rayo
+    // termina en el primer cruce) y cruces como máximo con el disco semitransparente
+    float diskOpacity = 1.0f;
+    int diskOrders = DISK_MAX_ORDER;
+};
+
+// Resultado de un rayo (mismo significado que en el shader)
+enum class OutcomeKind { Captured, Escaped, Disk };
+
+struct DiskCrossing {
+    float hitDist, angle, doppler;
+};
+
+struct RayOutcome {
+    OutcomeKind kind = OutcomeKind::Captured;
+    vec3 dir = {0.0f, 0.0f, 0.0f}; // Escaped: dirección final
+    float hitDist = 0.0f;          // Disk: radio del impacto
+    float angle = 0.0f;            // Disk: ángulo polar
+    float doppler = 0.0f;          // Disk: proyección sobre la tangente del disco
+    // Disco semitransparente: el primer cruce es el de arriba, los siguientes van en 'higher'
+    // y 'behind' dice qué hay detrás del último (Escaped: el cielo en 'dir')
+    int crossings = 0;
+    OutcomeKind behind = OutcomeKind::Captured;
+    DiskCrossing higher[DISK_MAX_ORDER - 1];
+};
+
+// Cielo en memoria (RGB 8 bits, fila 0 = arriba, como lo carga stb_image y lo sube loadTexture)
+struct CpuSkybox {
+    int width = 0, height = 0;
+    std::vector<unsigned char> pixels;  // Panorama equirectangular RGB
+    CubeSkybox cube;                    // Remuestreo a cubemap (ver skybox_cube.h)
+    bool useCube = false;
+};
+
+bool loadCpuSkybox(const char* path, CpuSkybox& skybox);
+
+// Imagen de salida: color lineal HDR, fila 0 = abajo (igual que la textura de GL).
+// El buffer no se inicializa al reservar: con NUMA cada nodo toca primero sus teselas.
+struct CpuFrame {
+    int width = 0, height = 0;
+    std::vector<float, FirstTouchAllocator<float>> rgb;
+};
+
+struct CpuFrameStats {
+    long long rays = 0;    // Rayos trazados (menos que píxeles con muestreo adaptativo)
+    long long pixels = 0;
+    long long steps = 0;   // Pasos RK4 totales (cada uno son 4 evaluaciones de aceleración)
+    double ms = 0.0;
+};
+
+struct CpuTracer {
+    ThreadPool pool;
+    CpuSkybox skybox;
+    DiskNoise diskNoise;
+    // NUMA (se leen en startCpuTracer): hilos fijados por nodo, teselas por
+    // franjas de nodo y una copia del cielo en la memoria de cada nodo
+    int numaNodes = 0;                 // 0 = sin NUMA; N = usar los N primeros nodos
+    bool hugePages = false;            // Copias del cielo con páginas enormes (THP)
+    std::vector<CpuSkybox> nodeSkyboxes;
+    // Muestreo adaptativo (mismo criterio que adaptive_refine.glsl, ver adaptive.h)
+    int adaptiveStep = 0;             // <= 1: se trazan todos los píxeles
+    float adaptiveThreshold = 0.08f;
+    BlackHoleParams params;
+};
+
+// Una geodésica completa. 'steps' devuelve cuántos pasos se dieron.
+RayOutcome traceOutcome(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params);
+// Motor pseudo-newtoniano con params.integrator; 'evals' = evaluaciones de la aceleración
+RayOutcome traceOutcomeIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                  const BlackHoleParams& params);
+vec3 shadeOutcome(const RayOutcome& outcome, float time, const CpuSkybox& skybox, const DiskNoise& diskNoise,
+                  const BlackHoleParams& params);
+// Opacidad de un cruce del disco semitransparente a radio 'hitDist' (1 si es opaco)
+float diskCrossingOpacity(float hitDist, const BlackHoleParams& params);
+vec3 getBackground(const vec3& dir, const CpuSkybox& skybox, bool fastMath = false);
+
+// Dirección del rayo de un píxel (mismas coordenadas que raytracing.glsl)
+vec3 pixelRay(const CameraBasis& basis, int px, int py, int width, int height);
+
+// cubeFaceSize: 0 = automático, < 0 = sin cubemap (panorama con atan/asin).
+// El ruido del disco se hornea con diskNoiseSize x diskNoiseSize texels.
+bool startCpuTracer(CpuTracer& tracer, int threads, const char* skyboxPath, int cubeFaceSize,
+                    int diskNoiseSize, int diskOctaves);
+void stopCpuTracer(CpuTracer& tracer);
+
+// Cielo local al nodo del hilo 'worker' (el compartido si no hay copias)
+const CpuSkybox& workerSkybox(const CpuTracer& tracer, int worker);
+
+// Traza un frame completo repartiendo teselas entre los hilos del pool
+void renderFrameCPU(CpuTracer& tracer, const CameraState& camera, float time, CpuFrame& frame,
+                    CpuFrameStats& stats);
+
+// Traza solo un rectángulo de una imagen de fullWidth x fullHeight: 'frame' tiene
+// el tamaño del rectángulo y su píxel (0, 0) es el (originX, originY) de la imagen.
+// Los rayos son los mismos que los de la imagen completa (teselas de la granja, farm.h).
+void renderRegionCPU(CpuTracer& tracer, const CameraState& camera, float time, int fullWidth, int fullHeight,
+                     int originX, int originY, CpuFrame& frame, CpuFrameStats& stats);
+// Igual, pero escribiendo directamente en memoria del que llama (width x height x 3 floats,
+// sin copia intermedia; ver bhsim.h). Quien reserva la memoria decide su nodo NUMA.
+void renderRegionIntoCPU(CpuTracer& tracer, const CameraState& camera, float time, int fullWidth, int fullHeight,
+                         int originX, int originY, int width, int height, float* rgb, CpuFrameStats& stats);
+
+// Geodésicas de toda la imagen sin sombrear. Con la cámara y los parámetros del
+// agujero fijos el resultado no depende del tiempo: se puede sombrear muchas veces.
+void traceOutcomesCPU(CpuTracer& tracer, const CameraState& camera, int width, int height,
+                      std::vector<RayOutcome>& outcomes, CpuFrameStats& stats);
+// Sombrea resultados ya trazados (frame.width x frame.height) para el instante 'time'
+void shadeOutcomesCPU(CpuTracer& tracer, const std::vector<RayOutcome>& outcomes, float time, CpuFrame& frame);
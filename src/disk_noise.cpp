@@ -0,0 +1,108 @@
+#include "disk_noise.h"
+#include "trace.h"
+#include <glad/gl.h>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+static inline float fract(float x) { return x - std::floor(x); }
+
+// 1. Hash: La licuadora de números (el mismo de siempre)
+static float hash(float px, float py) {
+    float p3x = fract(px * .1031f);
+    float p3y = fract(py * .1031f);
+    float p3z = fract(px * .1031f);
+    float d = p3x * (p3y + 33.33f) + p3y * (p3z + 33.33f) + p3z * (p3x + 33.33f);
+    p3x += d; p3y += d; p3z += d;
+    return fract((p3x + p3y) * p3z);
+}
+
+// 2. Ruido de valor periódico: los índices de la rejilla dan la vuelta cada
+// cellsX x cellsY celdas, así la textura no tiene costuras al repetirse
+static float periodicValueNoise(float x, float y, int cellsX, int cellsY, float offset) {
+    float fx0 = std::floor(x), fy0 = std::floor(y);
+    float fx = x - fx0, fy = y - fy0;
+    int ix = (((int)fx0 % cellsX) + cellsX) % cellsX;
+    int iy = (((int)fy0 % cellsY) + cellsY) % cellsY;
+    int ix1 = (ix + 1) % cellsX;
+    int iy1 = (iy + 1) % cellsY;
+
+    float a = hash(ix + offset, iy + offset);
+    float b = hash(ix1 + offset, iy + offset);
+    float c = hash(ix + offset, iy1 + offset);
+    float d = hash(ix1 + offset, iy1 + offset);
+    float ux = fx * fx * (3.0f - 2.0f * fx); // Curva Hermite (Smoothstep)
+    float uy = fy * fy * (3.0f - 2.0f * fy);
+    float ab = a + (b - a) * ux;
+    float cd = c + (d - c) * ux;
+    return ab + (cd - ab) * uy;
+}
+
+// 3. FBM: cada octava dobla la frecuencia y divide la amplitud. El fbm original
+// rotaba cada capa para esconder la rejilla, pero una rotación rompe la
+// periodicidad; en su lugar cada octava usa otra zona del hash.
+float proceduralDiskNoise(float u, float v, int octaves) {
+    float x = u / DISK_NOISE_PERIOD_U * DISK_NOISE_CELLS_U;
+    float y = v / DISK_NOISE_PERIOD_V * DISK_NOISE_CELLS_V;
+    float value = 0.0f;
+    float amplitude = 0.5f;
+    for (int i = 0; i < octaves; i++) {
+        int scale = 1 << i;
+        value += amplitude * periodicValueNoise(x * scale, y * scale, DISK_NOISE_CELLS_U * scale,
+                                                DISK_NOISE_CELLS_V * scale, 100.0f * i);
+        amplitude *= 0.5f;
+    }
+    return value;
+}
+
+void bakeDiskNoise(DiskNoise& noise, int width, int height, int octaves, ThreadPool& pool) {
+    TRACE_SCOPE("bakeDiskNoise");
+    noise.width = width;
+    noise.height = height;
+    noise.octaves = octaves;
+    noise.values.resize((size_t)width * height);
+
+    std::atomic<int> nextRow(0);
+    runOnPool(pool, [&](int) {
+        for (int y = nextRow++; y < height; y = nextRow++) {
+            float v = (y + 0.5f) / height * DISK_NOISE_PERIOD_V;
+            float* row = &noise.values[(size_t)y * width];
+            for (int x = 0; x < width; x++) {
+                row[x] = proceduralDiskNoise((x + 0.5f) / width * DISK_NOISE_PERIOD_U, v, octaves);
+            }
+        }
+    });
+    std::cout << "Ruido del disco horneado: " << width << "x" << height << ", " << octaves << " octavas" << std::endl;
+}
+
+float sampleDiskNoise(const DiskNoise& noise, float u, float v) {
+    // Igual que GL_LINEAR + GL_REPEAT: centros de texel en (i + 0.5) / tamaño
+    float x = fract(u / DISK_NOISE_PERIOD_U) * noise.width - 0.5f;
+    float y = fract(v / DISK_NOISE_PERIOD_V) * noise.height - 0.5f;
+    float fx0 = std::floor(x), fy0 = std::floor(y);
+    float fx = x - fx0, fy = y - fy0;
+    int x0 = ((int)fx0 + noise.width) % noise.width;
+    int y0 = ((int)fy0 + noise.height) % noise.height;
+    int x1 = (x0 + 1) % noise.width;
+    int y1 = (y0 + 1) % noise.height;
+
+    const float* row0 = &noise.values[(size_t)y0 * noise.width];
+    const float* row1 = &noise.values[(size_t)y1 * noise.width];
+    float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+unsigned int uploadDiskNoise(const DiskNoise& noise) {
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // Media precisión: el sombreado multiplica el ruido por ~6, con 8 bits se verían escalones
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, noise.width, noise.height, 0, GL_RED, GL_FLOAT, noise.values.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return textureID;
+}
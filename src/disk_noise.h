@@ -0,0 +1,35 @@
+#pragma once
+#include "thread_pool.h"
+#include <vector>
+
+// --- RUIDO DEL DISCO HORNEADO ---
+// Cada impacto en el disco evaluaba un fbm de 5 octavas (4 hash por octava)
+// en cada frame. Ahora el fbm se hornea una vez en una textura periódica en
+// (ángulo, radio) y el sombreado hace una sola lectura bilineal; el tiempo
+// solo desplaza/rota las coordenadas de búsqueda y la textura se repite.
+//
+// Coordenadas de ruido (las mismas de siempre): u = 3 * ángulo rotado,
+// v = 1.5 * radio - tiempo. Una vuelta del disco son 6π en u; en v la
+// textura se repite cada DISK_NOISE_PERIOD_V unidades.
+
+const float DISK_NOISE_PERIOD_U = 6.0f * 3.14159265f;
+const float DISK_NOISE_PERIOD_V = 16.0f;
+const int DISK_NOISE_CELLS_U = 19;   // Celdas de la primera octava en cada período
+const int DISK_NOISE_CELLS_V = 16;   // (~1 celda por unidad, como el fbm original)
+const int DISK_NOISE_DEFAULT_SIZE = 1024;
+const int DISK_NOISE_DEFAULT_OCTAVES = 5;
+
+struct DiskNoise {
+    int width = 0, height = 0;
+    int octaves = 0;
+    std::vector<float> values;  // [0, 1], fila 0 = v = 0
+};
+
+// fbm periódico evaluado directamente (referencia del horneado y del benchmark)
+float proceduralDiskNoise(float u, float v, int octaves);
+
+void bakeDiskNoise(DiskNoise& noise, int width, int height, int octaves, ThreadPool& pool);
+// Lectura bilineal con repetición en los dos ejes (u, v en coordenadas de ruido)
+float sampleDiskNoise(const DiskNoise& noise, float u, float v);
+// Textura GL_R16F con GL_REPEAT para el sampler diskNoise de blackhole_common.glsl
+unsigned int uploadDiskNoise(const DiskNoise& noise);
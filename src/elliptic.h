@@ -0,0 +1,60 @@
+#pragma once
+#include <cmath>
+
+// --- FUNCIONES ELÍPTICAS (número fijo de iteraciones) ---
+// Sin bucles hasta convergencia ni ramas dependientes de los datos: cada
+// llamada cuesta lo mismo, se vectoriza y es el mismo código que
+// shaders/analytic.glsl. Precisión de float con los tamaños de abajo.
+
+const int ELLIPTIC_RF_ITERATIONS = 10;   // Duplicaciones de Carlson (el error se divide por 4^6 en cada una)
+const int ELLIPTIC_AGM_ITERATIONS = 8;   // Media aritmético-geométrica para sn, cn, dn (k' hasta ~1e-6)
+
+// Integral simétrica de Carlson R_F(x, y, z), x, y, z >= 0 y como mucho uno nulo
+inline float carlsonRF(float x, float y, float z) {
+    for (int i = 0; i < ELLIPTIC_RF_ITERATIONS; i++) {
+        float sx = std::sqrt(x), sy = std::sqrt(y), sz = std::sqrt(z);
+        float lambda = sx * (sy + sz) + sy * sz;
+        x = 0.25f * (x + lambda);
+        y = 0.25f * (y + lambda);
+        z = 0.25f * (z + lambda);
+    }
+    float mean = (x + y + z) * (1.0f / 3.0f);
+    float dx = 1.0f - x / mean, dy = 1.0f - y / mean, dz = 1.0f - z / mean;
+    float e2 = dx * dy - dz * dz;
+    float e3 = dx * dy * dz;
+    return (1.0f - e2 * 0.1f + e3 * (1.0f / 14.0f) + e2 * e2 * (1.0f / 24.0f) - e2 * e3 * (3.0f / 44.0f)) /
+           std::sqrt(mean);
+}
+
+// Integral completa de primera especie K(k), con m = k²
+inline float ellipticK(float m) {
+    return carlsonRF(0.0f, 1.0f - m, 1.0f);
+}
+
+// Integral incompleta de primera especie F(φ | m), φ en [0, π/2]
+inline float ellipticF(float phi, float m) {
+    float s = std::sin(phi), c = std::cos(phi);
+    return s * carlsonRF(c * c, 1.0f - m * s * s, 1.0f);
+}
+
+// sn, cn, dn de Jacobi (m = k² en [0, 1)) por la transformación descendente de Landen
+inline void jacobiSnCnDn(float u, float m, float& sn, float& cn, float& dn) {
+    float a[ELLIPTIC_AGM_ITERATIONS + 1], c[ELLIPTIC_AGM_ITERATIONS + 1];
+    float an = 1.0f, bn = std::sqrt(1.0f - m);
+    a[0] = an;
+    c[0] = std::sqrt(m);
+    for (int i = 1; i <= ELLIPTIC_AGM_ITERATIONS; i++) {
+        float next = 0.5f * (an + bn);
+        c[i] = 0.5f * (an - bn);
+        bn = std::sqrt(an * bn);
+        an = next;
+        a[i] = an;
+    }
+    float phi = float(1 << ELLIPTIC_AGM_ITERATIONS) * a[ELLIPTIC_AGM_ITERATIONS] * u;
+    for (int i = ELLIPTIC_AGM_ITERATIONS; i > 0; i--) {
+        phi = 0.5f * (phi + std::asin(c[i] / a[i] * std::sin(phi)));
+    }
+    sn = std::sin(phi);
+    cn = std::cos(phi);
+    dn = std::sqrt(1.0f - m * sn * sn);
+}
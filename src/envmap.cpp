@@ -0,0 +1,75 @@
+#include <glad/gl.h>
+#include "envmap.h"
+#include <iostream>
+
+EnvMapCache createEnvMapCache(int faceSize) {
+    EnvMapCache cache;
+    cache.faceSize = faceSize;
+
+    glGenTextures(1, &cache.texture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cache.texture);
+    // RGBA32F: el radio, el ángulo y la dirección de escape necesitan precisión completa
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGBA32F, faceSize, faceSize);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    std::cout << "Mapa de entorno: 6 x " << faceSize << "x" << faceSize << " ("
+              << 6.0 * faceSize * faceSize * 16 / (1024.0 * 1024.0) << " MB)" << std::endl;
+    return cache;
+}
+
+void destroyEnvMapCache(EnvMapCache& cache) {
+    glDeleteTextures(1, &cache.texture);
+    cache.texture = 0;
+    cache.valid = false;
+}
+
+bool envMapMatches(const EnvMapCache& cache, float camX, float camY, float camZ) {
+    return cache.valid && cache.bakedPos[0] == camX && cache.bakedPos[1] == camY && cache.bakedPos[2] == camZ;
+}
+
+void bakeEnvMap(EnvMapCache& cache, unsigned int bakeProgram, float camX, float camY, float camZ) {
+    glUseProgram(bakeProgram);
+    glUniform3f(glGetUniformLocation(bakeProgram, "u_bakePos"), camX, camY, camZ);
+    glUniform1i(glGetUniformLocation(bakeProgram, "u_faceSize"), cache.faceSize);
+    glUniform1i(glGetUniformLocation(bakeProgram, "skybox"), 0);
+
+    // Layered = GL_TRUE: las 6 caras como un array, la z del dispatch elige la cara
+    glBindImageTexture(0, cache.texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glDispatchCompute((cache.faceSize + 7) / 8, (cache.faceSize + 7) / 8, 6);
+
+    // El pase de vista lee el cubemap como textura
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    cache.bakedPos[0] = camX;
+    cache.bakedPos[1] = camY;
+    cache.bakedPos[2] = camZ;
+    cache.valid = true;
+    cache.bakes++;
+}
+
+void renderFromEnvMap(EnvMapCache& cache, unsigned int viewProgram, unsigned int outputTexture,
+                      int width, int height) {
+    glUseProgram(viewProgram);
+    glUniform2i(glGetUniformLocation(viewProgram, "u_viewport"), width, height);
+    glUniform1i(glGetUniformLocation(viewProgram, "skybox"), 0);
+    glUniform1i(glGetUniformLocation(viewProgram, "u_envMap"), 1);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cache.texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+    cache.framesServed++;
+}
+
+void printEnvMapStats(const EnvMapCache& cache) {
+    std::cout << "Mapa de entorno: " << cache.bakes << " horneados, " << cache.framesServed
+              << " frames servidos desde la caché" << std::endl;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// --- CACHÉ DE MAPA DE ENTORNO LENSADO (MODO 360°) ---
+// En Schwarzschild, con la cámara quieta, el resultado de cada rayo solo
+// depende de su dirección. Trazamos una vez un cubemap de resultados en la
+// posición de la cámara (envmap_bake.glsl) y cada frame solo hacemos una
+// búsqueda por píxel (envmap_view.glsl): girar la vista o cambiar el FOV es
+// casi gratis. Al trasladar la cámara el cubemap deja de valer.
+
+const int ENVMAP_DEFAULT_SIZE = 1024;
+
+struct EnvMapCache {
+    unsigned int texture = 0;
+    int faceSize = 0;
+    bool valid = false;
+    float bakedPos[3] = {0.0f, 0.0f, 0.0f};
+
+    long bakes = 0;         // Veces que se ha trazado el cubemap
+    long framesServed = 0;  // Frames resueltos con búsquedas en el cubemap
+};
+
+EnvMapCache createEnvMapCache(int faceSize);
+void destroyEnvMapCache(EnvMapCache& cache);
+
+// ¿El cubemap sirve para esta posición de cámara?
+bool envMapMatches(const EnvMapCache& cache, float camX, float camY, float camZ);
+
+// Traza las 6 caras desde la posición dada (el FrameBlock y el skybox ya deben estar conectados)
+void bakeEnvMap(EnvMapCache& cache, unsigned int bakeProgram, float camX, float camY, float camZ);
+
+// Rellena 'outputTexture' (sub-rectángulo width x height) buscando en el cubemap
+void renderFromEnvMap(EnvMapCache& cache, unsigned int viewProgram, unsigned int outputTexture,
+                      int width, int height);
+
+void printEnvMapStats(const EnvMapCache& cache);
@@ -0,0 +1,601 @@
+#include "farm.h"
+#include "net.h"
+#include "camera_path.h"
+#include "cpu_tracer.h"
+#include "hdr.h"
+#include "image_io.h"
+#include "metrics.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+static const uint32_t FARM_MAGIC = 0x4D464842;   // "BHFM" en little-endian
+static const uint32_t FARM_VERSION = 9;
+static const int FARM_JOBS_PER_WORKER = 2;       // Trabajos en vuelo por trabajador (tapa la ida y vuelta)
+static const int FARM_MAX_ATTEMPTS = 3;          // Repartos de un mismo trabajo antes de dar la granja por fallida
+static const int FARM_ERROR_BACKOFF_MS = 100;    // Espera tras un error de select
+
+enum FarmMessageType : uint32_t {
+    FARM_HELLO = 1, FARM_SETUP = 2, FARM_JOB = 3, FARM_RESULT = 4, FARM_QUIT = 5, FARM_HEARTBEAT = 6
+};
+
+struct FarmHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t bytes;    // Tamaño de lo que sigue a la cabecera
+};
+
+struct FarmHello {
+    uint32_t version;
+    uint32_t threads;
+};
+
+// Opciones que cambian la imagen: las impone el coordinador para que todos los trabajadores tracen igual
+struct FarmSetup {
+    int32_t cubeFaceSize;
+    int32_t diskNoiseSize;
+    int32_t diskOctaves;
+    int32_t adaptiveStep;
+    float adaptiveThreshold;
+    int32_t kerr;      // != 0: motor de Kerr con 'spin'
+    float spin;
+    int32_t analytic;  // != 0: Schwarzschild en forma cerrada
+    int32_t integrator;// IntegratorKind
+    int32_t nullRenorm;
+    int32_t fastMath;
+    int32_t spacetime; // SpacetimeKind
+    float charge;
+    float lambda;
+    float diskOpacity;
+    int32_t diskOrders;
+    int32_t rayClasses;
+};
+
+struct FarmJob {
+    uint32_t id;
+    uint32_t frame;
+    float camera[6];   // x, y, z, yaw, pitch, focal
+    float time;
+    int32_t width, height;        // Imagen completa
+    int32_t x0, y0, x1, y1;       // Rectángulo a trazar
+};
+
+// Va seguido de (x1 - x0) * (y1 - y0) * 3 floats: el RGB lineal del rectángulo, fila 0 = abajo
+struct FarmResult {
+    uint32_t id;
+    float ms;
+    uint64_t rays;
+    uint64_t steps;
+};
+
+static_assert(sizeof(FarmHeader) == 12, "FarmHeader: el protocolo asume structs sin relleno");
+static_assert(sizeof(FarmHello) == 8, "FarmHello: el protocolo asume structs sin relleno");
+static_assert(sizeof(FarmSetup) == 68, "FarmSetup: el protocolo asume structs sin relleno");
+static_assert(sizeof(FarmJob) == 60, "FarmJob: el protocolo asume structs sin relleno");
+static_assert(sizeof(FarmResult) == 24, "FarmResult: el protocolo asume structs sin relleno");
+
+static bool sendMessage(NetSocket socket, uint32_t type, const void* payload, size_t bytes,
+                        const void* extra = nullptr, size_t extraBytes = 0) {
+    FarmHeader header = {FARM_MAGIC, type, (uint32_t)(bytes + extraBytes)};
+    return sendAll(socket, &header, sizeof(header)) && (bytes == 0 || sendAll(socket, payload, bytes)) &&
+           (extraBytes == 0 || sendAll(socket, extra, extraBytes));
+}
+
+static void packCamera(const CameraState& camera, float out[6]) {
+    out[0] = camera.x; out[1] = camera.y; out[2] = camera.z;
+    out[3] = camera.yaw; out[4] = camera.pitch; out[5] = camera.focal;
+}
+
+static CameraState unpackCamera(const float in[6]) {
+    CameraState camera;
+    camera.x = in[0]; camera.y = in[1]; camera.z = in[2];
+    camera.yaw = in[3]; camera.pitch = in[4]; camera.focal = in[5];
+    return camera;
+}
+
+// ---------------------------------------------------------------------------
+// Trabajador
+// ---------------------------------------------------------------------------
+
+int runFarmWorker(const AppConfig& config) {
+    size_t colon = config.farmWorker.rfind(':');
+    std::string host = config.farmWorker.substr(0, colon);
+    int port = std::atoi(config.farmWorker.c_str() + colon + 1);
+
+    if (!netStartup()) return -1;
+    NetSocket socket = connectTcp(host, port);
+    if (socket == INVALID_NET_SOCKET) {
+        netCleanup();
+        return -1;
+    }
+
+    CpuTracer tracer;
+    if (config.numa) tracer.numaNodes = config.numaNodes > 0 ? config.numaNodes : 1 << 16;
+    tracer.hugePages = config.hugePages;
+    bool started = false, ok = true;
+    CpuFrame region;
+    int jobs = 0;
+
+    // Latidos desde su propio hilo: el trazado de un trabajo ocupa este. Los envíos
+    // de los dos hilos se serializan para no mezclar mensajes en el socket.
+    std::mutex sendMutex;
+    std::atomic<bool> beating(false), quit(false);
+    auto send = [&](uint32_t type, const void* payload, size_t bytes, const void* extra = nullptr,
+                    size_t extraBytes = 0) {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        return sendMessage(socket, type, payload, bytes, extra, extraBytes);
+    };
+    std::thread heartbeat([&]() {
+        auto last = std::chrono::steady_clock::now();
+        while (!quit.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            auto now = std::chrono::steady_clock::now();
+            if (!beating.load() || std::chrono::duration<double>(now - last).count() < FARM_HEARTBEAT_S) continue;
+            last = now;
+            if (!send(FARM_HEARTBEAT, nullptr, 0)) break; // El bucle principal verá la conexión cerrada
+        }
+    });
+
+    while (true) {
+        FarmHeader header;
+        if (!recvAll(socket, &header, sizeof(header))) break; // Coordinador caído o cerrado: no hay más trabajo
+        if (header.magic != FARM_MAGIC) {
+            std::cout << "ERROR: Mensaje no válido del coordinador" << std::endl;
+            ok = false;
+            break;
+        }
+        if (header.type == FARM_QUIT) break;
+
+        if (header.type == FARM_SETUP && header.bytes == sizeof(FarmSetup) && !started) {
+            FarmSetup setup;
+            if (!recvAll(socket, &setup, sizeof(setup))) break;
+            if (!startCpuTracer(tracer, config.threads, config.skyboxPath.c_str(), setup.cubeFaceSize,
+                                setup.diskNoiseSize, setup.diskOctaves)) {
+                ok = false;
+                break;
+            }
+            started = true;
+            tracer.adaptiveStep = setup.adaptiveStep;
+            tracer.adaptiveThreshold = setup.adaptiveThreshold;
+            tracer.params.kerr = setup.kerr != 0;
+            tracer.params.spin = setup.spin;
+            tracer.params.analytic = setup.analytic != 0;
+            tracer.params.integrator = (IntegratorKind)setup.integrator;
+            tracer.params.nullRenorm = setup.nullRenorm != 0;
+            tracer.params.fastMath = setup.fastMath != 0;
+            tracer.params.spacetime = (SpacetimeKind)setup.spacetime;
+            tracer.params.charge = setup.charge;
+            tracer.params.lambda = setup.lambda;
+            tracer.params.diskOpacity = setup.diskOpacity;
+            tracer.params.diskOrders = setup.diskOrders;
+            tracer.params.rayClasses = setup.rayClasses != 0;
+
+            // Listo: a partir de aquí el coordinador empieza a mandar trabajos
+            FarmHello hello = {FARM_VERSION, (uint32_t)threadPoolSize(tracer.pool)};
+            if (!send(FARM_HELLO, &hello, sizeof(hello))) break;
+            beating = true;
+        } else if (header.type == FARM_JOB && header.bytes == sizeof(FarmJob) && started) {
+            FarmJob job;
+            if (!recvAll(socket, &job, sizeof(job))) break;
+            TRACE_SCOPE("farmJob");
+            region.width = job.x1 - job.x0;
+            region.height = job.y1 - job.y0;
+            CpuFrameStats stats;
+            renderRegionCPU(tracer, unpackCamera(job.camera), job.time, job.width, job.height, job.x0, job.y0,
+                            region, stats);
+            countMetric(MetricCounter::Frames);
+
+            FarmResult result = {job.id, (float)stats.ms, (uint64_t)stats.rays, (uint64_t)stats.steps};
+            if (!send(FARM_RESULT, &result, sizeof(result), region.rgb.data(), region.rgb.size() * sizeof(float))) {
+                break;
+            }
+            jobs++;
+        } else {
+            std::cout << "ERROR: Mensaje inesperado del coordinador (tipo " << header.type << ")" << std::endl;
+            ok = false;
+            break;
+        }
+    }
+
+    quit = true;
+    heartbeat.join();
+    closeNetSocket(socket);
+    if (started) stopCpuTracer(tracer);
+    netCleanup();
+    std::cout << "Trabajador: " << jobs << " trabajos completados" << std::endl;
+    return ok ? 0 : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Coordinador
+// ---------------------------------------------------------------------------
+
+struct FarmJobState {
+    FarmJob job;
+    bool done = false;
+    int attempts = 0;         // Veces que se ha enviado a un trabajador
+};
+
+struct FarmFrame {
+    std::vector<float> rgb;   // Se reserva con el primer resultado y se libera al escribirlo
+    int pendingJobs = 0;
+};
+
+struct FarmWorker {
+    NetSocket socket = INVALID_NET_SOCKET;
+    bool ready = false;       // HELLO recibido: ya tiene el trazador en marcha
+    int threads = 0;
+    std::vector<char> inbox;  // Bytes recibidos aún sin formar un mensaje completo
+    std::vector<int> jobs;    // Trabajos en vuelo
+    std::chrono::steady_clock::time_point lastHeard; // Conexión o último mensaje (HELLO, resultado o latido)
+    int jobsDone = 0;
+    double busyMs = 0.0;
+};
+
+struct FarmState {
+    std::vector<FarmJobState> jobs;
+    std::deque<int> pending;
+    std::vector<FarmFrame> frames;
+    std::vector<FarmWorker> workers;  // Los desconectados se quedan (socket inválido) para el informe
+    int retries = 0;
+    size_t maxPayload = 0;    // El mensaje más grande posible: el RESULT de la tesela mayor
+    bool failed = false;      // Un trabajo ha agotado sus FARM_MAX_ATTEMPTS
+    long long rays = 0, steps = 0;
+};
+
+// Cierra la conexión y devuelve sus trabajos al principio de la cola (en el mismo orden).
+// Un trabajo que ya ha tumbado a FARM_MAX_ATTEMPTS trabajadores hace fallar la granja.
+static void dropWorker(FarmState& farm, int index, const char* reason) {
+    FarmWorker& worker = farm.workers[index];
+    std::cout << "Trabajador " << index << ": " << reason;
+    if (!worker.jobs.empty()) std::cout << ", se reencolan " << worker.jobs.size() << " trabajos";
+    std::cout << std::endl;
+    for (auto it = worker.jobs.rbegin(); it != worker.jobs.rend(); ++it) {
+        if (farm.jobs[*it].attempts >= FARM_MAX_ATTEMPTS && !farm.failed) {
+            std::cout << "ERROR: El trabajo " << *it << " (frame " << farm.jobs[*it].job.frame << ") ha fallado "
+                      << FARM_MAX_ATTEMPTS << " veces" << std::endl;
+            farm.failed = true;
+        }
+        farm.pending.push_front(*it);
+    }
+    farm.retries += (int)worker.jobs.size();
+    worker.jobs.clear();
+    worker.inbox.clear();
+    closeNetSocket(worker.socket);
+    worker.socket = INVALID_NET_SOCKET;
+    worker.ready = false;
+}
+
+static bool handleResult(FarmState& farm, int index, const char* payload, size_t bytes) {
+    FarmWorker& worker = farm.workers[index];
+    if (bytes < sizeof(FarmResult)) return false;
+    FarmResult result;
+    std::memcpy(&result, payload, sizeof(result));
+
+    auto inFlight = std::find(worker.jobs.begin(), worker.jobs.end(), (int)result.id);
+    if (result.id >= farm.jobs.size() || inFlight == worker.jobs.end()) return false;
+    FarmJobState& state = farm.jobs[result.id];
+    const FarmJob& job = state.job;
+    int tileWidth = job.x1 - job.x0, tileHeight = job.y1 - job.y0;
+    if (bytes != sizeof(FarmResult) + (size_t)tileWidth * tileHeight * 3 * sizeof(float)) return false;
+
+    FarmFrame& frame = farm.frames[job.frame];
+    if (frame.rgb.empty()) frame.rgb.resize((size_t)job.width * job.height * 3);
+    const char* rgb = payload + sizeof(FarmResult);
+    for (int y = 0; y < tileHeight; y++) {
+        std::memcpy(&frame.rgb[((size_t)(job.y0 + y) * job.width + job.x0) * 3],
+                    rgb + (size_t)y * tileWidth * 3 * sizeof(float), (size_t)tileWidth * 3 * sizeof(float));
+    }
+    frame.pendingJobs--;
+    state.done = true;
+    worker.jobs.erase(inFlight);
+    worker.jobsDone++;
+    worker.busyMs += result.ms;
+    farm.rays += (long long)result.rays;
+    farm.steps += (long long)result.steps;
+    return true;
+}
+
+// Procesa los mensajes completos de la bandeja de entrada. false = la conexión debe cerrarse.
+static bool handleMessages(FarmState& farm, int index) {
+    FarmWorker& worker = farm.workers[index];
+    size_t offset = 0;
+    bool ok = true;
+    while (worker.inbox.size() - offset >= sizeof(FarmHeader)) {
+        FarmHeader header;
+        std::memcpy(&header, worker.inbox.data() + offset, sizeof(header));
+        if (header.magic != FARM_MAGIC || header.bytes > farm.maxPayload) {
+            ok = false; // Sin el tope, una cabecera rota haría crecer la bandeja sin límite
+            break;
+        }
+        if (worker.inbox.size() - offset - sizeof(header) < header.bytes) break; // Falta el resto del mensaje
+        const char* payload = worker.inbox.data() + offset + sizeof(header);
+
+        if (header.type == FARM_HELLO && header.bytes == sizeof(FarmHello) && !worker.ready) {
+            FarmHello hello;
+            std::memcpy(&hello, payload, sizeof(hello));
+            if (hello.version != FARM_VERSION) {
+                std::cout << "ERROR: Trabajador " << index << " con protocolo v" << hello.version << " (se esperaba v"
+                          << FARM_VERSION << ")" << std::endl;
+                ok = false;
+                break;
+            }
+            worker.ready = true;
+            worker.lastHeard = std::chrono::steady_clock::now();
+            worker.threads = (int)hello.threads;
+            std::cout << "Trabajador " << index << " listo (" << worker.threads << " hilos)" << std::endl;
+        } else if (header.type == FARM_HEARTBEAT && header.bytes == 0 && worker.ready) {
+            // Solo dice que sigue vivo: lastHeard ya se actualizó al recibir
+        } else if (header.type == FARM_RESULT && worker.ready) {
+            if (!handleResult(farm, index, payload, header.bytes)) {
+                ok = false;
+                break;
+            }
+        } else {
+            ok = false;
+            break;
+        }
+        offset += sizeof(header) + header.bytes;
+    }
+    worker.inbox.erase(worker.inbox.begin(), worker.inbox.begin() + offset);
+    return ok;
+}
+
+// Reparte la cola entre los trabajadores listos, primero a los menos cargados
+static void dispatchJobs(FarmState& farm) {
+    while (!farm.pending.empty()) {
+        int best = -1;
+        for (int i = 0; i < (int)farm.workers.size(); i++) {
+            const FarmWorker& w = farm.workers[i];
+            if (w.socket == INVALID_NET_SOCKET || !w.ready || (int)w.jobs.size() >= FARM_JOBS_PER_WORKER) continue;
+            if (best < 0 || w.jobs.size() < farm.workers[best].jobs.size()) best = i;
+        }
+        if (best < 0) return;
+
+        int id = farm.pending.front();
+        farm.pending.pop_front();
+        FarmWorker& worker = farm.workers[best];
+        worker.jobs.push_back(id);
+        farm.jobs[id].attempts++;
+        if (!sendMessage(worker.socket, FARM_JOB, &farm.jobs[id].job, sizeof(FarmJob))) {
+            dropWorker(farm, best, "error al enviar");
+        }
+    }
+}
+
+#ifndef _WIN32
+// Trabajadores en este mismo nodo: el propio ejecutable con --farm-worker
+static std::vector<pid_t> spawnLocalWorkers(const AppConfig& config, const char* exePath) {
+    std::vector<pid_t> children;
+    int threads = config.threads > 0
+        ? config.threads
+        : std::max(1, (int)std::thread::hardware_concurrency() / config.farmLocal);
+    std::string address = "127.0.0.1:" + std::to_string(config.farmCoordinatorPort);
+    std::string threadArg = std::to_string(threads);
+    for (int i = 0; i < config.farmLocal; i++) {
+        std::vector<char*> args = {(char*)exePath, (char*)"--farm-worker", (char*)address.c_str(),
+                                   (char*)"--threads", (char*)threadArg.c_str()};
+        if (config.numa) args.push_back((char*)"--numa");
+        args.push_back((char*)"--skybox");
+        args.push_back((char*)config.skyboxPath.c_str());
+        args.push_back(nullptr);
+        pid_t pid = 0;
+        if (posix_spawn(&pid, exePath, nullptr, nullptr, args.data(), environ) != 0) {
+            std::cout << "ERROR: No se pudo lanzar el trabajador local " << exePath << std::endl;
+            continue;
+        }
+        children.push_back(pid);
+    }
+    return children;
+}
+#endif
+
+int runFarmCoordinator(const AppConfig& config, const char* exePath) {
+    CameraPath cameraPath;
+    if (!loadCameraPath(config.replayPath, cameraPath)) return -1;
+    if (cameraPath.frames.empty()) {
+        std::cout << "ERROR: El recorrido no tiene frames" << std::endl;
+        return -1;
+    }
+
+    // Trabajos: un frame entero o teselas de farmTile x farmTile, en orden de frame
+    FarmState farm;
+    int tile = config.farmTile > 0 ? config.farmTile : std::max(config.width, config.height);
+    int tilesX = (config.width + tile - 1) / tile, tilesY = (config.height + tile - 1) / tile;
+    farm.maxPayload = sizeof(FarmResult) +
+                      (size_t)std::min(tile, config.width) * std::min(tile, config.height) * 3 * sizeof(float);
+    float animationTime = 0.0f;
+    farm.frames.resize(cameraPath.frames.size());
+    for (size_t i = 0; i < cameraPath.frames.size(); i++) {
+        const CameraPathFrame& pathFrame = cameraPath.frames[i];
+        if (pathFrame.animateDisk) animationTime += cameraPath.fixedDt;
+        farm.frames[i].pendingJobs = tilesX * tilesY;
+        for (int ty = 0; ty < tilesY; ty++) {
+            for (int tx = 0; tx < tilesX; tx++) {
+                FarmJobState state;
+                FarmJob& job = state.job;
+                job.id = (uint32_t)farm.jobs.size();
+                job.frame = (uint32_t)i;
+                packCamera(pathFrame.camera, job.camera);
+                job.time = animationTime;
+                job.width = config.width;
+                job.height = config.height;
+                job.x0 = tx * tile;
+                job.y0 = ty * tile;
+                job.x1 = std::min(job.x0 + tile, config.width);
+                job.y1 = std::min(job.y0 + tile, config.height);
+                farm.pending.push_back((int)job.id);
+                farm.jobs.push_back(state);
+            }
+        }
+    }
+
+    if (!netStartup()) return -1;
+    NetSocket listener = listenTcp(config.farmBind, config.farmCoordinatorPort, "granja");
+    if (listener == INVALID_NET_SOCKET) {
+        netCleanup();
+        return -1;
+    }
+    std::cout << "Granja: " << farm.frames.size() << " frames, " << farm.jobs.size() << " trabajos ("
+              << config.width << "x" << config.height << ", tesela " << std::min(tile, config.width) << "x"
+              << std::min(tile, config.height) << "), esperando trabajadores en " << config.farmBind << ":"
+              << config.farmCoordinatorPort << std::endl;
+
+#ifndef _WIN32
+    std::vector<pid_t> children;
+    if (config.farmLocal > 0) children = spawnLocalWorkers(config, exePath);
+    size_t childrenAlive = children.size();
+#else
+    (void)exePath;
+#endif
+
+    IntegratorKind integrator = IntegratorKind::RK4;
+    parseIntegratorKind(config.integrator, integrator);
+    FarmSetup setup = {config.equirectSkybox ? -1 : config.skyboxFaceSize, config.diskNoiseSize, config.diskOctaves,
+                       config.adaptiveStep, config.adaptiveThreshold, config.kerr ? 1 : 0, config.kerrSpin,
+                       config.analytic ? 1 : 0, (int32_t)integrator, config.nullRenorm ? 1 : 0,
+                       config.fastMath ? 1 : 0, (int32_t)spacetimeFor(config.charge, config.lambda),
+                       config.charge, config.lambda, config.diskOpacity, config.diskOrders,
+                       config.rayClasses ? 1 : 0};
+    auto start = std::chrono::steady_clock::now();
+    float exposure = 1.0f;
+    size_t nextFlush = 0;
+    bool ok = true;
+
+    while (nextFlush < farm.frames.size()) {
+        std::vector<NetSocket> sockets = {listener};
+        std::vector<int> owners = {-1};
+        for (int i = 0; i < (int)farm.workers.size(); i++) {
+            if (farm.workers[i].socket == INVALID_NET_SOCKET) continue;
+            sockets.push_back(farm.workers[i].socket);
+            owners.push_back(i);
+        }
+        std::unique_ptr<bool[]> readable(new bool[sockets.size()]);
+        if (waitReadable(sockets.data(), (int)sockets.size(), 200, readable.get()) < 0) {
+            // Error de select (p. ej. EINTR): nada legible; sin esperar, este bucle se comería un núcleo
+            std::this_thread::sleep_for(std::chrono::milliseconds(FARM_ERROR_BACKOFF_MS));
+        }
+
+        if (readable[0]) {
+            FarmWorker worker;
+            worker.socket = acceptTcp(listener);
+            if (worker.socket != INVALID_NET_SOCKET) {
+                // El trabajador arranca su trazador con estas opciones y contesta con HELLO
+                if (sendMessage(worker.socket, FARM_SETUP, &setup, sizeof(setup))) {
+                    worker.lastHeard = std::chrono::steady_clock::now(); // El HELLO también tiene plazo
+                    farm.workers.push_back(std::move(worker));
+                } else {
+                    closeNetSocket(worker.socket);
+                }
+            }
+        }
+
+        for (size_t s = 1; s < sockets.size(); s++) {
+            if (!readable[s]) continue;
+            int index = owners[s];
+            char buffer[64 * 1024];
+            long received = recvSome(sockets[s], buffer, sizeof(buffer));
+            if (received <= 0) {
+                dropWorker(farm, index, "desconectado");
+                continue;
+            }
+            FarmWorker& worker = farm.workers[index];
+            worker.lastHeard = std::chrono::steady_clock::now();
+            worker.inbox.insert(worker.inbox.end(), buffer, buffer + received);
+            if (!handleMessages(farm, index)) dropWorker(farm, index, "mensaje no válido");
+        }
+
+        // Colgados: conectados pero sin un solo latido (o sin HELLO) en --farm-timeout. Un trabajo
+        // largo no cuenta: mientras traza, el trabajador sigue latiendo.
+        auto now = std::chrono::steady_clock::now();
+        for (int i = 0; i < (int)farm.workers.size(); i++) {
+            const FarmWorker& w = farm.workers[i];
+            if (w.socket == INVALID_NET_SOCKET) continue;
+            if (std::chrono::duration<double>(now - w.lastHeard).count() > config.farmTimeout) {
+                dropWorker(farm, i, w.ready ? "sin respuesta" : "sin HELLO");
+            }
+        }
+        if (farm.failed) {
+            ok = false;
+            break;
+        }
+
+        dispatchJobs(farm);
+
+        // Frames completos, en orden: la exposición de cada uno depende del anterior (como en --headless)
+        while (nextFlush < farm.frames.size() && farm.frames[nextFlush].pendingJobs == 0) {
+            TRACE_SCOPE("farmFlush");
+            FarmFrame& frame = farm.frames[nextFlush];
+            LuminanceStats lumStats = computeLuminanceStatsCPU(frame.rgb.data(), config.width * config.height,
+                                                               1.0f / exposure);
+            exposure = updateExposure(exposure, lumStats, cameraPath.fixedDt);
+            if (!config.outputDir.empty()) {
+                char name[64];
+                std::snprintf(name, sizeof(name), "/frame_%05zu.ppm", nextFlush);
+                writeImagePPM(config.outputDir + name, frame.rgb.data(), config.width, config.height, exposure);
+            }
+            std::vector<float>().swap(frame.rgb);
+            countMetric(MetricCounter::Frames);
+            nextFlush++;
+        }
+
+#ifndef _WIN32
+        // Si todos los trabajadores locales han muerto y no queda nadie conectado, no hay quien termine
+        for (pid_t& pid : children) {
+            if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+                pid = 0;
+                childrenAlive--;
+            }
+        }
+        bool anyConnected = false;
+        for (const FarmWorker& w : farm.workers) anyConnected |= w.socket != INVALID_NET_SOCKET;
+        if (!children.empty() && childrenAlive == 0 && !anyConnected && nextFlush < farm.frames.size()) {
+            std::cout << "ERROR: Todos los trabajadores locales han terminado sin completar la granja" << std::endl;
+            ok = false;
+            break;
+        }
+#endif
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (FarmWorker& worker : farm.workers) {
+        if (worker.socket == INVALID_NET_SOCKET) continue;
+        sendMessage(worker.socket, FARM_QUIT, nullptr, 0);
+        closeNetSocket(worker.socket);
+    }
+    closeNetSocket(listener);
+    netCleanup();
+#ifndef _WIN32
+    for (pid_t pid : children) {
+        if (pid > 0) waitpid(pid, nullptr, 0);
+    }
+#endif
+    if (!ok) return -1;
+
+    std::cout << "Granja: " << farm.frames.size() << " frames en " << seconds << " s ("
+              << farm.frames.size() / seconds << " frames/s), " << farm.rays / seconds / 1e6 << " Mrayos/s, "
+              << farm.retries << " trabajos reintentados" << std::endl;
+    for (size_t i = 0; i < farm.workers.size(); i++) {
+        const FarmWorker& worker = farm.workers[i];
+        std::cout << "  trabajador " << i << " (" << worker.threads << " hilos): " << worker.jobsDone
+                  << " trabajos, ocupado " << 100.0 * worker.busyMs / (seconds * 1000.0) << "%" << std::endl;
+    }
+    return 0;
+}
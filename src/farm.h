@@ -0,0 +1,24 @@
+#pragma once
+#include "config.h"
+
+// --- GRANJA DE RENDER ---
+// Un coordinador reparte un recorrido de cámara (--replay) en trabajos de
+// frames o teselas entre procesos trabajadores conectados por TCP, vuelve a
+// encolar los trabajos de trabajadores caídos o colgados y monta las imágenes
+// en orden, con la misma exposición automática que el modo sin ventana.
+// Los trabajadores usan el trazador de CPU (pueden correr en nodos sin GPU).
+//
+// Protocolo binario (little-endian): cabecera {magia "BHFM", tipo, bytes} y
+//   coordinador -> trabajador: SETUP (opciones del trazador), JOB, QUIT
+//   trabajador -> coordinador: HELLO (versión, hilos), RESULT (+ RGB float), HEARTBEAT
+// Un trabajador listo manda HEARTBEAT cada FARM_HEARTBEAT_S también mientras
+// traza: el coordinador lo da por colgado tras --farm-timeout segundos sin
+// oír nada de él, no por lo que tarde un trabajo (un póster puede tardar mucho).
+
+const double FARM_HEARTBEAT_S = 2.0;
+
+// --farm-coordinator PORT. exePath se usa para lanzar trabajadores locales (--farm-local N).
+int runFarmCoordinator(const AppConfig& config, const char* exePath);
+
+// --farm-worker HOST:PORT. Atiende trabajos hasta que el coordinador termina.
+int runFarmWorker(const AppConfig& config);
@@ -0,0 +1,60 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+// --- MATEMÁTICA RÁPIDA DEL TRAZADOR (--fast-math) ---
+// Aproximaciones sin llamadas a libm ni ramas (solo selecciones), para que el
+// compilador las pueda vectorizar. Error máximo medido con --bench-fast-math
+// sobre todo el dominio (float):
+//   fastRsqrt   error relativo < 3e-7      (rsqrtss + 1 paso de Newton; sin SSE, < 5e-6)
+//   fastAtan2   error absoluto < 2e-6 rad  (polinomio impar de grado 11 en [0, 1])
+//   fastAsin    error absoluto < 7e-5 rad  (Abramowitz-Stegun 4.4.45)
+// Mismas funciones en shaders/fast_math.glsl. Lo que ganan es sobre todo
+// quitar las llamadas a atan2/asin de libm (el cielo y el ángulo del disco).
+
+// 1 / sqrt(x), x > 0. Con SSE, la estimación de 12 bits de rsqrtss; si no, la
+// semilla por bits (y un paso de Newton más).
+inline float fastRsqrt(float x) {
+    float half = 0.5f * x;
+#if defined(__SSE__) || defined(_M_X64)
+    float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    return y * (1.5f - half * y * y);
+#else
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f375a86u - (bits >> 1);
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    return y;
+#endif
+}
+
+// atan2(y, x) en (-π, π]; (0, 0) da 0
+inline float fastAtan2(float y, float x) {
+    const float HALF_PI = 1.5707963f, PI = 3.14159265f;
+    float ax = std::fabs(x), ay = std::fabs(y);
+    float hi = ax > ay ? ax : ay;
+    float lo = ax > ay ? ay : ax;
+    float a = lo / (hi > 0.0f ? hi : 1.0f);
+    float s = a * a;
+    float r = a * (0.99997726f +
+                   s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+    r = ay > ax ? HALF_PI - r : r;
+    r = x < 0.0f ? PI - r : r;
+    return y < 0.0f ? -r : r;
+}
+
+// asin(x), x en [-1, 1]
+inline float fastAsin(float x) {
+    const float HALF_PI = 1.5707963f;
+    float a = std::fabs(x);
+    float p = ((-0.0187293f * a + 0.0742610f) * a - 0.2121144f) * a + 1.5707288f;
+    float r = HALF_PI - std::sqrt(1.0f - a) * p;
+    return x < 0.0f ? -r : r;
+}
@@ -0,0 +1,108 @@
+#include "frame_pacing.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+FramePacer createFramePacer(int framesInFlight) {
+    FramePacer pacer;
+    pacer.slots = framesInFlight;
+    pacer.fences.assign(framesInFlight, nullptr);
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    pacer.slotStride = ((GLsizeiptr)sizeof(FrameBlock) + alignment - 1) / alignment * alignment;
+    GLsizeiptr totalSize = pacer.slotStride * framesInFlight;
+
+    glGenBuffers(1, &pacer.ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, pacer.ubo);
+
+    if (GLAD_GL_ARB_buffer_storage) {
+        // Mapeo persistente y coherente: escribir es un memcpy, sin llamadas al driver
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, NULL, flags);
+        pacer.mapped = (unsigned char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags);
+    }
+    if (pacer.mapped == nullptr) {
+        // Sin buffer storage: mismo esquema de ranuras pero con glBufferSubData
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, NULL, GL_DYNAMIC_DRAW);
+        std::cout << "AVISO: Sin GL_ARB_buffer_storage, la cámara se sube con glBufferSubData" << std::endl;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return pacer;
+}
+
+void destroyFramePacer(FramePacer& pacer) {
+    for (GLsync& fence : pacer.fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (pacer.mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, pacer.ubo);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        pacer.mapped = nullptr;
+    }
+    glDeleteBuffers(1, &pacer.ubo);
+    pacer.ubo = 0;
+}
+
+void waitFrameSlot(FramePacer& pacer) {
+    GLsync& fence = pacer.fences[pacer.current];
+    if (!fence) return;
+
+    // Esperamos en bloques de 1 segundo; la primera vez forzamos el flush
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum result = glClientWaitSync(fence, flags, 1000000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) break;
+        if (result == GL_WAIT_FAILED) {
+            std::cout << "ERROR: glClientWaitSync ha fallado" << std::endl;
+            break;
+        }
+        flags = 0;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void writeFrameBlock(FramePacer& pacer, const FrameBlock& block) {
+    GLintptr offset = pacer.slotStride * pacer.current;
+    if (pacer.mapped) {
+        std::memcpy(pacer.mapped + offset, &block, sizeof(FrameBlock));
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, pacer.ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(FrameBlock), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, pacer.ubo, offset, sizeof(FrameBlock));
+}
+
+void endFrame(FramePacer& pacer) {
+    pacer.fences[pacer.current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pacer.current = (pacer.current + 1) % pacer.slots;
+}
+
+bool openLatencyLog(LatencyLog& log, const std::string& path) {
+    log.file.open(path);
+    if (!log.file) {
+        std::cout << "ERROR: No se pudo abrir el log de latencia: " << path << std::endl;
+        return false;
+    }
+    log.file << "frame,latency_ms\n";
+    return true;
+}
+
+void recordLatency(LatencyLog& log, double inputTime, double swapTime) {
+    double ms = (swapTime - inputTime) * 1000.0;
+    if (log.file) log.file << log.frame << "," << ms << "\n";
+    log.frame++;
+    log.sumMs += ms;
+    log.maxMs = std::max(log.maxMs, ms);
+}
+
+void printLatencySummary(const LatencyLog& log) {
+    if (log.frame == 0) return;
+    std::cout << "Latencia entrada->swap: media " << log.sumMs / log.frame << " ms, máxima "
+              << log.maxMs << " ms (" << log.frame << " frames)" << std::endl;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <glad/gl.h>
+#include <vector>
+#include <fstream>
+#include <string>
+
+// --- RITMO DE FRAMES Y CÁMARA "LATE-LATCHED" ---
+// La cámara se escribe en un uniform buffer mapeado de forma persistente
+// justo antes del dispatch del raytracing. El buffer tiene una ranura por
+// frame en vuelo, y cada ranura se protege con una fence: así la CPU nunca
+// se adelanta más de 'framesInFlight' frames a la GPU (menos latencia) y
+// nunca pisa datos que la GPU todavía está leyendo.
+
+// Debe coincidir con el bloque FrameBlock (std140, binding 0) de blackhole_common.glsl
+struct FrameBlock {
+    float camPos[3];     // vec3 u_camPos     (offset 0)
+    float time;          // float u_time      (offset 12)
+    float camRight[4];   // vec4 u_camRight   (offset 16)
+    float camUp[4];      // vec4 u_camUp      (offset 32)
+    float camForward[4]; // vec4 u_camForward (offset 48), w = distancia focal
+};
+
+struct FramePacer {
+    unsigned int ubo = 0;
+    int slots = 0;
+    GLsizeiptr slotStride = 0;          // Tamaño de ranura alineado a GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    unsigned char* mapped = nullptr;    // nullptr si no hay GL_ARB_buffer_storage
+    std::vector<GLsync> fences;
+    int current = 0;
+};
+
+FramePacer createFramePacer(int framesInFlight);
+void destroyFramePacer(FramePacer& pacer);
+
+// Espera a que la GPU libere la ranura del frame actual (límite de frames en vuelo)
+void waitFrameSlot(FramePacer& pacer);
+// Copia la cámara a la ranura actual y la conecta al binding 0
+void writeFrameBlock(FramePacer& pacer, const FrameBlock& block);
+// Coloca la fence de la ranura actual y avanza a la siguiente
+void endFrame(FramePacer& pacer);
+
+// --- MEDICIÓN DE LATENCIA (muestreo de entrada -> vuelta de glfwSwapBuffers) ---
+struct LatencyLog {
+    std::ofstream file;   // CSV opcional: frame,latency_ms
+    long frame = 0;
+    double sumMs = 0.0;
+    double maxMs = 0.0;
+};
+
+bool openLatencyLog(LatencyLog& log, const std::string& path);
+void recordLatency(LatencyLog& log, double inputTime, double swapTime);
+void printLatencySummary(const LatencyLog& log);
@@ -0,0 +1,733 @@
+#include <glad/gl.h>
+#include "gl_renderer.h"
+#include "cpu_tracer.h"
+#include "disk_noise.h"
+#include "metrics.h"
+#include "skybox_cache.h"
+#include "skybox_cube.h"
+#include "thread_pool.h"
+#include "stb_image.h" // La implementación se compila en cpu_tracer.cpp
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Ruta de un shader dentro de la carpeta configurada (con o sin barra final)
+static std::string shaderPath(const std::string& dir, const char* name) {
+    if (dir.empty() || dir.back() == '/' || dir.back() == '\\') return dir + name;
+    return dir + "/" + name;
+}
+
+// Función auxiliar para leer y compilar shaders
+static unsigned int createShaderProgram(const char* vertexPath, const char* fragmentPath) {
+    TRACE_SCOPE("createShaderProgram");
+    // 1. Recuperar el código fuente de los archivos
+    std::string vertexCode;
+    std::string fragmentCode;
+    std::ifstream vShaderFile;
+    std::ifstream fShaderFile;
+
+    // Asegurar que los objetos ifstream pueden lanzar excepciones
+    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    try {
+        // Abrir archivos
+        vShaderFile.open(vertexPath);
+        fShaderFile.open(fragmentPath);
+        std::stringstream vShaderStream, fShaderStream;
+        // Leer buffer del archivo al stream
+        vShaderStream << vShaderFile.rdbuf();
+        fShaderStream << fShaderFile.rdbuf();
+        // Cerrar manejadores de archivo
+        vShaderFile.close();
+        fShaderFile.close();
+        // Convertir stream a string
+        vertexCode = vShaderStream.str();
+        fragmentCode = fShaderStream.str();
+    }
+    catch (std::ifstream::failure& e) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        return 0;
+    }
+
+    const char* vShaderCode = vertexCode.c_str();
+    const char* fShaderCode = fragmentCode.c_str();
+
+    // 2. Compilar shaders
+    unsigned int vertex, fragment;
+    int success;
+    char infoLog[512];
+
+    // Vertex Shader
+    vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vShaderCode, NULL);
+    glCompileShader(vertex);
+    // Imprimir errores de compilación si los hay
+    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+
+    // Fragment Shader
+    fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fShaderCode, NULL);
+    glCompileShader(fragment);
+    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+
+    // Shader Program
+    unsigned int ID = glCreateProgram();
+    glAttachShader(ID, vertex);
+    glAttachShader(ID, fragment);
+    glLinkProgram(ID);
+    // Imprimir errores de linkado
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(ID, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    // Borrar los shaders ya que están linkados en el programa y ya no son necesarios
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    return ID;
+}
+
+// Lee un shader resolviendo las líneas #include "fichero" (relativas a su carpeta).
+// GLSL no tiene includes: así varios compute shaders comparten el mismo trazador.
+static bool readShaderSource(const std::string& path, std::string& out, int depth = 0) {
+    if (depth > 8) {
+        std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << path << std::endl;
+        return false;
+    }
+
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return false;
+    }
+
+    std::string directory;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos) directory = path.substr(0, slash + 1);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start);
+            size_t close = line.find('"', open + 1);
+            if (open == std::string::npos || close == std::string::npos) {
+                std::cout << "ERROR::SHADER::BAD_INCLUDE: " << line << std::endl;
+                return false;
+            }
+            if (!readShaderSource(directory + line.substr(open + 1, close - open - 1), out, depth + 1)) return false;
+            continue;
+        }
+        out += line;
+        out += '\n';
+    }
+    return true;
+}
+
+// 'defines' (p. ej. "#define KERR\n") se inserta tras la línea #version: permutaciones del mismo shader
+static unsigned int createComputeShaderProgram(const std::string& computePath, const std::string& defines = "") {
+    TRACE_SCOPE("createComputeShaderProgram");
+    // 1. Leer el archivo (con sus #include)
+    std::string computeCode;
+    if(!readShaderSource(computePath, computeCode)){
+        return 0;
+    }
+    if (!defines.empty()) {
+        size_t versionEnd = computeCode.find('\n', computeCode.find("#version"));
+        computeCode.insert(versionEnd == std::string::npos ? 0 : versionEnd + 1, defines);
+    }
+    const char* cShaderCode = computeCode.c_str();
+
+    // 2. Compilar (GL_COMPUTE_SHADER)
+    unsigned int computeShader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(computeShader, 1, &cShaderCode, NULL);
+    glCompileShader(computeShader);
+
+    // Comprobar errores
+    int success;
+    char infoLog[512];
+    glGetShaderiv(computeShader, GL_COMPILE_STATUS, &success);
+    if(!success){
+        glGetShaderInfoLog(computeShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+    }
+
+    // 3. Crear programa
+    unsigned int shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, computeShader);
+    glLinkProgram(shaderProgram);
+
+    // Comprobar errores de linkado
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if(!success){
+        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::COMPUTE::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    glDeleteShader(computeShader);
+
+    return shaderProgram;
+}
+
+static unsigned int loadTexture(const char* path) {
+    TRACE_SCOPE("loadTexture");
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    // stb_image carga la imagen. "0" fuerza a mantener los canales originales.
+    int64_t decodeStart = traceNowUs();
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    addTraceEvent("stbi_load", decodeStart, traceNowUs() - decodeStart);
+
+    if (data) {
+        GLenum format = GL_RGB;
+        if (nrComponents == 1) format = GL_RED;
+        else if (nrComponents == 3) format = GL_RGB;
+        else if (nrComponents == 4) format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        // Las filas RGB de stb_image no tienen relleno: con la alineación por defecto (4)
+        // cualquier ancho que no sea múltiplo de 4 desplaza cada fila y mezcla los canales
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        // Subimos los datos a la GPU
+        int64_t uploadStart = traceNowUs();
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        addTraceEvent("glTexImage2D+mipmaps", uploadStart, traceNowUs() - uploadStart);
+
+        // Configuración de envoltorio (Wrapping)
+        // GL_REPEAT es crucial para que el cielo sea continuo si giramos 360 grados
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Evita artefactos en los polos
+
+        // Filtrado lineal para que no se vea pixelado
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data); // Liberamos la memoria RAM (ya está en VRAM)
+        std::cout << "Textura cargada correctamente: " << path << std::endl;
+    } else {
+        std::cout << "ERROR: No se pudo cargar la textura: " << path << std::endl;
+        stbi_image_free(data);
+        glDeleteTextures(1, &textureID);
+        textureID = 0;
+    }
+
+    return textureID;
+}
+
+// Copia la base de la cámara al FrameBlock del shader
+static void writeCameraBasis(FrameBlock& block, const CameraBasis& basis) {
+    const vec3* axes[3] = {&basis.right, &basis.up, &basis.forward};
+    float* dest[3] = {block.camRight, block.camUp, block.camForward};
+    for (int i = 0; i < 3; i++) {
+        dest[i][0] = axes[i]->x;
+        dest[i][1] = axes[i]->y;
+        dest[i][2] = axes[i]->z;
+        dest[i][3] = 0.0f;
+    }
+    block.camForward[3] = basis.focal;
+}
+
+// Permutación de los shaders del trazador: --kerr / --analytic compilan otro motor en lugar del pseudo-newtoniano,
+// --fast-math cambia las funciones de la aceleración, el disco y el cielo por las de fast_math.glsl
+static std::string tracerDefinesFor(const AppConfig& config, bool lenses) {
+    std::string tracerDefines = config.kerr ? "#define KERR\n" : config.analytic ? "#define ANALYTIC\n" : "";
+    if (config.fastMath) tracerDefines += "#define FAST_MATH\n";
+    // --charge / --lambda: los horizontes se calculan aquí (spacetime.h) y llegan como constantes
+    if (config.charge != 0.0f || config.lambda != 0.0f) {
+        float horizon, escape;
+        spacetimeHorizons(spacetimeFor(config.charge, config.lambda), RS, config.charge, config.lambda, horizon, escape);
+        std::ostringstream defines;
+        defines << std::showpoint << std::setprecision(9) << "#define METRIC_HORIZON " << horizon << "\n";
+        if (config.charge != 0.0f) defines << "#define METRIC_CHARGE " << config.charge << "\n";
+        if (config.lambda != 0.0f) defines << "#define METRIC_ESCAPE " << escape << "\n";
+        tracerDefines += defines.str();
+    }
+    if (lenses) tracerDefines += "#define LENSES\n"; // Las lentes llegan en SSBO (lenses.h)
+    if (!config.rayClasses) tracerDefines += "#define NO_RAY_CLASSES\n";
+    if (config.diskOpacity < 1.0f) {
+        std::ostringstream defines;
+        defines << std::showpoint << std::setprecision(9) << "#define DISK_OPACITY " << config.diskOpacity << "\n"
+                << "#define DISK_ORDERS " << config.diskOrders << "\n";
+        tracerDefines += defines.str();
+    }
+    return tracerDefines;
+}
+
+// Unidades de textura y constantes de los programas que incluyen blackhole_common.glsl
+static void configureTracerProgram(const GlRenderer& renderer, unsigned int program) {
+    glUseProgram(program);
+    // Le decimos al shader que la variable "skybox" leerá de la Unidad de Textura 0
+    glUniform1i(glGetUniformLocation(program, "skybox"), 0);
+    // El cubemap va en la unidad 2 (la 1 es la del mapa de entorno lensado)
+    glUniform1i(glGetUniformLocation(program, "skyboxCube"), 2);
+    glUniform1i(glGetUniformLocation(program, "u_skyboxCube"), renderer.skyboxCubeTexture != 0);
+    glUniform1i(glGetUniformLocation(program, "diskNoise"), 3);
+    glUniform2f(glGetUniformLocation(program, "u_diskNoisePeriod"), DISK_NOISE_PERIOD_U, DISK_NOISE_PERIOD_V);
+    glUniform1f(glGetUniformLocation(program, "u_kerrSpin"), renderer.kerrSpin);
+}
+
+// Un par de programas del trazador (adaptativo, entrelazado) listos para usar
+static bool loadTracerPair(GlRenderer& renderer, const char* first, const char* second, unsigned int& firstProgram,
+                           unsigned int& secondProgram) {
+    firstProgram = createComputeShaderProgram(shaderPath(renderer.shaderDir, first), renderer.tracerDefines);
+    secondProgram = createComputeShaderProgram(shaderPath(renderer.shaderDir, second), renderer.tracerDefines);
+    if (firstProgram == 0 || secondProgram == 0) return false;
+    configureTracerProgram(renderer, firstProgram);
+    configureTracerProgram(renderer, secondProgram);
+    return true;
+}
+
+bool createGlRenderer(GlRenderer& renderer, const AppConfig& config, const std::shared_ptr<const LensField>& lensField,
+                      int width, int height) {
+    TRACE_SCOPE("createGlRenderer");
+    renderer.shaderDir = config.shaderDir;
+    renderer.kerrSpin = config.kerrSpin;
+    renderer.envMapSize = config.envMapSize;
+    renderer.envMapSupported = config.diskOpacity >= 1.0f;
+
+    // Shader de pantalla "simple" que solo muestra la textura del compute shader
+    renderer.screenProgram = createShaderProgram(shaderPath(config.shaderDir, "vertex_core.glsl").c_str(),
+                                                 shaderPath(config.shaderDir, "fragment_screen.glsl").c_str());
+    if (renderer.screenProgram == 0) {
+        std::cerr << "ERROR: No se pudo cargar screenProgram" << std::endl;
+        return false;
+    }
+    std::cout << "✓ Screen shaders cargados correctamente" << std::endl;
+
+    //DEFINE EL LIENZO (Pantalla completa cuádruple)
+    //Dos triángulos que cubren toda la pantalla de -1 a 1
+    float vertices[] = {
+        //posiciones (x, y)
+        -1.0f, 1.0f,  //Arriba a la izquierda
+        -1.0f, -1.0f,  //Abajo a la izquierda
+        1.0f, -1.0f,   //Abajo a la derecha
+
+        -1.0f, 1.0f,  //Arriba a la izquierda
+        1.0f, -1.0f,  //Abajo a la derecha
+        1.0f, 1.0f,   //Arriba a la derecha
+    };
+
+    //CONFIGURAR BUFFERS
+    glGenVertexArrays(1, &renderer.vao);
+    glGenBuffers(1, &renderer.vbo);
+
+    glBindVertexArray(renderer.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    //Indica a OpenGL cómo leer los atributos (solo posición: 2 flotantes)
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    renderer.tracerDefines = tracerDefinesFor(config, lensField != nullptr);
+    const std::string& tracerDefines = renderer.tracerDefines;
+
+    // 1. Cargar el Compute Shader (El "Cerebro" matemático)
+    renderer.computeProgram = createComputeShaderProgram(shaderPath(config.shaderDir, "raytracing.glsl"), tracerDefines);
+    if (renderer.computeProgram == 0) {
+        std::cerr << "ERROR: No se pudo cargar computeProgram" << std::endl;
+        return false;
+    }
+    std::cout << "✓ Compute shader cargado correctamente" << std::endl;
+
+    // Cargar el shader de desenfoque (Bloom)
+    renderer.blurProgram = createComputeShaderProgram(shaderPath(config.shaderDir, "blur.glsl"));
+    if (renderer.blurProgram == 0) {
+        std::cerr << "ERROR: No se pudo cargar blurProgram" << std::endl;
+        return false;
+    }
+    std::cout << "✓ Blur shader cargado correctamente" << std::endl;
+
+    // Reducción de luminancia (exposición automática y decisión de bloom)
+    renderer.luminanceProgram = createComputeShaderProgram(shaderPath(config.shaderDir, "luminance.glsl"));
+    if (renderer.luminanceProgram == 0) {
+        std::cerr << "ERROR: No se pudo cargar luminanceProgram" << std::endl;
+        return false;
+    }
+    std::cout << "✓ Luminance shader cargado correctamente" << std::endl;
+
+    // Modo 360°: horneado del cubemap de resultados y vista por búsqueda
+    renderer.envBakeProgram = createComputeShaderProgram(shaderPath(config.shaderDir, "envmap_bake.glsl"), tracerDefines);
+    renderer.envViewProgram = createComputeShaderProgram(shaderPath(config.shaderDir, "envmap_view.glsl"), tracerDefines);
+    if (renderer.envBakeProgram == 0 || renderer.envViewProgram == 0) {
+        std::cerr << "ERROR: No se pudieron cargar los shaders del mapa de entorno" << std::endl;
+        return false;
+    }
+    std::cout << "✓ Envmap shaders cargados correctamente" << std::endl;
+
+    // El cubemap (~100 MB a 1024) solo se reserva la primera vez que se usa el modo
+    renderer.lumBuffers = createLuminanceBuffers();
+
+    // 2. Crear la Textura de Cómputo (El "Papel" donde escribirá)
+    // Ambas salen de un pool que reserva con margen para que redimensionar no reasigne cada frame
+    renderer.width = width;
+    renderer.height = height;
+    resizeRenderTarget(renderer.targetPool, renderer.computeTarget, width, height);
+    resizeRenderTarget(renderer.targetPool, renderer.blurTarget, width, height);
+
+    // 1. Cargar la textura del cielo
+    // Por defecto se remuestrea a cubemap (en paralelo) y los shaders buscan por dirección.
+    // Con --skybox-equirect: la caché preprocesada (.bhsky, mapeada y sin decodificar) o la imagen.
+    const std::string& skyboxPath = config.skyboxPath;
+    // Pool temporal para las conversiones de arranque (cielo y ruido del disco)
+    ThreadPool startupPool;
+    startThreadPool(startupPool, config.threads);
+    if (!config.equirectSkybox) {
+        CubeSkybox cube;
+        if (buildCubeSkybox(skyboxPath, config.skyboxFaceSize, startupPool, cube)) {
+            renderer.skyboxCubeTexture = uploadCubeSkybox(cube);
+        }
+    }
+    // Ruido del disco: se hornea una vez y los shaders solo leen la textura
+    DiskNoise diskNoise;
+    bakeDiskNoise(diskNoise, config.diskNoiseSize, config.diskNoiseSize, config.diskOctaves, startupPool);
+    renderer.diskNoiseTexture = uploadDiskNoise(diskNoise);
+    diskNoise.values.clear();
+    stopThreadPool(startupPool);
+    if (lensField) uploadLensField(*lensField, renderer.lensBuffers);
+
+    if (renderer.skyboxCubeTexture == 0) {
+        renderer.skyboxTexture = loadSkyboxCache(skyboxCachePath(skyboxPath), skyboxPath);
+        if (renderer.skyboxTexture == 0) renderer.skyboxTexture = loadTexture(skyboxPath.c_str());
+        if (renderer.skyboxTexture == 0) return false;
+    }
+
+    // 2. Configurar los shaders para usarla (todos los que incluyen blackhole_common.glsl)
+    for (unsigned int program : {renderer.computeProgram, renderer.envBakeProgram, renderer.envViewProgram}) {
+        configureTracerProgram(renderer, program);
+    }
+
+    // Muestreo adaptativo (--adaptive N): rejilla dispersa + refinado en los bordes
+    if (config.adaptiveStep > 1 && !setGlAdaptive(renderer, config.adaptiveStep, config.adaptiveThreshold)) return false;
+
+    // Render entrelazado (--interleave 2|4): una fase del patrón por frame + reconstrucción
+    if (config.interleave > 0) {
+        if (!loadTracerPair(renderer, "interleave_trace.glsl", "interleave_resolve.glsl",
+                            renderer.interleaveTraceProgram, renderer.interleaveResolveProgram)) {
+            std::cerr << "ERROR: No se pudieron cargar los shaders del render entrelazado" << std::endl;
+            return false;
+        }
+        std::cout << "✓ Interleave shaders cargados correctamente" << std::endl;
+        renderer.interleaved = createInterleavedRenderer(config.interleave);
+    }
+
+    renderer.pacer = createFramePacer(config.framesInFlight);
+    return true;
+}
+
+bool setGlAdaptive(GlRenderer& renderer, int step, float threshold) {
+    if (renderer.adaptive.step > 1) destroyAdaptiveSampler(renderer.adaptive, renderer.targetPool);
+    renderer.adaptive = AdaptiveSampler();
+    if (step <= 1) return true;
+    if (renderer.adaptiveCoarseProgram == 0) {
+        if (!loadTracerPair(renderer, "adaptive_coarse.glsl", "adaptive_refine.glsl",
+                            renderer.adaptiveCoarseProgram, renderer.adaptiveRefineProgram)) {
+            std::cerr << "ERROR: No se pudieron cargar los shaders del muestreo adaptativo" << std::endl;
+            return false;
+        }
+        std::cout << "✓ Adaptive shaders cargados correctamente" << std::endl;
+    }
+    renderer.adaptive = createAdaptiveSampler(step, threshold);
+    return true;
+}
+
+void waitGlFrameSlot(GlRenderer& renderer) {
+    waitFrameSlot(renderer.pacer);
+}
+
+bool traceGlImage(GlRenderer& renderer, const CameraState& camera, float time, int width, int height,
+                  bool envMapMode) {
+    GlRenderer& r = renderer;
+    bool again = false;
+
+    // --- AJUSTE DE TEXTURAS ---
+    // Solo se reasignan si el nuevo tamaño supera la capacidad de su cubeta;
+    // si no, basta con cambiar el sub-rectángulo activo.
+    if (width != r.width || height != r.height) {
+        r.width = width;
+        r.height = height;
+        resizeRenderTarget(r.targetPool, r.computeTarget, width, height);
+        resizeRenderTarget(r.targetPool, r.blurTarget, width, height);
+    }
+
+    if (r.queryGpuTime) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        r.pendingGpuQueries.push_back(query);
+    }
+    beginGpuTraceFrame(r.gpuTrace);
+    int64_t dispatchStart = traceNowUs();
+
+    // --- FASE DE CÓMPUTO ---
+    glUseProgram(r.computeProgram);
+
+    // Tiempo (para la animación del disco), posición y orientación de la cámara al uniform buffer
+    FrameBlock frameBlock = {};
+    frameBlock.camPos[0] = camera.x;
+    frameBlock.camPos[1] = camera.y;
+    frameBlock.camPos[2] = camera.z;
+    frameBlock.time = time;
+    writeCameraBasis(frameBlock, computeCameraBasis(camera));
+    writeFrameBlock(r.pacer, frameBlock);
+
+    // ACTIVAR LA TEXTURA DEL CIELO
+    glActiveTexture(GL_TEXTURE0); // Activamos la unidad 0
+    glBindTexture(GL_TEXTURE_2D, r.skyboxTexture); // Ponemos nuestra foto ahí
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, r.skyboxCubeTexture);
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, r.diskNoiseTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Modo 360°: mientras la cámara se traslada trazamos directamente; en cuanto
+    // se para, horneamos el cubemap una vez y a partir de ahí solo buscamos.
+    bool useEnvMap = false;
+    if (envMapMode && r.envMapSupported) {
+        if (r.envMap.texture == 0) r.envMap = createEnvMapCache(r.envMapSize);
+
+        bool translating = r.envMap.valid && !envMapMatches(r.envMap, camera.x, camera.y, camera.z) &&
+                           (camera.x != r.lastTracedCam[0] || camera.y != r.lastTracedCam[1] ||
+                            camera.z != r.lastTracedCam[2]);
+        if (!envMapMatches(r.envMap, camera.x, camera.y, camera.z)) {
+            if (translating) again = true; // Hornearemos cuando se detenga
+            else {
+                bakeEnvMap(r.envMap, r.envBakeProgram, camera.x, camera.y, camera.z);
+                countMetric(MetricCounter::GpuRays, 6ull * r.envMap.faceSize * r.envMap.faceSize);
+            }
+        }
+        useEnvMap = envMapMatches(r.envMap, camera.x, camera.y, camera.z);
+    }
+    r.lastTracedCam[0] = camera.x;
+    r.lastTracedCam[1] = camera.y;
+    r.lastTracedCam[2] = camera.z;
+
+    if (useEnvMap) {
+        renderFromEnvMap(r.envMap, r.envViewProgram, r.computeTarget.texture, width, height);
+        invalidateInterleaveHistory(r.interleaved);
+    } else if (r.interleaved.factor > 0) {
+        uint64_t traced = dispatchInterleaved(r.interleaved, r.targetPool, r.interleaveTraceProgram,
+                                              r.interleaveResolveProgram, r.computeTarget.texture, width, height,
+                                              camera);
+        countMetric(MetricCounter::GpuRays, traced);
+        // Con la cámara quieta seguimos trazando fases hasta completar la imagen
+        if (!interleaveComplete(r.interleaved)) again = true;
+    } else if (r.adaptive.step > 1) {
+        dispatchAdaptive(r.adaptive, r.targetPool, r.adaptiveCoarseProgram, r.adaptiveRefineProgram,
+                         r.computeTarget.texture, width, height);
+        // Los rayos refinados se cuentan al leer el contador (un frame después)
+        countMetric(MetricCounter::GpuRays, readAdaptiveStats(r.adaptive, false));
+    } else {
+        glUseProgram(r.computeProgram);
+
+        // El pase de blur deja la unidad 0 en solo lectura: la volvemos a conectar para escribir
+        glBindImageTexture(0, r.computeTarget.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glUniform2i(glGetUniformLocation(r.computeProgram, "u_viewport"), width, height);
+
+        // ¡LANZAMIENTO!
+        glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+        countMetric(MetricCounter::GpuRays, (uint64_t)width * height);
+    }
+    addTraceEvent(useEnvMap ? "envmapLookup" : "traceDispatch", dispatchStart, traceNowUs() - dispatchStart);
+    markGpuTrace(r.gpuTrace, useEnvMap ? "envmapLookup" : "trace");
+
+    // --- BARRERA DE MEMORIA (CRÍTICO) ---
+    // Esto le dice a la GPU: "No empieces a dibujar píxeles (Fragment Shader)
+    // hasta que el Compute Shader haya terminado de escribir en la textura".
+    // Sin esto, verías parpadeos o basura porque leerías la textura mientras se escribe.
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    return again;
+}
+
+bool presentGlImage(GlRenderer& renderer, float dt) {
+    GlRenderer& r = renderer;
+    bool again = false;
+
+    // --- FASE 1.5: ESTADÍSTICAS DE LUMINANCIA ---
+    // Un píxel "brilla" si tras la exposición supera 1.0 en pantalla
+    float bloomThreshold = 1.0f / r.exposure;
+    dispatchLuminance(r.lumBuffers, r.luminanceProgram, r.computeTarget.texture, r.width, r.height, bloomThreshold);
+
+    markGpuTrace(r.gpuTrace, "luminance");
+
+    // Usamos las estadísticas del frame anterior (ya terminado) para no bloquear la GPU
+    LuminanceStats lumStats;
+    int64_t readbackStart = traceNowUs();
+    bool haveLumStats = readLuminanceStats(r.lumBuffers, lumStats);
+    addTraceEvent("readLuminanceStats", readbackStart, traceNowUs() - readbackStart);
+    if (haveLumStats) {
+        float previousExposure = r.exposure;
+        r.exposure = updateExposure(r.exposure, lumStats, dt);
+        // Mientras la exposición se adapta, seguimos dibujando aunque la escena esté quieta
+        if (std::fabs(r.exposure - previousExposure) > 0.01f * previousExposure) again = true;
+
+        BloomMode newMode = chooseBloomMode(lumStats);
+        if (newMode != r.bloomMode) {
+            const char* names[] = {"desactivado", "media resolución", "resolución completa"};
+            std::cout << "Bloom: " << names[(int)newMode] << " (" << lumStats.brightFraction * 100.0f
+                      << "% píxeles brillantes)" << std::endl;
+        }
+        r.bloomMode = newMode;
+    } else {
+        // Aún no hay estadísticas (primer frame): hace falta otro para fijar la exposición
+        again = true;
+    }
+
+    // --- FASE 2: POST-PROCESADO (BLOOM / BLUR) ---
+    // Si casi nada supera el umbral, nos ahorramos el pase entero
+    int bloomDownsample = (r.bloomMode == BloomMode::Half) ? 2 : 1;
+    if (r.bloomMode != BloomMode::Off) {
+        glUseProgram(r.blurProgram);
+        glUniform1i(glGetUniformLocation(r.blurProgram, "u_downsample"), bloomDownsample);
+        glUniform1f(glGetUniformLocation(r.blurProgram, "u_threshold"), bloomThreshold);
+        glUniform2i(glGetUniformLocation(r.blurProgram, "u_viewport"), r.width, r.height);
+
+        // A. Conectar Entrada (La imagen nítida que acabamos de calcular)
+        // Binding 0 = Lectura (GL_READ_ONLY) -> computeTexture
+        glBindImageTexture(0, r.computeTarget.texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+
+        // B. Conectar Salida (El lienzo vacío para la imagen borrosa)
+        // Binding 1 = Escritura (GL_WRITE_ONLY) -> blurTexture
+        glBindImageTexture(1, r.blurTarget.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+        // C. ¡Lanzamiento! A media resolución solo cubrimos la esquina reducida
+        int bloomWidth = (r.width + bloomDownsample - 1) / bloomDownsample;
+        int bloomHeight = (r.height + bloomDownsample - 1) / bloomDownsample;
+        glDispatchCompute((bloomWidth + 7) / 8, (bloomHeight + 7) / 8, 1);
+
+        // D. Barrera de Memoria
+        // Esperamos a que el desenfoque termine antes de dibujar en pantalla
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        markGpuTrace(r.gpuTrace, "bloom");
+    }
+
+    // --- 3. DIBUJAR EN PANTALLA (Render Pass) ---
+    // Limpiamos la pantalla normal
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Activamos el shader "tonto"
+    glUseProgram(r.screenProgram);
+
+    // Conectamos la textura que rellenó el Compute Shader
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, r.computeTarget.texture);
+
+    // Le decimos al sampler (texOutput) que lea de la ranura 0
+    glUniform1i(glGetUniformLocation(r.screenProgram, "texBase"), 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, r.blurTarget.texture);
+    glUniform1i(glGetUniformLocation(r.screenProgram, "texBloom"), 1);
+
+    glUniform1f(glGetUniformLocation(r.screenProgram, "u_exposure"), r.exposure);
+    glUniform1f(glGetUniformLocation(r.screenProgram, "u_bloomStrength"), r.bloomMode == BloomMode::Off ? 0.0f : 1.0f);
+    // Solo mostramos el sub-rectángulo activo de cada textura del pool
+    glUniform2f(glGetUniformLocation(r.screenProgram, "u_baseUVScale"),
+                renderTargetUVScaleX(r.computeTarget), renderTargetUVScaleY(r.computeTarget));
+    glUniform2f(glGetUniformLocation(r.screenProgram, "u_bloomUVScale"),
+                renderTargetUVScaleX(r.blurTarget) / bloomDownsample, renderTargetUVScaleY(r.blurTarget) / bloomDownsample);
+
+    // Dibujamos el cuadrado de siempre
+    glBindVertexArray(r.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    markGpuTrace(r.gpuTrace, "screen");
+
+    if (r.queryGpuTime) glEndQuery(GL_TIME_ELAPSED);
+    return again;
+}
+
+void readGlImage(GlRenderer& renderer, int x0, int y0, int w, int h, float* rgb) {
+    if (renderer.queryGpuTime) glEndQuery(GL_TIME_ELAPSED);
+    // imageStore -> glReadPixels: la lectura pasa por el framebuffer
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+    if (renderer.readFramebuffer == 0) glGenFramebuffers(1, &renderer.readFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderer.readFramebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.computeTarget.texture, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4); // Filas de 3 floats por píxel: siempre múltiplo de 4 bytes
+    glReadPixels(x0, y0, w, h, GL_RGB, GL_FLOAT, rgb);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+// Lee los tiempos de GPU de los frames anteriores; con 'wait' espera a los que falten
+static void collectGpuQueries(GlRenderer& renderer, bool wait) {
+    while (!renderer.pendingGpuQueries.empty()) {
+        unsigned int query = renderer.pendingGpuQueries.front();
+        GLint available = 0;
+        if (!wait) {
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+        }
+        GLuint64 gpuNs = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuNs);
+        glDeleteQueries(1, &query);
+        renderer.pendingGpuQueries.pop_front();
+
+        observeMetric(MetricHistogram::FrameGpu, gpuNs / 1.0e9);
+        if (renderer.keepGpuTimes) renderer.gpuFrameMs.push_back(gpuNs / 1.0e6);
+    }
+    setMetricGauge(MetricGauge::FramesQueued, (int64_t)renderer.pendingGpuQueries.size());
+}
+
+void endGlFrame(GlRenderer& renderer) {
+    endFrame(renderer.pacer);
+    if (renderer.queryGpuTime) collectGpuQueries(renderer, false);
+    collectGpuTrace(renderer.gpuTrace, false);
+}
+
+void flushGlRenderer(GlRenderer& renderer) {
+    collectGpuQueries(renderer, true);
+    if (renderer.adaptive.step > 1) countMetric(MetricCounter::GpuRays, readAdaptiveStats(renderer.adaptive, true));
+    collectGpuTrace(renderer.gpuTrace, true);
+}
+
+void printGlRendererStats(const GlRenderer& renderer) {
+    printRenderTargetStats(renderer.targetPool);
+    printAdaptiveStats(renderer.adaptive);
+    printInterleaveStats(renderer.interleaved);
+    if (renderer.envMap.texture != 0) printEnvMapStats(renderer.envMap);
+}
+
+void destroyGlRenderer(GlRenderer& renderer) {
+    GlRenderer& r = renderer;
+    if (r.pacer.ubo != 0) destroyFramePacer(r.pacer);
+    if (r.envMap.texture != 0) destroyEnvMapCache(r.envMap);
+    releaseRenderTarget(r.targetPool, r.computeTarget);
+    releaseRenderTarget(r.targetPool, r.blurTarget);
+    destroyAdaptiveSampler(r.adaptive, r.targetPool);
+    destroyInterleavedRenderer(r.interleaved, r.targetPool);
+    destroyRenderTargetPool(r.targetPool);
+    destroyLuminanceBuffers(r.lumBuffers);
+
+    for (unsigned int query : r.pendingGpuQueries) glDeleteQueries(1, &query);
+    r.pendingGpuQueries.clear();
+    unsigned int programs[] = {r.computeProgram, r.blurProgram, r.luminanceProgram, r.screenProgram,
+                               r.envBakeProgram, r.envViewProgram, r.adaptiveCoarseProgram,
+                               r.adaptiveRefineProgram, r.interleaveTraceProgram, r.interleaveResolveProgram};
+    for (unsigned int program : programs) {
+        if (program != 0) glDeleteProgram(program);
+    }
+    unsigned int textures[] = {r.skyboxTexture, r.skyboxCubeTexture, r.diskNoiseTexture};
+    glDeleteTextures(3, textures);
+    if (r.lensBuffers[0] != 0) glDeleteBuffers(2, r.lensBuffers);
+    if (r.readFramebuffer != 0) glDeleteFramebuffers(1, &r.readFramebuffer);
+    if (r.vao != 0) glDeleteVertexArrays(1, &r.vao);
+    if (r.vbo != 0) glDeleteBuffers(1, &r.vbo);
+    r = GlRenderer();
+}
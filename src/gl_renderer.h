@@ -0,0 +1,105 @@
+#pragma once
+#include "config.h"
+#include "camera.h"
+#include "adaptive.h"
+#include "envmap.h"
+#include "frame_pacing.h"
+#include "hdr.h"
+#include "interleave.h"
+#include "lenses.h"
+#include "render_targets.h"
+#include "trace.h"
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --- TRAZADOR DE GPU (OPENGL) ---
+// Todo el pipeline de la ventana sin la ventana: shaders, cielo, ruido del disco,
+// render targets, exposición, bloom y ritmo de frames. Quien lo use pone el
+// contexto GL (ya cargado con glad) y decide cuándo trazar; la ventana (main.cpp)
+// y la API en C (bhsim.h) son clientes de este módulo.
+//
+// Un frame: waitGlFrameSlot -> traceGlImage -> presentGlImage o readGlImage -> endGlFrame.
+
+struct GlRenderer {
+    // Programas (los del trazador comparten blackhole_common.glsl y sus #define)
+    unsigned int computeProgram = 0;
+    unsigned int blurProgram = 0;
+    unsigned int luminanceProgram = 0;
+    unsigned int screenProgram = 0;
+    unsigned int envBakeProgram = 0, envViewProgram = 0;
+    unsigned int adaptiveCoarseProgram = 0, adaptiveRefineProgram = 0;
+    unsigned int interleaveTraceProgram = 0, interleaveResolveProgram = 0;
+    std::string shaderDir;
+    std::string tracerDefines;
+
+    // Recursos de la escena
+    unsigned int vao = 0, vbo = 0;
+    unsigned int skyboxTexture = 0;
+    unsigned int skyboxCubeTexture = 0;
+    unsigned int diskNoiseTexture = 0;
+    unsigned int lensBuffers[2] = {0, 0};
+    unsigned int readFramebuffer = 0; // Solo para readGlImage
+    float kerrSpin = 0.0f;
+    int envMapSize = ENVMAP_DEFAULT_SIZE;
+    // El cubemap guarda un único resultado por dirección: con el disco semitransparente
+    // (DISK_OPACITY) se perderían su emisión y su transmitancia, así que no se usa
+    bool envMapSupported = true;
+
+    // Imagen y post-procesado
+    RenderTargetPool targetPool;
+    RenderTarget computeTarget;
+    RenderTarget blurTarget;
+    int width = 0, height = 0;
+    EnvMapCache envMap;
+    LuminanceBuffers lumBuffers;
+    AdaptiveSampler adaptive;
+    InterleavedRenderer interleaved;
+    float exposure = 1.0f;
+    BloomMode bloomMode = BloomMode::Full;
+    float lastTracedCam[3] = {0.0f, 0.0f, 0.0f}; // Para saber si la cámara se está trasladando
+
+    // Uniform buffer de la cámara con una ranura (y una fence) por frame en vuelo
+    FramePacer pacer;
+
+    // Tiempo de GPU por frame: una query GL_TIME_ELAPSED que se lee cuando ya está lista
+    bool queryGpuTime = false;
+    bool keepGpuTimes = false;         // Guardar cada tiempo en gpuFrameMs (informe de la reproducción)
+    std::deque<unsigned int> pendingGpuQueries;
+    std::vector<double> gpuFrameMs;
+    GpuTrace gpuTrace;
+};
+
+// Compila los shaders de config.shaderDir y carga config.skyboxPath con el contexto actual.
+// false si falta algún recurso (ya se ha informado por consola); destroyGlRenderer libera lo creado.
+bool createGlRenderer(GlRenderer& renderer, const AppConfig& config, const std::shared_ptr<const LensField>& lensField,
+                      int width, int height);
+void destroyGlRenderer(GlRenderer& renderer);
+
+// Cambia el muestreo adaptativo (step <= 1 lo desactiva); compila sus shaders la primera vez
+bool setGlAdaptive(GlRenderer& renderer, int step, float threshold);
+
+// Limita los frames en vuelo: llamar antes de leer la entrada para que la cámara no llegue vieja
+void waitGlFrameSlot(GlRenderer& renderer);
+
+// Traza la imagen de width x height en computeTarget (HDR lineal).
+// Devuelve true si hace falta otro frame aunque la escena no cambie (fases del entrelazado,
+// cubemap pendiente de hornear).
+bool traceGlImage(GlRenderer& renderer, const CameraState& camera, float time, int width, int height,
+                  bool envMapMode);
+
+// Exposición automática, bloom y pase a pantalla (framebuffer actual). dt: para adaptar la exposición.
+// Devuelve true si la exposición aún se está adaptando (hace falta otro frame).
+bool presentGlImage(GlRenderer& renderer, float dt);
+
+// Copia [x0, x0 + w) x [y0, y0 + h) de la última imagen trazada a rgb (3 floats por píxel, fila 0 = abajo)
+void readGlImage(GlRenderer& renderer, int x0, int y0, int w, int h, float* rgb);
+
+// Cierra el frame (fence de su ranura) y recoge los tiempos de GPU que ya estén listos
+void endGlFrame(GlRenderer& renderer);
+
+// Espera a las queries y marcas de GPU que queden (antes de escribir informes)
+void flushGlRenderer(GlRenderer& renderer);
+
+void printGlRendererStats(const GlRenderer& renderer);
@@ -0,0 +1,129 @@
+#include <glad/gl.h>
+#include "hdr.h"
+#include <cmath>
+#include <algorithm>
+
+// Tamaño del SSBO: histograma + brightCount + pixelCount
+static const int LUM_BUFFER_UINTS = LUM_HISTOGRAM_BINS + 2;
+
+const float EXPOSURE_KEY = 0.18f;   // Gris medio fotográfico
+const float EXPOSURE_MIN = 0.05f;
+const float EXPOSURE_MAX = 20.0f;
+const float EXPOSURE_ADAPT_RATE = 2.0f; // 1/segundos
+
+LuminanceBuffers createLuminanceBuffers() {
+    LuminanceBuffers buffers;
+    glGenBuffers(2, buffers.ssbo);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers.ssbo[i]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, LUM_BUFFER_UINTS * sizeof(unsigned int), NULL, GL_DYNAMIC_READ);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return buffers;
+}
+
+void destroyLuminanceBuffers(LuminanceBuffers& buffers) {
+    glDeleteBuffers(2, buffers.ssbo);
+    buffers.ssbo[0] = buffers.ssbo[1] = 0;
+    buffers.hasPrevious = false;
+}
+
+void dispatchLuminance(LuminanceBuffers& buffers, unsigned int program, unsigned int hdrTexture,
+                       int width, int height, float threshold) {
+    // Alternamos: el que escribimos ahora se leerá en el siguiente frame
+    buffers.current = 1 - buffers.current;
+    unsigned int ssbo = buffers.ssbo[buffers.current];
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+    unsigned int zero = 0;
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ssbo);
+
+    glUseProgram(program);
+    glUniform1f(glGetUniformLocation(program, "u_threshold"), threshold);
+    glUniform2i(glGetUniformLocation(program, "u_viewport"), width, height);
+    glBindImageTexture(0, hdrTexture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+    glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+
+    // La CPU leerá el buffer con glGetBufferSubData en el frame siguiente
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+bool readLuminanceStats(LuminanceBuffers& buffers, LuminanceStats& stats) {
+    if (!buffers.hasPrevious) {
+        // El primer frame solo ha escrito; no hay nada anterior que leer
+        buffers.hasPrevious = true;
+        return false;
+    }
+
+    unsigned int data[LUM_BUFFER_UINTS];
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers.ssbo[1 - buffers.current]);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(data), data);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    stats = computeLuminanceStats(data, data[LUM_HISTOGRAM_BINS], data[LUM_HISTOGRAM_BINS + 1]);
+    return stats.valid;
+}
+
+LuminanceStats computeLuminanceStats(const unsigned int* histogram, unsigned int brightCount,
+                                     unsigned int pixelCount) {
+    LuminanceStats stats;
+    stats.pixels = pixelCount;
+    if (pixelCount == 0) return stats;
+
+    // El bin 0 guarda los píxeles negros (sombra del agujero): no cuentan para la exposición
+    double weightedSum = 0.0;
+    unsigned int litPixels = 0;
+    for (int i = 1; i < LUM_HISTOGRAM_BINS; i++) {
+        // Centro del bin en espacio log2
+        float t = (i - 0.5f) / float(LUM_HISTOGRAM_BINS - 1);
+        float logLum = LUM_LOG_MIN + t * (LUM_LOG_MAX - LUM_LOG_MIN);
+        weightedSum += double(logLum) * histogram[i];
+        litPixels += histogram[i];
+    }
+
+    stats.avgLogLum = litPixels > 0 ? float(weightedSum / litPixels) : LUM_LOG_MIN;
+    stats.brightFraction = float(brightCount) / float(pixelCount);
+    stats.valid = true;
+    return stats;
+}
+
+LuminanceStats computeLuminanceStatsCPU(const float* rgb, int pixelCount, float threshold) {
+    unsigned int histogram[LUM_HISTOGRAM_BINS] = {0};
+    unsigned int brightCount = 0;
+    const float minLum = std::exp2(LUM_LOG_MIN);
+
+    for (int i = 0; i < pixelCount; i++) {
+        const float* c = rgb + (size_t)i * 3;
+        float lum = 0.2126f * c[0] + 0.7152f * c[1] + 0.0722f * c[2];
+
+        // Bin 0 = negro (sombra), bins 1..BINS-1 = escala logarítmica
+        int bin = 0;
+        if (lum > minLum) {
+            float t = (std::log2(lum) - LUM_LOG_MIN) / (LUM_LOG_MAX - LUM_LOG_MIN);
+            bin = 1 + std::clamp(int(t * float(LUM_HISTOGRAM_BINS - 1)), 0, LUM_HISTOGRAM_BINS - 2);
+        }
+        histogram[bin]++;
+        if (lum > threshold) brightCount++;
+    }
+    return computeLuminanceStats(histogram, brightCount, (unsigned int)pixelCount);
+}
+
+BloomMode chooseBloomMode(const LuminanceStats& stats) {
+    if (!stats.valid) return BloomMode::Full;
+    if (stats.brightFraction < BLOOM_SKIP_FRACTION) return BloomMode::Off;
+    if (stats.brightFraction < BLOOM_HALF_FRACTION) return BloomMode::Half;
+    return BloomMode::Full;
+}
+
+float updateExposure(float currentExposure, const LuminanceStats& stats, float dt) {
+    if (!stats.valid) return currentExposure;
+
+    // Media geométrica de la luminancia -> exposición que la lleva al gris medio
+    float avgLum = std::exp2(stats.avgLogLum);
+    float target = std::clamp(EXPOSURE_KEY / std::max(avgLum, 1e-4f), EXPOSURE_MIN, EXPOSURE_MAX);
+
+    // Adaptación exponencial (como el ojo), independiente del framerate
+    float blend = 1.0f - std::exp(-dt * EXPOSURE_ADAPT_RATE);
+    return currentExposure + (target - currentExposure) * blend;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// --- PIPELINE HDR: ESTADÍSTICAS DE LUMINANCIA, EXPOSICIÓN Y BLOOM ---
+// El pase de raytracing guarda color lineal (sin tone mapping). El shader
+// luminance.glsl reduce la imagen a un histograma de log2(luminancia) y a un
+// contador de píxeles brillantes. Con eso decidimos la exposición y si el
+// bloom merece la pena (y a qué resolución).
+
+const int LUM_HISTOGRAM_BINS = 64;   // Debe coincidir con luminance.glsl
+const float LUM_LOG_MIN = -10.0f;    // log2 de la luminancia mínima representada
+const float LUM_LOG_MAX = 6.0f;      // log2 de la luminancia máxima representada
+
+// Umbrales de fracción de píxeles brillantes para el bloom
+const float BLOOM_SKIP_FRACTION = 0.0005f; // Por debajo: no hay bloom
+const float BLOOM_HALF_FRACTION = 0.02f;   // Por debajo: bloom a media resolución
+
+enum class BloomMode { Off, Half, Full };
+
+struct LuminanceStats {
+    float avgLogLum = 0.0f;      // Media de log2(L) de los píxeles no negros
+    float brightFraction = 0.0f; // Fracción de píxeles por encima del umbral
+    unsigned int pixels = 0;     // Píxeles evaluados
+    bool valid = false;
+};
+
+// Dos SSBO alternos: uno se escribe este frame y el otro (del frame anterior)
+// se lee en la CPU, así la lectura no espera a que termine la GPU.
+struct LuminanceBuffers {
+    unsigned int ssbo[2] = {0, 0};
+    int current = 0;
+    bool hasPrevious = false;
+};
+
+LuminanceBuffers createLuminanceBuffers();
+void destroyLuminanceBuffers(LuminanceBuffers& buffers);
+
+// Limpia el buffer actual y lanza la reducción sobre la textura HDR.
+// 'threshold' es la luminancia lineal a partir de la cual un píxel cuenta como brillante.
+void dispatchLuminance(LuminanceBuffers& buffers, unsigned int program, unsigned int hdrTexture,
+                       int width, int height, float threshold);
+
+// Lee las estadísticas del frame anterior. Devuelve false si aún no hay ninguno.
+bool readLuminanceStats(LuminanceBuffers& buffers, LuminanceStats& stats);
+
+// Cálculo puro a partir del contenido del SSBO (histograma + contadores)
+LuminanceStats computeLuminanceStats(const unsigned int* histogram, unsigned int brightCount,
+                                     unsigned int pixelCount);
+
+// Mismo histograma que luminance.glsl, calculado en la CPU (trazador sin ventana)
+LuminanceStats computeLuminanceStatsCPU(const float* rgb, int pixelCount, float threshold);
+
+BloomMode chooseBloomMode(const LuminanceStats& stats);
+
+// Adaptación suave de la exposición hacia el valor "clave" (gris medio 0.18)
+float updateExposure(float currentExposure, const LuminanceStats& stats, float dt);
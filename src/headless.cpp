@@ -0,0 +1,543 @@
+#include "headless.h"
+#include "camera_path.h"
+#include "cpu_tracer.h"
+#include "kerr.h"
+#include "fast_math.h"
+#include "hdr.h"
+#include "image_io.h"
+#include "timing_report.h"
+#include "metrics.h"
+#include "trace.h"
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Opciones NUMA de la línea de comandos (antes de startCpuTracer)
+static void applyNumaConfig(const AppConfig& config, CpuTracer& tracer) {
+    if (config.numa) tracer.numaNodes = config.numaNodes > 0 ? config.numaNodes : 1 << 16;
+    tracer.hugePages = config.hugePages;
+}
+
+// Reparto de los rayos integrados según la clasificación previa (contadores globales)
+static void printRayClasses() {
+    uint64_t doomed = metricCounterTotal(MetricCounter::CpuRaysDoomed);
+    uint64_t clear = metricCounterTotal(MetricCounter::CpuRaysClear);
+    uint64_t nearRays = metricCounterTotal(MetricCounter::CpuRaysNear);
+    uint64_t total = doomed + clear + nearRays;
+    if (total == 0) return;
+    std::cout << "Clases de rayo: condenados " << 100.0 * doomed / total << "%, lejanos " << 100.0 * clear / total
+              << "%, cercanos " << 100.0 * nearRays / total << "%" << std::endl;
+}
+
+// Disco semitransparente: cruces del disco entre todos los rayos trazados
+static void printDiskCrossings(long long rays) {
+    uint64_t crossings = metricCounterTotal(MetricCounter::CpuDiskCrossings);
+    std::cout << "Disco semitransparente: " << double(crossings) / std::max(rays, 1LL) << " cruces/rayo" << std::endl;
+}
+
+int runHeadless(const AppConfig& config) {
+    CameraPath cameraPath;
+    if (!loadCameraPath(config.replayPath, cameraPath)) return -1;
+
+    CpuTracer tracer;
+    applyNumaConfig(config, tracer);
+    int cubeFaceSize = config.equirectSkybox ? -1 : config.skyboxFaceSize;
+    if (!startCpuTracer(tracer, config.threads, config.skyboxPath.c_str(), cubeFaceSize,
+                        config.diskNoiseSize, config.diskOctaves)) return -1;
+    if (config.adaptiveStep > 1) {
+        tracer.adaptiveStep = config.adaptiveStep;
+        tracer.adaptiveThreshold = config.adaptiveThreshold;
+    }
+    tracer.params.kerr = config.kerr;
+    tracer.params.spin = config.kerrSpin;
+    tracer.params.analytic = config.analytic;
+    parseIntegratorKind(config.integrator, tracer.params.integrator);
+    tracer.params.nullRenorm = config.nullRenorm;
+    tracer.params.rayClasses = config.rayClasses;
+    tracer.params.fastMath = config.fastMath;
+    tracer.params.diskOpacity = config.diskOpacity;
+    tracer.params.diskOrders = config.diskOrders;
+    tracer.params.spacetime = spacetimeFor(config.charge, config.lambda);
+    tracer.params.charge = config.charge;
+    tracer.params.lambda = config.lambda;
+    if (!lensFieldFromConfig(config, tracer.params.lenses)) {
+        stopCpuTracer(tracer);
+        return -1;
+    }
+    if (tracer.params.lenses) tracer.params.spacetime = SpacetimeKind::MultiLens;
+
+    CpuFrame frame;
+    frame.width = config.width;
+    frame.height = config.height;
+
+    TimingReport report;
+    float exposure = 1.0f;
+    float animationTime = 0.0f;
+    long long totalRays = 0, totalSteps = 0, totalPixels = 0;
+    double totalMs = 0.0;
+
+    for (size_t i = 0; i < cameraPath.frames.size(); i++) {
+        TRACE_SCOPE("frame");
+        const CameraPathFrame& pathFrame = cameraPath.frames[i];
+        if (pathFrame.animateDisk) animationTime += cameraPath.fixedDt;
+
+        CpuFrameStats stats;
+        renderFrameCPU(tracer, pathFrame.camera, animationTime, frame, stats);
+        addFrameTiming(report, stats.ms, -1.0, -1.0);
+        countMetric(MetricCounter::Frames);
+        totalRays += stats.rays;
+        totalSteps += stats.steps;
+        totalPixels += stats.pixels;
+        totalMs += stats.ms;
+
+        // Misma exposición automática que en la ventana, con el dt fijo del recorrido
+        LuminanceStats lumStats = computeLuminanceStatsCPU(frame.rgb.data(), frame.width * frame.height, 1.0f / exposure);
+        exposure = updateExposure(exposure, lumStats, cameraPath.fixedDt);
+
+        if (!config.outputDir.empty()) {
+            char name[64];
+            std::snprintf(name, sizeof(name), "/frame_%05zu.ppm", i);
+            TRACE_SCOPE("writeImagePPM");
+            writeImagePPM(config.outputDir + name, frame.rgb.data(), frame.width, frame.height, exposure);
+        }
+    }
+
+    stopCpuTracer(tracer);
+
+    if (totalMs > 0.0 && totalRays > 0) {
+        std::cout << "Trazador CPU: " << totalRays << " rayos, " << double(totalSteps) / totalRays
+                  << " pasos/rayo, " << totalRays / (totalMs / 1000.0) / 1e6 << " Mrayos/s" << std::endl;
+        printRayClasses();
+        if (tracer.params.diskOpacity < 1.0f) printDiskCrossings(totalRays);
+    }
+    if (tracer.adaptiveStep > 1 && totalPixels > 0) {
+        std::cout << "Muestreo adaptativo (" << tracer.adaptiveStep << "x" << tracer.adaptiveStep << "): "
+                  << 100.0 * totalRays / totalPixels << "% rayos trazados" << std::endl;
+    }
+    writeTimingReport(report, config.reportPath);
+    return 0;
+}
+
+// Tiempo medio por búsqueda (un hilo) sobre un conjunto fijo de direcciones
+static double timeLookups(const CpuSkybox& skybox, const std::vector<vec3>& dirs, float& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    vec3 sum = {0.0f, 0.0f, 0.0f};
+    for (const vec3& d : dirs) sum = sum + getBackground(d, skybox);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    checksum += sum.x + sum.y + sum.z; // Para que el compilador no elimine el bucle
+    return ns / dirs.size();
+}
+
+int runBackgroundBenchmark(const AppConfig& config) {
+    CpuSkybox skybox;
+    if (!loadCpuSkybox(config.skyboxPath.c_str(), skybox)) return -1;
+
+    ThreadPool pool;
+    startThreadPool(pool, config.threads);
+    int faceSize = config.skyboxFaceSize > 0 ? config.skyboxFaceSize : defaultCubeFaceSize(skybox.width);
+    auto convertStart = std::chrono::steady_clock::now();
+    equirectToCube(skybox.pixels.data(), skybox.width, skybox.height, 3, faceSize, pool, skybox.cube);
+    double convertMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - convertStart).count();
+    int threads = threadPoolSize(pool);
+    stopThreadPool(pool);
+    std::cout << "Conversión a cubemap (" << threads << " hilos, 6 x " << faceSize << "x" << faceSize
+              << "): " << convertMs << " ms" << std::endl;
+
+    // Direcciones uniformes en la esfera y otras cerca de los polos (|y| > 0.95)
+    const size_t LOOKUPS = 2000000;
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::vector<vec3> sphereDirs(LOOKUPS), polarDirs(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        sphereDirs[i] = normalize({gauss(rng), gauss(rng), gauss(rng)});
+        float y = 0.95f + 0.05f * uniform(rng);
+        float phi = 2.0f * 3.14159265f * uniform(rng);
+        float r = std::sqrt(1.0f - y * y);
+        polarDirs[i] = {r * std::cos(phi), (i % 2) ? y : -y, r * std::sin(phi)};
+    }
+
+    float checksum = 0.0f;
+    const char* sets[2] = {"esfera", "polos"};
+    const std::vector<vec3>* dirs[2] = {&sphereDirs, &polarDirs};
+    for (int s = 0; s < 2; s++) {
+        skybox.useCube = false;
+        double equirectNs = timeLookups(skybox, *dirs[s], checksum);
+        skybox.useCube = true;
+        double cubeNs = timeLookups(skybox, *dirs[s], checksum);
+        std::cout << "Búsqueda del cielo (" << sets[s] << "): panorama " << equirectNs << " ns, cubemap " << cubeNs
+                  << " ns (x" << equirectNs / cubeNs << ")" << std::endl;
+    }
+    std::cout << "(suma de control " << checksum << "; en GPU, compara --report con y sin --skybox-equirect)" << std::endl;
+    return 0;
+}
+
+int runDiskNoiseBenchmark(const AppConfig& config) {
+    ThreadPool pool;
+    startThreadPool(pool, config.threads);
+    DiskNoise noise;
+    auto bakeStart = std::chrono::steady_clock::now();
+    bakeDiskNoise(noise, config.diskNoiseSize, config.diskNoiseSize, config.diskOctaves, pool);
+    double bakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bakeStart).count();
+    stopThreadPool(pool);
+    std::cout << "Horneado: " << bakeMs << " ms" << std::endl;
+
+    // Coordenadas como las de shadeDisk: ángulo rotado (crece con el tiempo) y radio - tiempo
+    const size_t LOOKUPS = 2000000;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+    std::uniform_real_distribution<float> radius(ISCO, DISK_MAX);
+    std::uniform_real_distribution<float> time(0.0f, 100.0f);
+    std::vector<float> us(LOOKUPS), vs(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; i++) {
+        float r = radius(rng), t = time(rng);
+        us[i] = (angle(rng) + 12.0f / std::sqrt(r) * t) * 3.0f;
+        vs[i] = r * 1.5f - t;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    float proceduralSum = 0.0f;
+    for (size_t i = 0; i < LOOKUPS; i++) proceduralSum += proceduralDiskNoise(us[i], vs[i], config.diskOctaves);
+    double proceduralNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LOOKUPS;
+
+    start = std::chrono::steady_clock::now();
+    float bakedSum = 0.0f;
+    for (size_t i = 0; i < LOOKUPS; i++) bakedSum += sampleDiskNoise(noise, us[i], vs[i]);
+    double bakedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LOOKUPS;
+
+    // Calidad: diferencia con el fbm evaluado en el mismo punto
+    double squaredError = 0.0, maxError = 0.0;
+    for (size_t i = 0; i < LOOKUPS; i += 16) {
+        double e = std::fabs(proceduralDiskNoise(us[i], vs[i], config.diskOctaves) - sampleDiskNoise(noise, us[i], vs[i]));
+        squaredError += e * e;
+        maxError = std::max(maxError, e);
+    }
+    std::cout << "Ruido del disco: fbm " << proceduralNs << " ns, textura " << bakedNs << " ns (x"
+              << proceduralNs / bakedNs << ")" << std::endl;
+    std::cout << "Error frente al fbm: RMS " << std::sqrt(squaredError / (LOOKUPS / 16)) << ", máximo " << maxError
+              << " (suma de control " << proceduralSum + bakedSum << ")" << std::endl;
+    return 0;
+}
+
+int runNumaBenchmark(const AppConfig& config) {
+    NumaTopology topology = detectNumaTopology();
+    printNumaTopology(topology);
+    int nodeCount = (int)topology.nodeCpus.size();
+    if (config.numaNodes > 0) nodeCount = std::min(nodeCount, config.numaNodes);
+
+    const int FRAMES = 3;
+    CameraState camera;
+    CpuFrame frame;
+    frame.width = config.width;
+    frame.height = config.height;
+    double baseRate = 0.0;
+
+    // Todas las CPUs de los k primeros nodos; el escalado ideal es proporcional a las CPUs
+    for (int nodes = 1; nodes <= nodeCount; nodes++) {
+        CpuTracer tracer;
+        tracer.numaNodes = nodes;
+        tracer.hugePages = config.hugePages;
+        int cubeFaceSize = config.equirectSkybox ? -1 : config.skyboxFaceSize;
+        if (!startCpuTracer(tracer, 0, config.skyboxPath.c_str(), cubeFaceSize, config.diskNoiseSize,
+                            config.diskOctaves)) return -1;
+
+        CpuFrameStats stats;
+        renderFrameCPU(tracer, camera, 0.0f, frame, stats); // Calentamiento (y first touch del framebuffer)
+        long long rays = 0;
+        double ms = 0.0;
+        for (int i = 0; i < FRAMES; i++) {
+            renderFrameCPU(tracer, camera, i * 0.1f, frame, stats);
+            rays += stats.rays;
+            ms += stats.ms;
+        }
+        int threads = threadPoolSize(tracer.pool);
+        stopCpuTracer(tracer);
+
+        double rate = rays / (ms / 1000.0) / 1e6;
+        if (nodes == 1) baseRate = rate;
+        int cpus = numaCpuCount(topology, nodes);
+        std::cout << "NUMA " << nodes << " nodo(s), " << threads << " hilos: " << ms / FRAMES << " ms/frame, " << rate
+                  << " Mrayos/s (x" << rate / baseRate << ", eficiencia "
+                  << 100.0 * (rate / baseRate) / (double(cpus) / numaCpuCount(topology, 1)) << "%)" << std::endl;
+    }
+    return 0;
+}
+
+// Un hilo, mismos rayos para todos los motores: coste por rayo y por paso, y a dónde van los rayos
+int runEngineBenchmark(const AppConfig& config) {
+    CameraState camera;
+    camera.y = 1.0f; // Algo por encima del disco: rayos que lo cruzan, que lo rodean y que caen
+    (void)config;
+    CameraBasis basis = computeCameraBasis(camera);
+    vec3 ro = {camera.x, camera.y, camera.z};
+    const int width = 160, height = 120;
+
+    // Las filas con carga, Λ o varias lentes son el mismo bucle instanciado con otra política (spacetime.h,
+    // lenses.h). lenses: 2 = binaria separada 1, más = campo de microlentes (tolerancia 0 = sin podar).
+    // Con diskOpacity < 1 los rayos siguen tras cruzar el disco (imágenes de orden superior)
+    struct Engine {
+        const char* name; bool analytic; bool kerr; float spin; float charge; float lambda; int lenses; float tolerance;
+        float diskOpacity = 1.0f;
+    };
+    const Engine engines[] = {
+        {"Schwarzschild (pseudo-newtoniano)", false, false, 0.0f, 0.0f, 0.0f, 0, 0.0f},
+        {"Reissner-Nordström Q = 0.2 (pseudo-newtoniano)", false, false, 0.0f, 0.2f, 0.0f, 0, 0.0f},
+        {"Schwarzschild-de Sitter L = 0.01 (pseudo-newtoniano)", false, false, 0.0f, 0.0f, 0.01f, 0, 0.0f},
+        {"Binaria D = 1 (pseudo-newtoniano)", false, false, 0.0f, 0.0f, 0.0f, 2, LENS_DEFAULT_TOLERANCE},
+        {"32 lentes (microlentes), con poda", false, false, 0.0f, 0.0f, 0.0f, 32, LENS_DEFAULT_TOLERANCE},
+        {"32 lentes (microlentes), sin poda", false, false, 0.0f, 0.0f, 0.0f, 32, 0.0f},
+        {"Disco semitransparente, opacidad 0.9", false, false, 0.0f, 0.0f, 0.0f, 0, 0.0f, 0.9f},
+        {"Disco semitransparente, opacidad 0.5", false, false, 0.0f, 0.0f, 0.0f, 0, 0.0f, 0.5f},
+        {"Schwarzschild exacto, forma cerrada (--analytic)", true, false, 0.0f, 0.0f, 0.0f, 0, 0.0f},
+        {"Kerr a = 0 (Schwarzschild exacto, RK4)", false, true, 0.0f, 0.0f, 0.0f, 0, 0.0f},
+        {"Kerr a = 0.5", false, true, 0.5f, 0.0f, 0.0f, 0, 0.0f},
+        {"Kerr a = 0.9", false, true, 0.9f, 0.0f, 0.0f, 0, 0.0f},
+        {"Kerr a = 0.998", false, true, 0.998f, 0.0f, 0.0f, 0, 0.0f},
+    };
+    double baseNs = 0.0;
+    for (const Engine& engine : engines) {
+        BlackHoleParams params;
+        params.analytic = engine.analytic;
+        params.kerr = engine.kerr;
+        params.spin = engine.spin;
+        params.spacetime = spacetimeFor(engine.charge, engine.lambda);
+        params.charge = engine.charge;
+        params.lambda = engine.lambda;
+        params.diskOpacity = engine.diskOpacity;
+        if (engine.lenses > 0) {
+            auto field = std::make_shared<LensField>();
+            buildLensField(engine.lenses == 2 ? binaryLenses(RS, 1.0f) : microlensField(RS, engine.lenses),
+                           engine.tolerance, *field);
+            params.lenses = field;
+            params.spacetime = SpacetimeKind::MultiLens;
+        }
+        long long steps = 0;
+        int counts[3] = {0, 0, 0};
+        uint64_t crossingsBefore = metricCounterTotal(MetricCounter::CpuDiskCrossings);
+        auto start = std::chrono::steady_clock::now();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int raySteps = 0;
+                RayOutcome outcome = traceOutcome(ro, pixelRay(basis, x, y, width, height), raySteps, params);
+                steps += raySteps;
+                counts[(int)outcome.kind]++;
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        int rays = width * height;
+        if (baseNs == 0.0) baseNs = ns;
+        std::cout << engine.name << ": " << ns / rays << " ns/rayo (x" << ns / baseNs << "), "
+                  << double(steps) / rays << " pasos/rayo, " << ns / std::max(steps, 1LL) << " ns/paso; capturados "
+                  << 100.0 * counts[0] / rays << "%, disco " << 100.0 * counts[2] / rays << "%, escapan "
+                  << 100.0 * counts[1] / rays << "%" << std::endl;
+        if (engine.diskOpacity < 1.0f) {
+            uint64_t crossings = metricCounterTotal(MetricCounter::CpuDiskCrossings) - crossingsBefore;
+            std::cout << "  " << double(crossings) / rays << " cruces/rayo, " << double(crossings) / std::max(counts[2], 1)
+                      << " por rayo que llega al disco" << std::endl;
+        }
+        if (&engine == &engines[0]) printRayClasses(); // Solo el bucle integrado clasifica
+    }
+    return 0;
+}
+
+int runIntegratorBenchmark(const AppConfig& config) {
+    (void)config;
+    CameraState camera;
+    camera.y = 1.0f;
+    CameraBasis basis = computeCameraBasis(camera);
+    vec3 ro = {camera.x, camera.y, camera.z};
+    const int width = 128, height = 96, rays = width * height;
+    std::vector<vec3> dirs(rays);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) dirs[(size_t)y * width + x] = pixelRay(basis, x, y, width, height);
+    }
+
+    // Referencia: RK4 con un paso 32 veces menor
+    BlackHoleParams reference;
+    reference.stepSize = STEP_SIZE / 32.0f;
+    std::vector<RayOutcome> expected(rays);
+    for (int i = 0; i < rays; i++) {
+        int steps, evals;
+        expected[i] = traceOutcomeIntegrated(ro, dirs[i], steps, evals, reference);
+    }
+
+    // Cada fila: integrador, paso (o tolerancia en RKF45) y renormalización
+    struct Run { IntegratorKind kind; float stepOrTolerance; bool renorm; };
+    const Run runs[] = {
+        {IntegratorKind::RK4, 2.0f * STEP_SIZE, false},
+        {IntegratorKind::RK4, STEP_SIZE, false},
+        {IntegratorKind::RK4, STEP_SIZE, true},
+        {IntegratorKind::RK4, 0.5f * STEP_SIZE, false},
+        {IntegratorKind::Verlet, STEP_SIZE, false},
+        {IntegratorKind::Verlet, 0.25f * STEP_SIZE, false},
+        {IntegratorKind::Verlet, 0.25f * STEP_SIZE, true},
+        {IntegratorKind::Verlet, 0.0625f * STEP_SIZE, false},
+        {IntegratorKind::Yoshida4, 2.0f * STEP_SIZE, false},
+        {IntegratorKind::Yoshida4, STEP_SIZE, false},
+        {IntegratorKind::Yoshida4, STEP_SIZE, true},
+        {IntegratorKind::Yoshida4, 0.5f * STEP_SIZE, false},
+        {IntegratorKind::RKF45, 1e-3f, false},
+        {IntegratorKind::RKF45, 1e-4f, false},
+        {IntegratorKind::RKF45, 1e-4f, true},
+        {IntegratorKind::RKF45, 1e-5f, false},
+    };
+    std::cout << "Referencia: rk4 con paso " << reference.stepSize << " (" << width << "x" << height << " rayos)"
+              << std::endl;
+    for (const Run& run : runs) {
+        BlackHoleParams params;
+        params.integrator = run.kind;
+        params.nullRenorm = run.renorm;
+        if (run.kind == IntegratorKind::RKF45) params.tolerance = run.stepOrTolerance;
+        else params.stepSize = run.stepOrTolerance;
+
+        long long totalEvals = 0;
+        int mismatched = 0, escaped = 0, disk = 0;
+        double angleError = 0.0, radiusError = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rays; i++) {
+            int steps, evals;
+            RayOutcome outcome = traceOutcomeIntegrated(ro, dirs[i], steps, evals, params);
+            totalEvals += evals;
+            const RayOutcome& ref = expected[i];
+            if (outcome.kind != ref.kind) {
+                mismatched++;
+            } else if (outcome.kind == OutcomeKind::Escaped) {
+                angleError += std::acos(std::clamp(dot(outcome.dir, ref.dir), -1.0f, 1.0f));
+                escaped++;
+            } else if (outcome.kind == OutcomeKind::Disk) {
+                radiusError += std::fabs(outcome.hitDist - ref.hitDist);
+                disk++;
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << integratorName(run.kind) << (run.renorm ? " + renorm" : "")
+                  << (run.kind == IntegratorKind::RKF45 ? " tol " : " paso ") << run.stepOrTolerance << ": "
+                  << double(totalEvals) / rays << " evals/rayo, " << ns / rays << " ns/rayo; distinto "
+                  << 100.0 * mismatched / rays << "%, error de dirección " << angleError / std::max(escaped, 1)
+                  << " rad, error de radio en el disco " << radiusError / std::max(disk, 1) << std::endl;
+    }
+    return 0;
+}
+
+// Error máximo de una aproximación frente a la referencia en doble precisión, y ns/llamada de ambas
+struct KernelResult { double maxError, fastNs, preciseNs; };
+
+template <class Fast, class Precise, class Reference>
+static KernelResult measureKernel(const std::vector<float>& xs, const std::vector<float>& ys, bool relative,
+                                  Fast fast, Precise precise, Reference reference) {
+    KernelResult result = {0.0, 0.0, 0.0};
+    for (size_t i = 0; i < xs.size(); i++) {
+        double ref = reference(xs[i], ys[i]);
+        double e = std::fabs(fast(xs[i], ys[i]) - ref);
+        result.maxError = std::max(result.maxError, relative ? e / std::fabs(ref) : e);
+    }
+    float sum = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < xs.size(); i++) sum += fast(xs[i], ys[i]);
+    auto mid = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < xs.size(); i++) sum += precise(xs[i], ys[i]);
+    auto end = std::chrono::steady_clock::now();
+    result.fastNs = std::chrono::duration<double, std::nano>(mid - start).count() / xs.size();
+    result.preciseNs = std::chrono::duration<double, std::nano>(end - mid).count() / xs.size();
+    volatile float sink = sum; // Para que el compilador no elimine los bucles
+    (void)sink;
+    return result;
+}
+
+int runFastMathBenchmark(const AppConfig& config) {
+    // 1. Funciones sueltas sobre todo su dominio
+    const size_t SAMPLES = 4000000;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> exponent(-20.0f, 20.0f), angle(-3.14159265f, 3.14159265f),
+        unit(-1.0f, 1.0f), radius(0.01f, 100.0f);
+    std::vector<float> positive(SAMPLES), xs(SAMPLES), ys(SAMPLES), sines(SAMPLES);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        positive[i] = std::exp2(exponent(rng));
+        float a = angle(rng), r = radius(rng);
+        xs[i] = r * std::cos(a);
+        ys[i] = r * std::sin(a);
+        sines[i] = unit(rng);
+    }
+    sines[0] = -1.0f;
+    sines[1] = 1.0f;
+
+    struct Row { const char* name; const char* unit; KernelResult result; };
+    const Row rows[] = {
+        {"rsqrt", "relativo", measureKernel(positive, positive, true,
+             [](float x, float) { return fastRsqrt(x); }, [](float x, float) { return 1.0f / std::sqrt(x); },
+             [](float x, float) { return 1.0 / std::sqrt(double(x)); })},
+        {"atan2", "rad", measureKernel(ys, xs, false,
+             [](float y, float x) { return fastAtan2(y, x); }, [](float y, float x) { return std::atan2(y, x); },
+             [](float y, float x) { return std::atan2(double(y), double(x)); })},
+        {"asin", "rad", measureKernel(sines, sines, false,
+             [](float x, float) { return fastAsin(x); }, [](float x, float) { return std::asin(x); },
+             [](float x, float) { return std::asin(double(x)); })},
+    };
+    for (const Row& row : rows) {
+        std::cout << row.name << ": error máximo " << row.result.maxError << " (" << row.unit << "), "
+                  << row.result.fastNs << " ns frente a " << row.result.preciseNs << " ns de libm (x"
+                  << row.result.preciseNs / row.result.fastNs << ")" << std::endl;
+    }
+
+    // 2. Un frame (un hilo) con el cielo equirectangular, que es el que usa atan2/asin; trazado y sombreado aparte
+    CpuSkybox skybox;
+    if (!loadCpuSkybox(config.skyboxPath.c_str(), skybox)) return -1;
+    DiskNoise diskNoise;
+    ThreadPool pool;
+    startThreadPool(pool, config.threads);
+    bakeDiskNoise(diskNoise, config.diskNoiseSize, config.diskNoiseSize, config.diskOctaves, pool);
+    stopThreadPool(pool);
+
+    CameraState camera;
+    camera.y = 1.0f;
+    CameraBasis basis = computeCameraBasis(camera);
+    vec3 ro = {camera.x, camera.y, camera.z};
+    const int width = 200, height = 150, pixels = width * height;
+    std::vector<unsigned char> images[2];
+    double traceMs[2], shadeMs[2];
+    for (int fast = 0; fast < 2; fast++) {
+        BlackHoleParams params;
+        params.fastMath = fast != 0;
+        std::vector<RayOutcome> outcomes(pixels);
+        auto start = std::chrono::steady_clock::now();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int steps;
+                outcomes[(size_t)y * width + x] = traceOutcome(ro, pixelRay(basis, x, y, width, height), steps, params);
+            }
+        }
+        auto mid = std::chrono::steady_clock::now();
+        std::vector<float> rgb((size_t)pixels * 3);
+        for (int i = 0; i < pixels; i++) {
+            vec3 color = shadeOutcome(outcomes[i], 1.0f, skybox, diskNoise, params);
+            rgb[(size_t)i * 3 + 0] = color.x;
+            rgb[(size_t)i * 3 + 1] = color.y;
+            rgb[(size_t)i * 3 + 2] = color.z;
+        }
+        auto end = std::chrono::steady_clock::now();
+        traceMs[fast] = std::chrono::duration<double, std::milli>(mid - start).count();
+        shadeMs[fast] = std::chrono::duration<double, std::milli>(end - mid).count();
+        images[fast].resize(rgb.size());
+        tonemapToRGB8(rgb.data(), rgb.size(), 1.0f, images[fast].data());
+    }
+
+    int maxDiff = 0, changed = 0;
+    double squared = 0.0;
+    for (size_t i = 0; i < images[0].size(); i++) {
+        int d = std::abs(int(images[0][i]) - int(images[1][i]));
+        maxDiff = std::max(maxDiff, d);
+        squared += double(d) * d;
+        if (d > 2) changed++;
+    }
+    std::cout << "Frame " << width << "x" << height << ": trazado " << traceMs[0] << " ms preciso, " << traceMs[1]
+              << " ms rápido (x" << traceMs[0] / traceMs[1] << "); sombreado " << shadeMs[0] << " ms, " << shadeMs[1]
+              << " ms (x" << shadeMs[0] / shadeMs[1] << ")" << std::endl;
+    std::cout << "Diferencia en 8 bits: rms "
+              << std::sqrt(squared / images[0].size()) << ", máxima " << maxDiff << ", "
+              << 100.0 * changed / images[0].size() << "% de canales con más de 2 niveles" << std::endl;
+    return 0;
+}
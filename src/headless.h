@@ -0,0 +1,26 @@
+#pragma once
+#include "config.h"
+
+// --- MODO SIN VENTANA ---
+// Reproduce un recorrido de cámara con el trazador de CPU (sin GLFW ni GL),
+// con dt fijo, y genera el informe de tiempos por frame. Pensado para nodos
+// sin GPU y para comparar cambios del trazador sobre frames idénticos.
+int runHeadless(const AppConfig& config);
+
+// --bench-background: coste por búsqueda del cielo, panorama (atan/asin) frente a cubemap
+int runBackgroundBenchmark(const AppConfig& config);
+
+// --bench-disk: coste del ruido del disco por impacto, fbm evaluado frente a textura horneada
+int runDiskNoiseBenchmark(const AppConfig& config);
+
+// --bench-numa: frames del trazador de CPU con 1, 2, ... nodos NUMA (hilos fijados y cielo por nodo)
+int runNumaBenchmark(const AppConfig& config);
+
+// --bench-engines: coste por rayo (y por paso) de cada motor de geodésicas frente al pseudo-newtoniano
+int runEngineBenchmark(const AppConfig& config);
+
+// --bench-integrators: precisión (frente a RK4 con paso 32 veces menor) y evaluaciones de la aceleración por rayo
+int runIntegratorBenchmark(const AppConfig& config);
+
+// --bench-fast-math: error máximo y ns/llamada de fast_math.h frente a libm, y un frame preciso contra uno rápido
+int runFastMathBenchmark(const AppConfig& config);
@@ -0,0 +1,36 @@
+#include "image_io.h"
+#include "metrics.h"
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <iostream>
+
+static unsigned char toDisplay(float linear, float exposure) {
+    float c = linear * exposure;
+    c = c / (c + 1.0f);                 // Reinhard
+    c = std::pow(c, 1.0f / 2.2f);       // Gamma
+    return (unsigned char)std::lround(std::fmin(std::fmax(c, 0.0f), 1.0f) * 255.0f);
+}
+
+void tonemapToRGB8(const float* rgb, size_t count, float exposure, unsigned char* out) {
+    for (size_t i = 0; i < count; i++) out[i] = toDisplay(rgb[i], exposure);
+}
+
+bool writeImagePPM(const std::string& path, const float* rgb, int width, int height, float exposure) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR: No se pudo escribir la imagen: " << path << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<unsigned char> row((size_t)width * 3);
+    // PPM empieza por arriba: recorremos las filas al revés
+    for (int y = height - 1; y >= 0; y--) {
+        const float* src = rgb + (size_t)y * width * 3;
+        tonemapToRGB8(src, row.size(), exposure, row.data());
+        file.write((const char*)row.data(), row.size());
+    }
+    countMetric(MetricCounter::BytesWritten, (uint64_t)file.tellp());
+    return (bool)file;
+}
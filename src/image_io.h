@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// --- ESCRITURA DE IMÁGENES ---
+// Aplica la misma cadena de salida que fragment_screen.glsl (exposición,
+// Reinhard y gamma 2.2) y guarda un PPM binario. 'rgb' es color lineal con la
+// fila 0 abajo, como las texturas de GL.
+bool writeImagePPM(const std::string& path, const float* rgb, int width, int height, float exposure);
+
+// La misma cadena sobre 'count' valores sueltos (una fila, una imagen entera...)
+void tonemapToRGB8(const float* rgb, size_t count, float exposure, unsigned char* out);
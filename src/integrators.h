@@ -0,0 +1,184 @@
+#pragma once
+#include "vec3.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// --- INTEGRADORES DEL TRAZADOR DE CPU (POLÍTICAS) ---
+// El bucle del rayo (traceOutcome) es una plantilla sobre una de estas
+// políticas: se elige una vez por rayo y el bucle interno no tiene
+// despacho en tiempo de ejecución. Los coeficientes (tablas de Butcher y
+// pesos de composición) son datos constexpr, así que el compilador los
+// pliega y los ceros ni se evalúan.
+//
+// Todas integran x'' = a(x) sobre IntegratorState y aprovechan FSAL: 'acc'
+// es siempre la aceleración en 'pos', y la última evaluación de un paso es
+// la primera del siguiente.
+
+enum class IntegratorKind { RK4, Verlet, Yoshida4, RKF45 };
+
+const float INTEGRATOR_TOLERANCE = 1e-4f;  // RKF45: error local admitido por paso
+const float RKF45_MIN_STEP = 1e-3f;
+const float RKF45_MAX_STEP = 0.25f;        // El cruce del disco se interpola en línea recta: pasos acotados
+const int RKF45_MAX_ATTEMPTS = 8;
+
+inline const char* integratorName(IntegratorKind kind) {
+    switch (kind) {
+        case IntegratorKind::RK4: return "rk4";
+        case IntegratorKind::Verlet: return "verlet";
+        case IntegratorKind::Yoshida4: return "yoshida4";
+        case IntegratorKind::RKF45: return "rkf45";
+    }
+    return "?";
+}
+
+inline bool parseIntegratorKind(const std::string& name, IntegratorKind& kind) {
+    for (IntegratorKind k : {IntegratorKind::RK4, IntegratorKind::Verlet, IntegratorKind::Yoshida4,
+                             IntegratorKind::RKF45}) {
+        if (name == integratorName(k)) {
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct IntegratorState {
+    vec3 pos, vel;
+    vec3 acc;          // a(pos)
+    float dt;          // Paso que se va a intentar (los adaptativos lo ajustan)
+    int evals = 0;     // Evaluaciones de a(x) acumuladas
+};
+
+// --- Runge-Kutta explícito sobre una tabla de Butcher ---
+// Paso: x += dt / bScale * Σ b_i k_i (RK4 con pesos enteros: (k1 + 2 k2 + 2 k3 + k4) * (dt / 6))
+
+struct TableauRK4 {
+    static constexpr int stages = 4;
+    static constexpr bool embedded = false;
+    static constexpr float a[4][4] = {
+        {0.0f, 0.0f, 0.0f, 0.0f},
+        {0.5f, 0.0f, 0.0f, 0.0f},
+        {0.0f, 0.5f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f, 0.0f}};
+    static constexpr float b[4] = {1.0f, 2.0f, 2.0f, 1.0f};
+    static constexpr float bScale = 6.0f;
+    static constexpr float bError[4] = {};
+};
+
+// Runge-Kutta-Fehlberg 4(5): avanza con el de orden 5, bError = b5 - b4 estima el error
+struct TableauRKF45 {
+    static constexpr int stages = 6;
+    static constexpr bool embedded = true;
+    static constexpr float a[6][6] = {
+        {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+        {1.0f / 4.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+        {3.0f / 32.0f, 9.0f / 32.0f, 0.0f, 0.0f, 0.0f, 0.0f},
+        {1932.0f / 2197.0f, -7200.0f / 2197.0f, 7296.0f / 2197.0f, 0.0f, 0.0f, 0.0f},
+        {439.0f / 216.0f, -8.0f, 3680.0f / 513.0f, -845.0f / 4104.0f, 0.0f, 0.0f},
+        {-8.0f / 27.0f, 2.0f, -3544.0f / 2565.0f, 1859.0f / 4104.0f, -11.0f / 40.0f, 0.0f}};
+    static constexpr float b[6] = {16.0f / 135.0f, 0.0f, 6656.0f / 12825.0f, 28561.0f / 56430.0f, -9.0f / 50.0f,
+                                   2.0f / 55.0f};
+    static constexpr float bScale = 1.0f;
+    static constexpr float bError[6] = {1.0f / 360.0f, 0.0f, -128.0f / 4275.0f, -2197.0f / 75240.0f, 1.0f / 50.0f,
+                                        2.0f / 55.0f};
+};
+
+template <class Tableau>
+struct RungeKutta {
+    static constexpr bool adaptive = Tableau::embedded;
+
+    // Devuelve el paso dado
+    template <class Accel>
+    static float step(IntegratorState& s, const Accel& accel, float tolerance) {
+        constexpr int N = Tableau::stages;
+        for (int attempt = 1;; attempt++) {
+            const float dt = s.dt;
+            vec3 kv[N], ka[N];
+            kv[0] = s.vel;
+            ka[0] = s.acc;
+            for (int i = 1; i < N; i++) {
+                vec3 pos = s.pos, vel = s.vel;
+                for (int j = 0; j < i; j++) {
+                    if (Tableau::a[i][j] != 0.0f) {
+                        pos = pos + kv[j] * (dt * Tableau::a[i][j]);
+                        vel = vel + ka[j] * (dt * Tableau::a[i][j]);
+                    }
+                }
+                kv[i] = vel;
+                ka[i] = accel(pos);
+            }
+            s.evals += N - 1;
+
+            vec3 dPos = kv[0] * Tableau::b[0], dVel = ka[0] * Tableau::b[0];
+            for (int i = 1; i < N; i++) {
+                if (Tableau::b[i] == 1.0f) {
+                    dPos = dPos + kv[i];
+                    dVel = dVel + ka[i];
+                } else if (Tableau::b[i] != 0.0f) {
+                    dPos = dPos + kv[i] * Tableau::b[i];
+                    dVel = dVel + ka[i] * Tableau::b[i];
+                }
+            }
+
+            if constexpr (Tableau::embedded) {
+                vec3 ePos = kv[0] * Tableau::bError[0], eVel = ka[0] * Tableau::bError[0];
+                for (int i = 1; i < N; i++) {
+                    if (Tableau::bError[i] != 0.0f) {
+                        ePos = ePos + kv[i] * Tableau::bError[i];
+                        eVel = eVel + ka[i] * Tableau::bError[i];
+                    }
+                }
+                float error = std::max(length(ePos), length(eVel)) * dt;
+                float factor = error > 0.0f ? 0.9f * std::pow(tolerance / error, 0.2f) : 5.0f;
+                s.dt = std::clamp(dt * std::clamp(factor, 0.2f, 5.0f), RKF45_MIN_STEP, RKF45_MAX_STEP);
+                if (error > tolerance && dt > RKF45_MIN_STEP && attempt < RKF45_MAX_ATTEMPTS) continue;
+            } else {
+                (void)tolerance;
+            }
+
+            s.pos = s.pos + dPos * (dt / Tableau::bScale);
+            s.vel = s.vel + dVel * (dt / Tableau::bScale);
+            s.acc = accel(s.pos);
+            s.evals++;
+            return dt;
+        }
+    }
+};
+
+// --- Composiciones simplécticas de Verlet de velocidad (kick-drift-kick) ---
+// Cada subpaso w_i * dt es un Verlet de velocidad; con FSAL cuesta una evaluación.
+
+struct WeightsVerlet {
+    static constexpr int count = 1;
+    static constexpr float w[1] = {1.0f};
+};
+
+// Yoshida (1990): w1 = 1 / (2 - 2^(1/3)), w0 = -2^(1/3) w1; orden 4 con tres evaluaciones
+struct WeightsYoshida4 {
+    static constexpr int count = 3;
+    static constexpr float w[3] = {1.3512071919596578f, -1.7024143839193153f, 1.3512071919596578f};
+};
+
+template <class Weights>
+struct VerletComposition {
+    static constexpr bool adaptive = false;
+
+    template <class Accel>
+    static float step(IntegratorState& s, const Accel& accel, float /*tolerance*/) {
+        for (int i = 0; i < Weights::count; i++) {
+            float h = Weights::w[i] * s.dt;
+            s.vel = s.vel + s.acc * (0.5f * h);
+            s.pos = s.pos + s.vel * h;
+            s.acc = accel(s.pos);
+            s.vel = s.vel + s.acc * (0.5f * h);
+        }
+        s.evals += Weights::count;
+        return s.dt;
+    }
+};
+
+using IntegratorRK4 = RungeKutta<TableauRK4>;
+using IntegratorRKF45 = RungeKutta<TableauRKF45>;
+using IntegratorVerlet = VerletComposition<WeightsVerlet>;
+using IntegratorYoshida4 = VerletComposition<WeightsYoshida4>;
@@ -0,0 +1,92 @@
+#include <glad/gl.h>
+#include "interleave.h"
+#include <iostream>
+
+// Orden de las fases en cuartos: primero la diagonal, así dos frames seguidos ya cubren el patrón en damero
+static const int QUARTER_PHASE_ORDER[4] = {0, 3, 1, 2};
+
+InterleavedRenderer createInterleavedRenderer(int factor) {
+    InterleavedRenderer renderer;
+    renderer.factor = factor;
+    return renderer;
+}
+
+void destroyInterleavedRenderer(InterleavedRenderer& renderer, RenderTargetPool& pool) {
+    releaseRenderTarget(pool, renderer.outcomes);
+}
+
+void invalidateInterleaveHistory(InterleavedRenderer& renderer) {
+    renderer.validPhases = 0;
+}
+
+bool interleaveComplete(const InterleavedRenderer& renderer) {
+    return renderer.validPhases == (1 << renderer.factor) - 1;
+}
+
+static bool sameCamera(const CameraState& a, const CameraState& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z && a.yaw == b.yaw && a.pitch == b.pitch && a.focal == b.focal;
+}
+
+// Píxeles de una fase (los mismos que recorre phasePixel en interleave_trace.glsl)
+static uint64_t phasePixelCount(int factor, int phase, int width, int height) {
+    if (factor == 2) {
+        // Filas con el primer píxel en x = 0 y filas que empiezan en x = 1
+        uint64_t evenRows = (uint64_t)(height + 1 - phase) / 2;
+        uint64_t oddRows = (uint64_t)height - evenRows;
+        return evenRows * ((width + 1) / 2) + oddRows * (width / 2);
+    }
+    int ox = phase & 1, oy = phase >> 1;
+    return (uint64_t)((width - ox + 1) / 2) * ((height - oy + 1) / 2);
+}
+
+uint64_t dispatchInterleaved(InterleavedRenderer& renderer, RenderTargetPool& pool, unsigned int traceProgram,
+                             unsigned int resolveProgram, unsigned int outputTexture, int width, int height,
+                             const CameraState& camera) {
+    // Cámara o tamaño distintos: lo trazado antes ya no corresponde a estos píxeles
+    bool resized = renderer.outcomes.width != width || renderer.outcomes.height != height;
+    resizeRenderTarget(pool, renderer.outcomes, width, height);
+    if (resized || !sameCamera(camera, renderer.lastCamera)) {
+        if (renderer.validPhases != 0) renderer.historyResets++;
+        renderer.validPhases = 0;
+        renderer.lastCamera = camera;
+    }
+
+    int slot = (int)(renderer.frameIndex++ % renderer.factor);
+    int phase = renderer.factor == 4 ? QUARTER_PHASE_ORDER[slot] : slot;
+    renderer.validPhases |= 1 << phase;
+
+    // 1. Rayos de la fase actual (el dispatch cubre solo esos píxeles)
+    glUseProgram(traceProgram);
+    glUniform2i(glGetUniformLocation(traceProgram, "u_viewport"), width, height);
+    glUniform1i(glGetUniformLocation(traceProgram, "u_factor"), renderer.factor);
+    glUniform1i(glGetUniformLocation(traceProgram, "u_phase"), phase);
+    glBindImageTexture(0, renderer.outcomes.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    int groupsX = ((width + 1) / 2 + 7) / 8;
+    int groupsY = renderer.factor == 2 ? (height + 7) / 8 : ((height + 1) / 2 + 7) / 8;
+    glDispatchCompute(groupsX, groupsY, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // 2. Reconstrucción y sombreado de la imagen completa
+    glUseProgram(resolveProgram);
+    glUniform2i(glGetUniformLocation(resolveProgram, "u_viewport"), width, height);
+    glUniform1i(glGetUniformLocation(resolveProgram, "u_factor"), renderer.factor);
+    glUniform1i(glGetUniformLocation(resolveProgram, "u_phase"), phase);
+    glUniform1i(glGetUniformLocation(resolveProgram, "u_validPhases"), renderer.validPhases);
+    glBindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    glBindImageTexture(1, renderer.outcomes.texture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+    uint64_t traced = phasePixelCount(renderer.factor, phase, width, height);
+    renderer.frames++;
+    renderer.tracedRays += (long long)traced;
+    renderer.pixels += (long long)width * height;
+    return traced;
+}
+
+void printInterleaveStats(const InterleavedRenderer& renderer) {
+    if (renderer.pixels == 0) return;
+    const char* mode = renderer.factor == 2 ? "damero" : "cuartos";
+    std::cout << "Render entrelazado (" << mode << "): " << 100.0 * renderer.tracedRays / renderer.pixels
+              << "% rayos trazados en " << renderer.frames << " frames, historia descartada "
+              << renderer.historyResets << " veces" << std::endl;
+}
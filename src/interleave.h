@@ -0,0 +1,43 @@
+#pragma once
+#include "render_targets.h"
+#include "camera.h"
+#include <cstdint>
+
+// --- RENDER ENTRELAZADO (DAMERO / CUARTOS) ---
+// Para mantener la interactividad a resoluciones altas, cada frame solo se
+// traza una fase de un patrón rotatorio: la mitad de los píxeles (damero,
+// factor 2) o uno de cada 2x2 (factor 4). Los resultados de los rayos se
+// guardan en una textura de historia; interleave_resolve.glsl vuelve a
+// sombrear las fases anteriores si la cámara no se ha movido (resultado
+// exacto, el disco sigue animado) y si se ha movido reconstruye a partir de
+// los vecinos trazados en este frame.
+
+struct InterleavedRenderer {
+    int factor = 0;               // 0 = desactivado, 2 = damero, 4 = cuartos
+    RenderTarget outcomes;        // Historia de resultados (RGBA32F, del pool)
+    long long frameIndex = 0;     // Para rotar la fase
+    int validPhases = 0;          // Bit i = la fase i se trazó con la cámara actual
+    CameraState lastCamera;
+
+    long long frames = 0;
+    long long tracedRays = 0;
+    long long pixels = 0;
+    long long historyResets = 0;  // Frames en los que la cámara se movió (solo reconstrucción espacial)
+};
+
+InterleavedRenderer createInterleavedRenderer(int factor);
+void destroyInterleavedRenderer(InterleavedRenderer& renderer, RenderTargetPool& pool);
+
+// La historia deja de valer (p. ej. tras un frame servido desde el mapa de entorno)
+void invalidateInterleaveHistory(InterleavedRenderer& renderer);
+
+// ¿Están todas las fases trazadas con la cámara actual? Mientras no, hay que seguir dibujando.
+bool interleaveComplete(const InterleavedRenderer& renderer);
+
+// Traza la fase que toca y reconstruye la imagen en el sub-rectángulo width x height
+// de 'outputTexture'. Devuelve los rayos trazados.
+uint64_t dispatchInterleaved(InterleavedRenderer& renderer, RenderTargetPool& pool, unsigned int traceProgram,
+                             unsigned int resolveProgram, unsigned int outputTexture, int width, int height,
+                             const CameraState& camera);
+
+void printInterleaveStats(const InterleavedRenderer& renderer);
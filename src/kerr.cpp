@@ -0,0 +1,179 @@
+#include "kerr.h"
+#include <algorithm>
+#include <cmath>
+
+// Integrales primeras del rayo (E = 1)
+struct KerrConstants {
+    float a, a2;
+    float L;          // Momento angular alrededor del eje de giro
+    float Q;          // Constante de Carter
+    float K;          // Q + (L - a)^2, aparece en R(r)
+};
+
+// r, θ y sus derivadas en λ; φ solo se acumula
+struct KerrState {
+    float r, theta, phi, pr, ptheta;
+};
+
+static inline KerrState kerrAdd(const KerrState& s, const KerrState& d, float h) {
+    return {s.r + d.r * h, s.theta + d.theta * h, s.phi + d.phi * h, s.pr + d.pr * h, s.ptheta + d.ptheta * h};
+}
+
+// d/dλ del estado: r'' = R'(r) / 2, θ'' = Θ'(θ) / 2, φ' = Φ(r, θ)
+static inline KerrState kerrDerivatives(const KerrState& s, const KerrConstants& c) {
+    float r2 = s.r * s.r;
+    float sinT = std::max(std::sin(s.theta), 1e-4f);
+    float cosT = std::cos(s.theta);
+    float sin2 = sinT * sinT;
+    float P = r2 + c.a2 - c.a * c.L;
+    float delta = r2 - 2.0f * s.r + c.a2;
+
+    KerrState d;
+    d.r = s.pr;
+    d.theta = s.ptheta;
+    d.pr = 2.0f * s.r * P - (s.r - 1.0f) * c.K;
+    d.ptheta = -c.a2 * cosT * sinT + c.L * c.L * cosT / (sinT * sin2);
+    d.phi = c.a * P / delta - c.a + c.L / sin2;
+    return d;
+}
+
+static inline void stepKerrRK4(KerrState& s, const KerrConstants& c, float h) {
+    KerrState k1 = kerrDerivatives(s, c);
+    KerrState k2 = kerrDerivatives(kerrAdd(s, k1, h * 0.5f), c);
+    KerrState k3 = kerrDerivatives(kerrAdd(s, k2, h * 0.5f), c);
+    KerrState k4 = kerrDerivatives(kerrAdd(s, k3, h), c);
+    s.r += (k1.r + 2.0f * k2.r + 2.0f * k3.r + k4.r) * (h / 6.0f);
+    s.theta += (k1.theta + 2.0f * k2.theta + 2.0f * k3.theta + k4.theta) * (h / 6.0f);
+    s.phi += (k1.phi + 2.0f * k2.phi + 2.0f * k3.phi + k4.phi) * (h / 6.0f);
+    s.pr += (k1.pr + 2.0f * k2.pr + 2.0f * k3.pr + k4.pr) * (h / 6.0f);
+    s.ptheta += (k1.ptheta + 2.0f * k2.ptheta + 2.0f * k3.ptheta + k4.ptheta) * (h / 6.0f);
+}
+
+// Boyer-Lindquist -> cartesianas (esferoides oblatos, eje y)
+static inline vec3 kerrToCartesian(float r, float theta, float phi, float a2) {
+    float rho = std::sqrt(r * r + a2);
+    return {rho * std::sin(theta) * std::cos(phi), r * std::cos(theta), rho * std::sin(theta) * std::sin(phi)};
+}
+
+// Velocidad cartesiana del rayo (regla de la cadena sobre kerrToCartesian)
+static inline vec3 kerrCartesianVelocity(const KerrState& s, const KerrState& d, float a2) {
+    float rho = std::sqrt(s.r * s.r + a2);
+    float sinT = std::sin(s.theta), cosT = std::cos(s.theta);
+    float sinP = std::sin(s.phi), cosP = std::cos(s.phi);
+    float dRho = s.r * d.r / rho;
+    return {dRho * sinT * cosP + rho * cosT * cosP * d.theta - rho * sinT * sinP * d.phi,
+            d.r * cosT - s.r * sinT * d.theta,
+            dRho * sinT * sinP + rho * cosT * sinP * d.theta + rho * sinT * cosP * d.phi};
+}
+
+float kerrHorizon(float spin) {
+    return 1.0f + std::sqrt(std::max(1.0f - spin * spin, 0.0f));
+}
+
+// Posición y dirección cartesianas (unidades de M) -> estado inicial e integrales primeras.
+// La dirección se interpreta como velocidad de coordenadas; E sale de la condición nula.
+static bool kerrInitialState(const vec3& p, const vec3& d, float a, KerrState& s, KerrConstants& c) {
+    float a2 = a * a;
+    float w = dot(p, p) - a2;
+    float r2 = 0.5f * (w + std::sqrt(w * w + 4.0f * a2 * p.y * p.y));
+    s.r = std::sqrt(r2);
+    s.theta = std::acos(std::clamp(p.y / s.r, -1.0f, 1.0f));
+    s.phi = std::atan2(p.z, p.x);
+
+    // Jacobiano de kerrToCartesian: columnas d/dr, d/dθ, d/dφ; se resuelve J v = d (Cramer)
+    float rho = std::sqrt(r2 + a2);
+    float sinT = std::max(std::sin(s.theta), 1e-4f), cosT = std::cos(s.theta);
+    float sinP = std::sin(s.phi), cosP = std::cos(s.phi);
+    vec3 jr = {s.r / rho * sinT * cosP, cosT, s.r / rho * sinT * sinP};
+    vec3 jt = {rho * cosT * cosP, -s.r * sinT, rho * cosT * sinP};
+    vec3 jp = {-rho * sinT * sinP, 0.0f, rho * sinT * cosP};
+    float det = dot(jr, jt.cross(jp));
+    if (std::fabs(det) < 1e-12f) return false;
+    float rDot = dot(d, jt.cross(jp)) / det;
+    float thetaDot = dot(jr, d.cross(jp)) / det;
+    float phiDot = dot(jr, jt.cross(d)) / det;
+
+    // Métrica de Kerr (M = 1)
+    float sigma = r2 + a2 * cosT * cosT;
+    float delta = r2 - 2.0f * s.r + a2;
+    if (delta <= 0.0f) return false; // Cámara dentro del horizonte
+    float sin2 = sinT * sinT;
+    float gtt = -(1.0f - 2.0f * s.r / sigma);
+    float gtp = -2.0f * a * s.r * sin2 / sigma;
+    float gpp = (r2 + a2 + 2.0f * a2 * s.r * sin2 / sigma) * sin2;
+    float spatial = sigma / delta * rDot * rDot + sigma * thetaDot * thetaDot + gpp * phiDot * phiDot;
+
+    // ṫ > 0 de g_tt ṫ² + 2 g_tφ φ̇ ṫ + spatial = 0 (g_tt < 0 fuera de la ergosfera)
+    float disc = gtp * gtp * phiDot * phiDot - gtt * spatial;
+    if (gtt >= 0.0f || disc < 0.0f) return false;
+    float tDot = (-gtp * phiDot - std::sqrt(disc)) / gtt;
+
+    float E = -(gtt * tDot + gtp * phiDot);
+    float L = (gtp * tDot + gpp * phiDot) / E;
+    float pTheta = sigma * thetaDot / E;
+    c.a = a;
+    c.a2 = a2;
+    c.L = L;
+    c.Q = pTheta * pTheta + cosT * cosT * (L * L / sin2 - a2);
+    c.K = c.Q + (L - a) * (L - a);
+    s.pr = sigma * rDot / E;
+    s.ptheta = pTheta;
+    return true;
+}
+
+RayOutcome traceOutcomeKerr(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params) {
+    const float M = 0.5f * params.rs;
+    const float a = params.spin;
+    RayOutcome outcome;
+
+    KerrState s;
+    KerrConstants c;
+    if (!kerrInitialState(ro * (1.0f / M), normalize(rd), a, s, c)) {
+        steps = 0;
+        return outcome; // Sin condición inicial válida: se trata como capturado
+    }
+
+    const float horizon = kerrHorizon(a) * 1.01f;
+    const float escapeR = std::max(KERR_ESCAPE_R, 2.0f * s.r);
+    float prevY = s.r * std::cos(s.theta);
+
+    for (steps = 1; steps <= KERR_MAX_STEPS; steps++) {
+        KerrState prev = s;
+        // Cerca del eje el término L² / sin³θ es rígido: se acorta el paso para no saltar el punto de retorno
+        float h = KERR_STEP * s.r / (s.r * s.r + c.a2) * std::min(1.0f, 0.05f + 4.0f * std::fabs(std::sin(s.theta)));
+        stepKerrRK4(s, c, h);
+
+        // 1. Horizonte
+        if (s.r < horizon) {
+            outcome.kind = OutcomeKind::Captured;
+            return outcome;
+        }
+
+        // 2. Cruce del plano ecuatorial (y = r cos θ cambia de signo)
+        float y = s.r * std::cos(s.theta);
+        if (prevY * y < 0.0f) {
+            float t = prevY / (prevY - y);
+            KerrState hit = kerrAdd(prev, kerrAdd(s, prev, -1.0f), t);
+            vec3 hitPoint = kerrToCartesian(hit.r, 1.5707963f, hit.phi, c.a2) * M;
+            float hitDist = length(hitPoint);
+            if (hitDist > params.diskInner && hitDist < params.diskOuter) {
+                vec3 vel = kerrCartesianVelocity(s, kerrDerivatives(s, c), c.a2);
+                vec3 diskTangent = normalize({-hitPoint.z, 0.0f, hitPoint.x});
+                outcome.kind = OutcomeKind::Disk;
+                outcome.hitDist = hitDist;
+                outcome.angle = std::atan2(hitPoint.z, hitPoint.x);
+                outcome.doppler = dot(normalize(vel), diskTangent);
+                return outcome;
+            }
+        }
+        prevY = y;
+
+        // 3. Lejos y alejándose: ya no vuelve
+        if (s.r > escapeR && s.pr > 0.0f) break;
+    }
+
+    steps = std::min(steps, KERR_MAX_STEPS);
+    outcome.kind = OutcomeKind::Escaped;
+    outcome.dir = normalize(kerrCartesianVelocity(s, kerrDerivatives(s, c), c.a2));
+    return outcome;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "cpu_tracer.h"
+
+// --- MOTOR DE KERR (AGUJERO EN ROTACIÓN) ---
+// Geodésicas nulas exactas en Boyer-Lindquist con el eje de giro en y (el
+// disco sigue en el plano y = 0). Energía E, momento angular L y constante de
+// Carter Q son integrales primeras: en tiempo de Mino (dλ = dτ / Σ) solo se
+// integran r y θ (con sus ecuaciones de segundo orden, sin problemas de signo
+// en los puntos de retorno) y φ se acumula aparte. Son 5 componentes por paso
+// en lugar de las 8 de la geodésica completa. Unidades internas: M = RS / 2.
+// Mismo algoritmo que shaders/kerr.glsl.
+
+const int KERR_MAX_STEPS = 1000;   // Tope por rayo (los pasos son relativos a r, ver KERR_STEP)
+const float KERR_STEP = 0.03f;     // Paso en λ: |dr| ≈ KERR_STEP * r lejos del agujero
+const float KERR_ESCAPE_R = 100.0f;// Radio (en M) a partir del cual un rayo que se aleja ha escapado
+
+// Radio del horizonte exterior en unidades de M (spin = a / M)
+float kerrHorizon(float spin);
+
+// Igual que traceOutcome, para params.spin. 'steps' cuenta pasos de RK4 (4 evaluaciones cada uno).
+RayOutcome traceOutcomeKerr(const vec3& ro, const vec3& rd, int& steps, const BlackHoleParams& params);
@@ -0,0 +1,210 @@
+#include "lenses.h"
+#include "config.h"
+#include "cpu_tracer.h"
+#include "ray_loop.h"
+#include <glad/gl.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Alcance de una masa W: 1.5 W / d⁴ = tolerancia
+static float lensReach(float rs, float tolerance) {
+    return tolerance > 0.0f ? std::pow(1.5f * rs / tolerance, 0.25f) : FLT_MAX;
+}
+
+// Cortes por la mediana del eje más largo hasta LENS_GROUP_SIZE lentes (reordena 'lenses')
+static void splitGroups(std::vector<Lens>& lenses, int first, int count, std::vector<LensGroup>& groups) {
+    if (count <= LENS_GROUP_SIZE) {
+        LensGroup group;
+        group.first = first;
+        group.count = count;
+        groups.push_back(group);
+        return;
+    }
+    vec3 lo = lenses[first].pos, hi = lo;
+    for (int i = first; i < first + count; i++) {
+        const vec3& p = lenses[i].pos;
+        lo = {std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z)};
+        hi = {std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z)};
+    }
+    vec3 extent = hi - lo;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    auto coord = [axis](const Lens& lens) { return axis == 0 ? lens.pos.x : axis == 1 ? lens.pos.y : lens.pos.z; };
+    int half = count / 2;
+    std::nth_element(lenses.begin() + first, lenses.begin() + first + half, lenses.begin() + first + count,
+                     [&coord](const Lens& a, const Lens& b) { return coord(a) < coord(b); });
+    splitGroups(lenses, first, half, groups);
+    splitGroups(lenses, first + half, count - half, groups);
+}
+
+void buildLensField(const std::vector<Lens>& lenses, float tolerance, LensField& field) {
+    field.lenses = lenses;
+    field.tolerance = tolerance;
+    field.groups.clear();
+    if (!field.lenses.empty()) splitGroups(field.lenses, 0, (int)field.lenses.size(), field.groups);
+
+    // Nunca por debajo del horizonte: la captura solo mira los términos de la lista
+    field.reach.resize(field.lenses.size());
+    for (size_t i = 0; i < field.lenses.size(); i++) {
+        float rs = field.lenses[i].rs;
+        field.reach[i] = std::max(lensReach(rs, tolerance), rs * LENS_CAPTURE_MARGIN);
+    }
+
+    for (LensGroup& group : field.groups) {
+        // Esfera: centro de la caja y el radio que cubre a todas
+        vec3 lo = field.lenses[group.first].pos, hi = lo;
+        vec3 weighted = {0.0f, 0.0f, 0.0f};
+        float rs = 0.0f, maxRs = 0.0f;
+        for (int i = group.first; i < group.first + group.count; i++) {
+            const Lens& lens = field.lenses[i];
+            lo = {std::min(lo.x, lens.pos.x), std::min(lo.y, lens.pos.y), std::min(lo.z, lens.pos.z)};
+            hi = {std::max(hi.x, lens.pos.x), std::max(hi.y, lens.pos.y), std::max(hi.z, lens.pos.z)};
+            weighted = weighted + lens.pos * lens.rs;
+            rs += lens.rs;
+            maxRs = std::max(maxRs, lens.rs);
+        }
+        group.center = (lo + hi) * 0.5f;
+        group.radius = 0.0f;
+        for (int i = group.first; i < group.first + group.count; i++) {
+            group.radius = std::max(group.radius, length(field.lenses[i].pos - group.center));
+        }
+        group.centroid = weighted * (1.0f / rs);
+        group.rs = rs;
+
+        group.reach = tolerance > 0.0f ? group.radius + std::max(lensReach(rs, tolerance), maxRs * LENS_CAPTURE_MARGIN)
+                                       : FLT_MAX;
+        // Campo lejano: al menos a dos radios del centroide (la serie converge), con la cota por debajo de la
+        // tolerancia y sin ningún horizonte al alcance. La distancia se mide al centro de la esfera: se suma el
+        // radio para cubrir el centroide y las lentes.
+        float quadrupole = std::pow(LENS_QUADRUPOLE_BOUND * rs * group.radius * group.radius / tolerance, 1.0f / 6.0f);
+        group.far = tolerance > 0.0f && group.count > 1
+                        ? group.radius + std::max({2.0f * group.radius, quadrupole, maxRs * LENS_CAPTURE_MARGIN})
+                        : FLT_MAX;
+    }
+}
+
+bool loadLenses(const std::string& path, std::vector<Lens>& lenses) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR: No se pudo abrir el fichero de lentes: " << path << std::endl;
+        return false;
+    }
+    lenses.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.resize(comment);
+        std::istringstream fields(line);
+        Lens lens;
+        if (!(fields >> lens.pos.x)) continue; // Línea vacía
+        std::string extra;
+        if (!(fields >> lens.pos.y >> lens.pos.z >> lens.rs) || (fields >> extra)) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": se esperaba \"x y z rs\"" << std::endl;
+            return false;
+        }
+        if (lens.rs <= 0.0f) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": rs debe ser positivo" << std::endl;
+            return false;
+        }
+        lenses.push_back(lens);
+    }
+    if (lenses.empty() || (int)lenses.size() > LENS_MAX) {
+        std::cout << "ERROR: " << path << ": hace falta entre 1 y " << LENS_MAX << " lentes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<Lens> binaryLenses(float rs, float separation) {
+    return {{{-0.5f * separation, 0.0f, 0.0f}, 0.5f * rs}, {{0.5f * separation, 0.0f, 0.0f}, 0.5f * rs}};
+}
+
+std::vector<Lens> microlensField(float rs, int count) {
+    std::vector<Lens> lenses = {{{0.0f, 0.0f, 0.0f}, rs}};
+    // LCG propio: la misma escena en todas las plataformas
+    uint32_t state = 12345u;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    };
+    while ((int)lenses.size() < count) {
+        // Estrellas de rs / 25 en una corteza de radio 4 a 10, sin tapar al agujero
+        vec3 p = {next() * 20.0f - 10.0f, next() * 8.0f - 4.0f, next() * 20.0f - 10.0f};
+        float r = length(p);
+        if (r < 4.0f || r > 10.0f) continue;
+        lenses.push_back({p, rs * 0.04f});
+    }
+    return lenses;
+}
+
+bool lensFieldFromConfig(const AppConfig& config, std::shared_ptr<const LensField>& field) {
+    field.reset();
+    std::vector<Lens> lenses;
+    if (!config.lensesPath.empty()) {
+        if (!loadLenses(config.lensesPath, lenses)) return false;
+    } else if (config.binarySeparation > 0.0f) {
+        lenses = binaryLenses(RS, config.binarySeparation);
+    } else {
+        return true;
+    }
+    auto built = std::make_shared<LensField>();
+    buildLensField(lenses, config.lensTolerance, *built);
+    std::cout << "Escena con " << built->lenses.size() << " lentes en " << built->groups.size() << " grupos"
+              << std::endl;
+    field = built;
+    return true;
+}
+
+RayOutcome traceOutcomeMultiLens(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                 const BlackHoleParams& params) {
+    switch (params.integrator) {
+        case IntegratorKind::Verlet:
+            return traceIntegrated<IntegratorVerlet, SpacetimeMultiLens>(ro, rd, steps, evals, params);
+        case IntegratorKind::Yoshida4:
+            return traceIntegrated<IntegratorYoshida4, SpacetimeMultiLens>(ro, rd, steps, evals, params);
+        case IntegratorKind::RKF45:
+            return traceIntegrated<IntegratorRKF45, SpacetimeMultiLens>(ro, rd, steps, evals, params);
+        case IntegratorKind::RK4:
+        default: return traceIntegrated<IntegratorRK4, SpacetimeMultiLens>(ro, rd, steps, evals, params);
+    }
+}
+
+// std430: cada struct se alinea a 16 bytes (como un vec4)
+struct LensGroupGpu {
+    float center[3], reach;
+    float centroid[3], rs;
+    float far, pad;
+    int32_t first, count;
+};
+
+struct LensGpu {
+    float pos[3], rs;
+    float reach, pad[3];
+};
+
+void uploadLensField(const LensField& field, unsigned int buffers[2]) {
+    std::vector<LensGroupGpu> groups;
+    for (const LensGroup& g : field.groups) {
+        groups.push_back({{g.center.x, g.center.y, g.center.z}, g.reach, {g.centroid.x, g.centroid.y, g.centroid.z},
+                          g.rs, g.far, 0.0f, g.first, g.count});
+    }
+    std::vector<LensGpu> lenses;
+    for (size_t i = 0; i < field.lenses.size(); i++) {
+        const Lens& lens = field.lenses[i];
+        lenses.push_back({{lens.pos.x, lens.pos.y, lens.pos.z}, lens.rs, field.reach[i], {0.0f, 0.0f, 0.0f}});
+    }
+
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[0]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, groups.size() * sizeof(LensGroupGpu), groups.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[1]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, lenses.size() * sizeof(LensGpu), lenses.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    // Fijos durante toda la ejecución: se conectan una vez
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, buffers[0]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, buffers[1]);
+}
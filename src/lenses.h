@@ -0,0 +1,157 @@
+#pragma once
+#include "vec3.h"
+#include "spacetime.h"
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct AppConfig;
+
+// --- ESCENAS CON VARIAS LENTES (BINARIAS, CAMPOS DE MICROLENTES) ---
+// La deflexión se superpone: cada agujero aporta su término pseudo-newtoniano
+// a = -1.5 rs d / |d|⁵ (d = posición relativa a la lente). Sumarlos todos en
+// cada evaluación multiplica el coste por el número de lentes, así que:
+//   - Alcance: el término de una lente cae como 1.5 rs / d⁴; por encima de
+//     d = (1.5 rs / tolerancia)^(1/4) se descarta.
+//   - Grupos: las lentes se reparten en esferas envolventes (cortes por la
+//     mediana, hasta LENS_GROUP_SIZE por grupo). Un grupo lejano (campo lejano)
+//     cuenta como una sola lente con la suma de rs en su centroide ponderado: el
+//     término dipolar se anula y el resto está acotado por 15 W R² / d⁶ (W = Σ rs,
+//     R = radio del grupo), así que se agrupa cuando esa cota ya está por debajo
+//     de la tolerancia.
+//   - Lista por rayo: la poda no se hace en cada evaluación. Cada rayo guarda los
+//     términos que cuentan en una bola de radio LENS_LIST_RADIUS alrededor de un
+//     ancla y solo la rehace al salir de ella (una lista de vecinos, como en
+//     dinámica molecular). Una evaluación cuesta una distancia más sus términos.
+// La tolerancia es una aceleración. Con 1e-4, en el campo de 32 microlentes del
+// benchmark la dirección de salida se desvía una mediana de 5e-4 rad (1e-2 en
+// los rayos que rozan una microlente); con 1e-5, una mediana de 0. Con
+// tolerancia 0 no se poda nada.
+// El disco sigue en el plano y = 0 alrededor del origen (con una binaria
+// centrada, un disco circumbinario). En la GPU, los mismos grupos llegan en dos
+// SSBO (bindings 4 y 5) a la permutación LENSES de blackhole_common.glsl, que
+// guarda la lista en registros (16 términos; si no caben, recorre los grupos).
+
+const int LENS_GROUP_SIZE = 4;
+const int LENS_MAX = 256;
+const float LENS_DEFAULT_TOLERANCE = 1e-4f;
+const float LENS_QUADRUPOLE_BOUND = 15.0f;  // |error del término agrupado| <= 15 W R² / d⁶
+const float LENS_CAPTURE_MARGIN = 1.01f;    // Como el horizonte del agujero único
+const float LENS_LIST_RADIUS = 0.5f;        // Radio de la bola en la que vale la lista de un rayo
+
+struct Lens {
+    vec3 pos;
+    float rs;
+};
+
+// Distancias medidas desde el centro de la esfera del grupo
+struct LensGroup {
+    vec3 center;        // Esfera envolvente de las lentes del grupo
+    float radius;
+    vec3 centroid;      // Centro ponderado por rs: ahí se anula el dipolo
+    float rs;           // Σ rs
+    float reach;        // Más lejos el grupo entero no cuenta
+    float far;          // Más lejos, un solo término en el centroide (y ningún horizonte al alcance)
+    int first, count;   // Rango en LensField::lenses
+};
+
+struct LensField {
+    std::vector<Lens> lenses;     // Ordenadas por grupo
+    std::vector<float> reach;     // Alcance de cada lente (nunca menor que su horizonte)
+    std::vector<LensGroup> groups;
+    float tolerance = LENS_DEFAULT_TOLERANCE;
+};
+
+// Agrupa 'lenses' y precalcula alcances (tolerancia <= 0: sin poda ni campo lejano)
+void buildLensField(const std::vector<Lens>& lenses, float tolerance, LensField& field);
+
+// Fichero de texto: una lente por línea, "x y z rs" ('#' empieza un comentario).
+// Informa por consola y devuelve false si el fichero no vale.
+bool loadLenses(const std::string& path, std::vector<Lens>& lenses);
+// Dos agujeros de rs / 2 (la misma masa total que el agujero único) en (±separación / 2, 0, 0)
+std::vector<Lens> binaryLenses(float rs, float separation);
+// Agujero de rs en el origen y 'count' - 1 microlentes deterministas alrededor (benchmark)
+std::vector<Lens> microlensField(float rs, int count);
+
+// La escena de --lenses / --binary (nullptr si no hay ninguna). False si el fichero no vale.
+bool lensFieldFromConfig(const AppConfig& config, std::shared_ptr<const LensField>& field);
+
+// SSBO de los grupos (binding 4) y de las lentes (binding 5) para la permutación LENSES
+void uploadLensField(const LensField& field, unsigned int buffers[2]);
+
+// Política del motor pseudo-newtoniano (como las de spacetime.h) para una escena con varias lentes.
+// Se construye una por rayo: la lista de términos es estado del rayo (mutable, porque accel()
+// es const para el integrador).
+struct SpacetimeMultiLens {
+    static constexpr SpacetimeKind kind = SpacetimeKind::MultiLens;
+    static constexpr bool barrier = false;      // Sin simetría central no hay clasificación previa
+    static constexpr bool escapeRadius = false;
+    static constexpr bool centered = false;     // El horizonte es el de cada lente: captured()
+    const LensField& field;
+    float rs, horizon, escape;                  // Sin uso: la captura y la energía van por lente
+
+    struct Term {
+        vec3 pos;
+        float rs;
+        float horizon2;  // 0 en los términos de campo lejano
+    };
+    mutable vec3 anchor;
+    mutable bool listed = false;
+    mutable int termCount = 0;
+    mutable Term terms[LENS_MAX];
+
+    SpacetimeMultiLens(float /*rs*/, float /*charge*/, float /*lambda*/, const LensField* lenses)
+        : field(*lenses), rs(0.0f), horizon(0.0f), escape(FLT_MAX) {}
+
+    // Términos que cuentan en algún punto de la bola de radio LENS_LIST_RADIUS alrededor de 'pos'
+    void buildList(const vec3& pos) const {
+        anchor = pos;
+        listed = true;
+        termCount = 0;
+        for (const LensGroup& group : field.groups) {
+            float d = length(pos - group.center) - LENS_LIST_RADIUS;
+            if (d > group.reach) continue;
+            if (d > group.far) {
+                terms[termCount++] = {group.centroid, group.rs, 0.0f};
+                continue;
+            }
+            for (int i = group.first; i < group.first + group.count; i++) {
+                const Lens& lens = field.lenses[i];
+                if (length(pos - lens.pos) - LENS_LIST_RADIUS > field.reach[i]) continue;
+                float h = lens.rs * LENS_CAPTURE_MARGIN;
+                terms[termCount++] = {lens.pos, lens.rs, h * h};
+            }
+        }
+    }
+    vec3 accel(const vec3& pos) const {
+        vec3 moved = pos - anchor;
+        if (!listed || dot(moved, moved) > LENS_LIST_RADIUS * LENS_LIST_RADIUS) buildList(pos);
+        vec3 acc = {0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < termCount; i++) {
+            vec3 d = pos - terms[i].pos;
+            float r2 = dot(d, d);
+            float r = std::sqrt(r2);
+            acc = acc + d * (-1.5f * terms[i].rs / (r2 * r2 * r));
+        }
+        return acc;
+    }
+    // Tras cada paso la lista ya vale para 'pos' (la última evaluación del integrador es ahí)
+    bool captured(const vec3& pos) const {
+        for (int i = 0; i < termCount; i++) {
+            vec3 d = pos - terms[i].pos;
+            if (dot(d, d) < terms[i].horizon2) return true;
+        }
+        return false;
+    }
+    // Φ = Σ -rs / (2 d³), sin podar (solo lo usa --null-renorm, una vez por paso)
+    float potential(const vec3& pos) const {
+        float phi = 0.0f;
+        for (const Lens& lens : field.lenses) {
+            float d = length(pos - lens.pos);
+            phi -= 0.5f * lens.rs / (d * d * d);
+        }
+        return phi;
+    }
+};
@@ -1,67 +1,104 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <cmath>
-// DEFINIR ESTO SOLO EN UN ARCHIVO .CPP ANTES DE INCLUIR LA LIBRERÍA
-#define STB_IMAGE_IMPLEMENTATION 
-#include "stb_image.h" // Asegúrate de que esté en tu carpeta include
+#include "config.h"
+#include "gl_renderer.h"
+#include "scheduler.h"
+#include "camera.h"
+#include "camera_path.h"
+#include "timing_report.h"
+#include "headless.h"
+#include "farm.h"
+#include "sweep.h"
+#include "metrics.h"
+#include "trace.h"
+#include "skybox_cache.h"
 
 // --- CONFIGURACIÓN DE LA SIMULACIÓN ---
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 600;
 
-//--- ESTRUCTURA MATEMÁTICA VECTORIAL ---
-struct vec3 {
-    float x,y,z;
-
-    //Sobrecarga de operadores para facilitar las matemáticas
-    vec3 operator+(const vec3& v) const {return {x + v.x, y + v.y, z + v.z};}
-    vec3 operator-(const vec3& v) const {return {x - v.x, y - v.y, z - v.z};}
-    vec3 operator*(float s) const {return {x * s, y * s, z * s};}
-
-    //Necesario para la física: Producto Cruz
-    vec3 cross(const vec3& v) const {
-        return{y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x};
-    }
+// --- ESTADO DE LA VENTANA ---
+// Lo que cambian la entrada y los callbacks de GLFW (que lo encuentran con glfwGetWindowUserPointer).
+// El trazado vive en gl_renderer.h: la ventana solo decide qué cámara y cuándo.
+struct WindowState {
+    // Empezamos alejados en Z, frente al agujero (valores por defecto de camera.h).
+    // El ratón (botón derecho) añade giro y la rueda cambia la distancia focal (zoom).
+    CameraState camera;
+    double lastMouseX = 0.0, lastMouseY = 0.0;
+
+    // Modo 360°: el cubemap de resultados hace casi gratis girar la vista
+    bool envMapMode = false;
+    bool envMapSupported = true; // No con --disk-opacity < 1 (ver GlRenderer::envMapSupported)
+
+    // --- RENDER BAJO DEMANDA ---
+    FrameScheduler scheduler;
 };
 
-//Funciones auxiliares para vectores
-float dot(const vec3& a, const vec3& b){return a.x*b.x + a.y*b.y + a.z*b.z;}
-float length_sq(const vec3& v){return dot(v,v);}
-float length(const vec3& v){return std::sqrt(length_sq(v));}
+static WindowState& windowState(GLFWwindow* window) {
+    return *static_cast<WindowState*>(glfwGetWindowUserPointer(window));
+}
 
-vec3 normalize(const vec3& v){
-    float len = length(v);
-    return (len > 0) ? vec3{v.x/len, v.y/len, v.z/len} : vec3{0,0,0};
+// Callback para redimensionar la ventana
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    glViewport(0, 0, width, height);
+    markDirty(windowState(window).scheduler);
 }
 
-// --- MOTOR DE FÍSICA RELATIVISTA (CPU) ---
+// Minimizada: el planificador deja de trazar hasta que vuelva
+void window_iconify_callback(GLFWwindow* window, int iconified) {
+    FrameScheduler& scheduler = windowState(window).scheduler;
+    scheduler.iconified = iconified;
+    markDirty(scheduler);
+}
 
-//Constantes físicas del sistema (Unidades Naturales: G=1, c=1)
-const float RS = 0.5f; // Radio de Schwarzschild (Horizonte de eventos)
-const float ISCO = 3.0f * RS; // Órbita Circular Estable Más Interna (para el disco)
+// Sin foco: el planificador limita la frecuencia
+void window_focus_callback(GLFWwindow* window, int focused) {
+    windowState(window).scheduler.focused = focused;
+}
 
-// --- VARIABLES GLOBALES DE LA CÁMARA ---
-// Empezamos alejados en Z (frente al agujero)
-float camX = 0.0f;
-float camY = 0.0f;
-float camZ = 5.0f; // 5 unidades de distancia
+// Teclas de "una pulsación" (processInput solo sirve para teclas mantenidas)
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    WindowState& state = windowState(window);
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        state.scheduler.animateDisk = !state.scheduler.animateDisk;
+        markDirty(state.scheduler);
+        std::cout << "Animación del disco: " << (state.scheduler.animateDisk ? "activada" : "congelada") << std::endl;
+    }
+    if (key == GLFW_KEY_M && action == GLFW_PRESS && !state.envMapSupported) {
+        std::cout << "Modo mapa de entorno (360°): no disponible, --disk-opacity no admite --envmap" << std::endl;
+    } else if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        state.envMapMode = !state.envMapMode;
+        markDirty(state.scheduler);
+        std::cout << "Modo mapa de entorno (360°): " << (state.envMapMode ? "activado" : "desactivado") << std::endl;
+    }
+}
 
-// --- VARIABLES DE TIEMPO ---
-float deltaTime = 0.0f; // Tiempo entre frames
-float lastFrame = 0.0f; // Tiempo del frame anterior
+// Mirar con el ratón: arrastrar con el botón derecho gira la cámara
+void cursor_position_callback(GLFWwindow* window, double x, double y) {
+    WindowState& state = windowState(window);
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+        const float sensitivity = 0.005f; // radianes por píxel
+        state.camera.yaw -= float(x - state.lastMouseX) * sensitivity;
+        state.camera.pitch -= float(y - state.lastMouseY) * sensitivity;
+        markDirty(state.scheduler);
+    }
+    state.lastMouseX = x;
+    state.lastMouseY = y;
+}
 
-// Callback para redimensionar la ventana
-void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
-    glViewport(0, 0, width, height);
+// La rueda cambia la distancia focal (FOV)
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+    WindowState& state = windowState(window);
+    state.camera.focal = std::fmin(std::fmax(state.camera.focal * std::pow(1.1f, (float)yoffset), 0.5f), 8.0f);
+    markDirty(state.scheduler);
 }
 
 // Procesar entrada del usuario
-void processInput(GLFWwindow *window, float dt) {
+void processInput(GLFWwindow *window, CameraState& camera, float dt) {
     if(glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
@@ -72,209 +109,78 @@ void processInput(GLFWwindow *window, float dt) {
         float speed = 2.5f * dt;
 
         // Movimiento básico (sin delta time por ahora)
-        if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) camZ -= speed; // Acercarse
-        if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camZ += speed; // Alejarse
-        if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camX -= speed; // Izquierda
-        if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camX += speed; // Derecha
-        if(glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) camY += speed; // Subir
-        if(glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) camY -= speed; // Bajar
+        if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) camera.z -= speed; // Acercarse
+        if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camera.z += speed; // Alejarse
+        if(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camera.x -= speed; // Izquierda
+        if(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.x += speed; // Derecha
+        if(glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) camera.y += speed; // Subir
+        if(glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) camera.y -= speed; // Bajar
             
 }
 
-// Función auxiliar para leer y compilar shaders
-unsigned int createShaderProgram(const char* vertexPath, const char* fragmentPath) {
-    // 1. Recuperar el código fuente de los archivos
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-
-    // Asegurar que los objetos ifstream pueden lanzar excepciones
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    try {
-        // Abrir archivos
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // Leer buffer del archivo al stream
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // Cerrar manejadores de archivo
-        vShaderFile.close();
-        fShaderFile.close();
-        // Convertir stream a string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-    }
-    catch (std::ifstream::failure& e) {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        return 0;
-    }
-
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-
-    // 2. Compilar shaders
-    unsigned int vertex, fragment;
-    int success;
-    char infoLog[512];
-
-    // Vertex Shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    // Imprimir errores de compilación si los hay
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+int main(int argc, char** argv) {
+    AppConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return -1;
     }
 
-    // Fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+    // Conversor de la caché del cielo: no necesita ventana
+    if (!config.convertSkyboxPath.empty()) {
+        return convertSkybox(config.convertSkyboxPath, skyboxCachePath(config.convertSkyboxPath)) ? 0 : -1;
     }
 
-    // Shader Program
-    unsigned int ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
-    // Imprimir errores de linkado
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(ID, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
+    // Línea de tiempo: hay que activarla antes de cargar nada
+    if (!config.tracePath.empty()) startTrace();
 
-    // Borrar los shaders ya que están linkados en el programa y ya no son necesarios
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    // Métricas para monitorizar trabajos largos (se sirven desde su propio hilo)
+    MetricsServer metricsServer;
+    bool metricsEnabled = config.metricsPort > 0;
+    if (metricsEnabled && !startMetricsServer(metricsServer, config.metricsPort)) return -1;
 
-    return ID;
-}
-
-// Crea una textura de alta precisión (32-bit Float) para escritura arbitraria
-unsigned int createComputeTexture(int width, int height){
-    unsigned int texID;
-    glGenTextures(1, &texID);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texID);
-
-    // GL_RGBA32F: Aquí está la clave. 32 bits flotantes por canal (R,G,B,A).
-    // Pasamos NULL al final porque no estamos copiando una imagen desde la CPU,
-    // solo reservamos la memoria en la GPU.
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
-
-    // Filtros básicos
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-    // --- MAGIA DE COMPUTE SHADER ---
-    // glBindImageTexture conecta la textura a una "Image Unit" (unidad de imagen).
-    // Esto permite que el shader escriba en ella usando imageStore().
-    // 0 = Binding Unit (debe coincidir con el shader: layout(rgba32f, binding = 0))
-    // GL_WRITE_ONLY = El shader solo escribirá en ella (optimización).
-    glBindImageTexture(0, texID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-
-    return texID;
-}
-
-unsigned int createComputeShaderProgram(const char* computePath){
-    // 1. Leer el archivo
-    std::string computeCode;
-    std::ifstream cShaderFile;
-    cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try{
-        cShaderFile.open(computePath);
-        std::stringstream cShaderStream;
-        cShaderStream << cShaderFile.rdbuf();
-        cShaderFile.close();
-        computeCode = cShaderStream.str();
+    // Sin ventana: trazador de CPU reproduciendo un recorrido
+    if (config.benchBackground) {
+        return runBackgroundBenchmark(config);
     }
-    catch(std::ifstream::failure& e){
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        return 0;
+    if (config.benchDisk) {
+        return runDiskNoiseBenchmark(config);
     }
-    const char* cShaderCode = computeCode.c_str();
-
-    // 2. Compilar (GL_COMPUTE_SHADER)
-    unsigned int computeShader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(computeShader, 1, &cShaderCode, NULL);
-    glCompileShader(computeShader);
-
-    // Comprobar errores
-    int success;
-    char infoLog[512];
-    glGetShaderiv(computeShader, GL_COMPILE_STATUS, &success);
-    if(!success){
-        glGetShaderInfoLog(computeShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+    if (config.benchNuma) {
+        return runNumaBenchmark(config);
     }
-
-    // 3. Crear programa
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, computeShader);
-    glLinkProgram(shaderProgram);
-
-    // Comprobar errores de linkado
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if(!success){
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::COMPUTE::LINKING_FAILED\n" << infoLog << std::endl;
+    if (config.benchEngines) {
+        return runEngineBenchmark(config);
     }
-
-    glDeleteShader(computeShader);
-
-    return shaderProgram;
-}
-
-unsigned int loadTexture(const char* path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    // stb_image carga la imagen. "0" fuerza a mantener los canales originales.
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    
-    if (data) {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        // Subimos los datos a la GPU
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Configuración de envoltorio (Wrapping)
-        // GL_REPEAT es crucial para que el cielo sea continuo si giramos 360 grados
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Evita artefactos en los polos
-        
-        // Filtrado lineal para que no se vea pixelado
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data); // Liberamos la memoria RAM (ya está en VRAM)
-        std::cout << "Textura cargada correctamente: " << path << std::endl;
-    } else {
-        std::cout << "ERROR: No se pudo cargar la textura: " << path << std::endl;
-        stbi_image_free(data);
+    if (config.benchIntegrators) {
+        return runIntegratorBenchmark(config);
+    }
+    if (config.benchFastMath) {
+        return runFastMathBenchmark(config);
+    }
+    if (!config.sweepPath.empty()) {
+        int result = runSweep(config);
+        writeTrace(config.tracePath);
+        return result;
+    }
+    if (config.farmCoordinatorPort > 0) {
+        int result = runFarmCoordinator(config, argv[0]);
+        writeTrace(config.tracePath);
+        return result;
+    }
+    if (!config.farmWorker.empty()) {
+        int result = runFarmWorker(config);
+        writeTrace(config.tracePath);
+        return result;
+    }
+    if (config.headless) {
+        int result = runHeadless(config);
+        writeTrace(config.tracePath);
+        return result;
     }
 
-    return textureID;
-}
+    // --lenses / --binary: la escena se lee antes de abrir la ventana (el fichero puede no valer)
+    std::shared_ptr<const LensField> lensField;
+    if (!lensFieldFromConfig(config, lensField)) return -1;
 
-int main() {
     // Inicializar GLFW
     if (!glfwInit()) {
         std::cerr << "ERROR: No se pudo inicializar GLFW" << std::endl;
@@ -287,14 +193,26 @@ int main() {
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     // Crear ventana
-    GLFWwindow* window = glfwCreateWindow(800, 600, "BlackHoleSim - Simulador de Agujero Negro", NULL, NULL);
+    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "BlackHoleSim - Simulador de Agujero Negro", NULL, NULL);
     if (window == NULL) {
         std::cerr << "ERROR: No se pudo crear la ventana GLFW" << std::endl;
         glfwTerminate();
         return -1;
     }
+    WindowState state;
+    FrameScheduler& scheduler = state.scheduler;
+    glfwSetWindowUserPointer(window, &state);
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowIconifyCallback(window, window_iconify_callback);
+    glfwSetWindowFocusCallback(window, window_focus_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCursorPosCallback(window, cursor_position_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    scheduler.animateDisk = config.animateDisk;
+    scheduler.backgroundFps = config.backgroundFps;
+    state.envMapMode = config.envMapMode;
 
     // Cargar GLAD (glad2 API)
     if (!gladLoadGL(glfwGetProcAddress)) {
@@ -304,104 +222,77 @@ int main() {
 
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
 
-    // Shader de pantalla "simple" que solo muestra la textura del compute shader
-    unsigned int screenProgram = createShaderProgram("../shaders/vertex_core.glsl", "../shaders/fragment_screen.glsl");
-    if (screenProgram == 0) {
-        std::cerr << "ERROR: No se pudo cargar screenProgram" << std::endl;
-        return -1;
-    }
-    std::cout << "✓ Screen shaders cargados correctamente" << std::endl;
-
-    //DEFINE EL LIENZO (Pantalla completa cuádruple)
-    //Dos triángulos que cubren toda la pantalla de -1 a 1
-    float vertices[] = {
-        //posiciones (x, y)
-        -1.0f, 1.0f,  //Arriba a la izquierda
-        -1.0f, -1.0f,  //Abajo a la izquierda
-        1.0f, -1.0f,   //Abajo a la derecha
-        
-        -1.0f, 1.0f,  //Arriba a la izquierda
-        1.0f, -1.0f,  //Abajo a la derecha
-        1.0f, 1.0f,   //Arriba a la derecha
-    };
-
-    //CONFIGURAR BUFFERS
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    //Indica a OpenGL cómo leer los atributos (solo posición: 2 flotantes)
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    const float RENDER_SCALE = 0.25f;
-
-    // 1. Cargar el Compute Shader (El "Cerebro" matemático)
-    unsigned int computeProgram = createComputeShaderProgram("../shaders/raytracing.glsl");
-    if (computeProgram == 0) {
-        std::cerr << "ERROR: No se pudo cargar computeProgram" << std::endl;
-        return -1;
-    }
-    std::cout << "✓ Compute shader cargado correctamente" << std::endl;
+    // VSync configurable: 0 reduce la latencia a costa de tearing
+    glfwSwapInterval(config.swapInterval);
+    std::cout << "Swap interval: " << config.swapInterval << ", frames en vuelo: " << config.framesInFlight << std::endl;
 
-    // Cargar el shader de desenfoque (Bloom)
-    unsigned int blurProgram = createComputeShaderProgram("../shaders/blur.glsl");
-    if (blurProgram == 0) {
-        std::cerr << "ERROR: No se pudo cargar blurProgram" << std::endl;
+    // Shaders, cielo, ruido del disco y render targets (gl_renderer.h)
+    GlRenderer renderer;
+    if (!createGlRenderer(renderer, config, lensField, WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        destroyGlRenderer(renderer);
+        glfwTerminate();
         return -1;
     }
-    std::cout << "✓ Blur shader cargado correctamente" << std::endl;
-
-    // 2. Crear la Textura de Cómputo (El "Papel" donde escribirá)
-    unsigned int computeTexture = createComputeTexture(WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    unsigned int blurTexture = createComputeTexture(WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    // 3. Activar el shader una vez para configurar uniformes estáticos (si los hubiera)
-    glUseProgram(computeProgram);
+    state.envMapSupported = renderer.envMapSupported;
 
     int currentWidth = WINDOW_WIDTH;
     int currentHeight = WINDOW_HEIGHT;
 
-    // 1. Cargar la textura del cielo
-    // Asegúrate de poner la ruta correcta a tu imagen.
-    unsigned int skyboxTexture = loadTexture("../textures/background.jpg"); 
-
-    // 2. Configurar el shader para usarla
-    glUseProgram(computeProgram);
-    // Le decimos al shader que la variable "skybox" leerá de la Unidad de Textura 0
-    glUniform1i(glGetUniformLocation(computeProgram, "skybox"), 0);
+    // --- VARIABLES DE TIEMPO ---
+    float deltaTime = 0.0f;     // Tiempo entre frames
+    float lastFrame = 0.0f;     // Tiempo del frame anterior
+    float animationTime = 0.0f; // Tiempo de la animación del disco (se detiene con la tecla P)
+
+    LatencyLog latencyLog;
+    if (!config.latencyLogPath.empty()) openLatencyLog(latencyLog, config.latencyLogPath);
+
+    // Recorridos de cámara: grabar lo que hace el usuario o reproducir con dt fijo
+    CameraPathRecorder recorder;
+    if (!config.recordPath.empty() && !openCameraPathRecorder(recorder, config.recordPath, config.fixedDt)) return -1;
+
+    CameraPath replayPath;
+    size_t replayIndex = 0;
+    bool replaying = !config.replayPath.empty();
+    if (replaying && !loadCameraPath(config.replayPath, replayPath)) return -1;
+    scheduler.replaying = replaying;
+
+    // Tiempos por frame: CPU con el reloj de GLFW, GPU con una query GL_TIME_ELAPSED por frame
+    // (el renderer las lee cuando la GPU ya las tiene listas, sin bloquear el bucle).
+    TimingReport timingReport;
+    std::vector<double> frameCpuMs;
+    std::vector<double> frameWaitMs;
+    bool measureFrames = replaying || !config.reportPath.empty();
+    renderer.queryGpuTime = measureFrames || metricsEnabled;
+    renderer.keepGpuTimes = measureFrames;
 
     //Loop de renderizado
     while (!glfwWindowShouldClose(window)) {
+        TRACE_SCOPE("frame");
+
+        // 0. Limitar frames en vuelo ANTES de leer la entrada: si esperamos a la GPU
+        // después de muestrear, la cámara ya estaría vieja al llegar al dispatch.
+        double frameStartTime = glfwGetTime();
+        {
+            TRACE_SCOPE("waitFrameSlot");
+            waitGlFrameSlot(renderer);
+        }
+        double slotWait = glfwGetTime() - frameStartTime;
+        observeMetric(MetricHistogram::FrameSlotWait, slotWait);
+        {
+            TRACE_SCOPE("pollEvents");
+            glfwPollEvents();
+        }
 
         // 1. Detectar cambio de resolución
         int newWidth, newHeight;
         glfwGetFramebufferSize(window, &newWidth, &newHeight);
 
-        // Si la ventana ha cambiado de tamaño (y no está minimizada a 0)
+        // Si la ventana ha cambiado de tamaño (y no está minimizada a 0): el renderer
+        // ajusta sus texturas al trazar con el tamaño nuevo
         if ((newWidth != currentWidth || newHeight != currentHeight) && newWidth > 0 && newHeight > 0) {
-            
-            // Actualizamos las variables
             currentWidth = newWidth;
             currentHeight = newHeight;
-            
-            // Ajustamos el puerto de visión de OpenGL
             glViewport(0, 0, currentWidth, currentHeight);
-
-            // --- REINICIO DE TEXTURAS ---
-            // Borramos las viejas para liberar memoria
-            glDeleteTextures(1, &computeTexture);
-            glDeleteTextures(1, &blurTexture); 
-
-            // Creamos las nuevas con el tamaño gigante
-            computeTexture = createComputeTexture(currentWidth, currentHeight);
-            blurTexture = createComputeTexture(currentWidth, currentHeight);
         }
 
         // --- 1. CÁLCULO DEL TIEMPO ---
@@ -409,86 +300,84 @@ int main() {
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // --- FASE DE CÓMPUTO ---
-        glUseProgram(computeProgram);
-
-        // Enviamos el tiempo para animaciones futuras
-        glUniform1f(glGetUniformLocation(computeProgram, "u_time"), (float)glfwGetTime());
-        
-        // Enviar posición de la cámara al shader
-        glUniform3f(glGetUniformLocation(computeProgram, "u_camPos"), camX, camY, camZ);
-
-        // ACTIVAR LA TEXTURA DEL CIELO
-        glActiveTexture(GL_TEXTURE0); // Activamos la unidad 0
-        glBindTexture(GL_TEXTURE_2D, skyboxTexture); // Ponemos nuestra foto ahí
-
-        // ¡LANZAMIENTO!
-        glDispatchCompute((currentWidth + 7) / 8, (currentHeight + 7) / 8, 1);
-
-        // --- BARRERA DE MEMORIA (CRÍTICO) ---
-        // Esto le dice a la GPU: "No empieces a dibujar píxeles (Fragment Shader)
-        // hasta que el Compute Shader haya terminado de escribir en la textura".
-        // Sin esto, verías parpadeos o basura porque leerías la textura mientras se escribe.
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-        // --- FASE 2: POST-PROCESADO (BLOOM / BLUR) ---
-        glUseProgram(blurProgram);
-
-        // A. Conectar Entrada (La imagen nítida que acabamos de calcular)
-        // Binding 0 = Lectura (GL_READ_ONLY) -> computeTexture
-        glBindImageTexture(0, computeTexture, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-
-        // B. Conectar Salida (El lienzo vacío para la imagen borrosa)
-        // Binding 1 = Escritura (GL_WRITE_ONLY) -> blurTexture
-        glBindImageTexture(1, blurTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-
-        // C. ¡Lanzamiento! (Mismos grupos que antes porque la resolución es la misma)
-        glDispatchCompute((currentWidth + 7) / 8, (currentHeight + 7) / 8, 1);
-
-        // D. Barrera de Memoria
-        // Esperamos a que el desenfoque termine antes de dibujar en pantalla
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-        
-        // --- 2. PROCESAR LA ENTRADA (Le pasamos el tiempo calculado) ---
-        processInput(window, deltaTime);
-
-        // 1. Obtener tamaño real
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
+        // --- 2. PROCESAR LA ENTRADA (justo antes del dispatch: cámara del frame actual) ---
+        CameraState& camera = state.camera;
+        double inputTime = glfwGetTime();
+        if (replaying) {
+            // Reproducción: la cámara sale de la grabación y el tiempo avanza con dt fijo.
+            // El frame solo se da por consumido si se traza (minimizada se vuelve a intentar).
+            if (replayIndex >= replayPath.frames.size()) {
+                glfwSetWindowShouldClose(window, true);
+                break;
+            }
+            const CameraPathFrame& pathFrame = replayPath.frames[replayIndex];
+            camera = pathFrame.camera;
+            scheduler.animateDisk = pathFrame.animateDisk;
+            deltaTime = replayPath.fixedDt;
+            markDirty(scheduler); // Cada frame de la grabación se traza, aunque se repita
+            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
+        } else {
+            processInput(window, camera, deltaTime);
+        }
 
-        // Evitar división por cero al minimizar
-        if (width == 0 || height == 0){
-            glfwWaitEvents();
+        // --- 2b. ¿HACE FALTA TRAZAR? ---
+        // Se decide antes de lanzar nada a la GPU: minimizada, sin cambios o sin foco
+        // no gastamos ni un dispatch. La espera por eventos tiene tope para que
+        // deltaTime no se dispare al volver a pulsar una tecla.
+        if (decideFrame(scheduler, camera.x, camera.y, camera.z, newWidth, newHeight, inputTime) != FrameDecision::Render) {
+            TRACE_SCOPE("waitEvents");
+            glfwWaitEventsTimeout(scheduler.waitTime);
             continue;
         }
+        if (replaying) replayIndex++;
+        if (scheduler.animateDisk) animationTime += deltaTime;
 
-        // --- 3. DIBUJAR EN PANTALLA (Render Pass) ---
-        // Limpiamos la pantalla normal
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // Activamos el shader "tonto"
-        glUseProgram(screenProgram);
+        if (!config.recordPath.empty()) recordCameraPathFrame(recorder, {camera, scheduler.animateDisk});
 
-        // Conectamos la textura que rellenó el Compute Shader
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, computeTexture);
-        
-        // Le decimos al sampler (texOutput) que lea de la ranura 0
-        glUniform1i(glGetUniformLocation(screenProgram, "texBase"), 0);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, blurTexture);
-        glUniform1i(glGetUniformLocation(screenProgram, "texBloom"), 1);
+        // --- 3. TRAZAR Y DIBUJAR (gl_renderer.h) ---
+        // Fases del entrelazado, cubemap pendiente o exposición adaptándose: otro frame aunque nada cambie
+        if (traceGlImage(renderer, camera, animationTime, currentWidth, currentHeight, state.envMapMode)) {
+            markDirty(scheduler);
+        }
+        if (presentGlImage(renderer, deltaTime)) markDirty(scheduler);
 
-        // Dibujamos el cuadrado de siempre
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        double swapStart = glfwGetTime();
+        {
+            TRACE_SCOPE("swapBuffers");
+            glfwSwapBuffers(window);
+        }
+        double swapWait = glfwGetTime() - swapStart;
+        observeMetric(MetricHistogram::FrameSwapWait, swapWait);
+        endGlFrame(renderer);
+        recordLatency(latencyLog, inputTime, glfwGetTime());
+
+        // Trabajo del frame sin las esperas de ritmo: así se pueden comparar cambios del trazador
+        double frameCpuSeconds = glfwGetTime() - frameStartTime - slotWait - swapWait;
+        countMetric(MetricCounter::Frames);
+        observeMetric(MetricHistogram::FrameCpu, frameCpuSeconds);
+        if (measureFrames) {
+            frameCpuMs.push_back(frameCpuSeconds * 1000.0);
+            frameWaitMs.push_back((slotWait + swapWait) * 1000.0);
+        }
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // Informe de tiempos (esperamos a las queries de GPU que queden)
+    flushGlRenderer(renderer);
+    if (measureFrames) {
+        const std::vector<double>& frameGpuMs = renderer.gpuFrameMs;
+        for (size_t i = 0; i < frameCpuMs.size(); i++) {
+            addFrameTiming(timingReport, frameCpuMs[i], frameWaitMs[i], i < frameGpuMs.size() ? frameGpuMs[i] : -1.0);
+        }
+        writeTimingReport(timingReport, config.reportPath);
     }
+    closeCameraPathRecorder(recorder);
+    writeTrace(config.tracePath);
 
     // Limpieza
+    printLatencySummary(latencyLog);
+    printGlRendererStats(renderer);
+    printSchedulerStats(scheduler);
+    destroyGlRenderer(renderer);
     glfwTerminate();
     return 0;
 }
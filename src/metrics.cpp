@@ -0,0 +1,222 @@
+#include "metrics.h"
+#include "net.h"
+#include <iostream>
+#include <sstream>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <chrono>
+#include <thread>
+
+static const double BUCKET_LIMITS[METRIC_BUCKET_COUNT] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+static const int COUNTER_COUNT = (int)MetricCounter::Count;
+static const int HISTOGRAM_COUNT = (int)MetricHistogram::Count;
+static const int GAUGE_COUNT = (int)MetricGauge::Count;
+
+// Bloque de un hilo. Solo lo escribe su dueño; el servidor lo lee en paralelo
+// (por eso son atómicos, pero sin read-modify-write). Alineado a línea de caché
+// para que dos hilos no se pisen la misma línea.
+struct alignas(64) MetricsShard {
+    std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+    std::atomic<uint64_t> buckets[HISTOGRAM_COUNT][METRIC_BUCKET_COUNT + 1] = {}; // +1 = +Inf
+    std::atomic<uint64_t> sumNs[HISTOGRAM_COUNT] = {};
+};
+
+// Los bloques nunca se liberan: si un hilo termina, sus totales siguen contando
+// (los contadores de Prometheus no pueden bajar).
+struct MetricsRegistry {
+    std::mutex mutex; // Solo al registrar un hilo nuevo y al leer
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+    std::atomic<int64_t> gauges[GAUGE_COUNT] = {};
+};
+
+static MetricsRegistry& registry() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+static MetricsShard& localShard() {
+    thread_local MetricsShard* shard = nullptr;
+    if (!shard) {
+        MetricsRegistry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.shards.emplace_back(new MetricsShard());
+        shard = reg.shards.back().get();
+    }
+    return *shard;
+}
+
+// Un único escritor por bloque: basta con carga + almacenamiento (sin prefijo lock)
+static inline void addRelaxed(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void countMetric(MetricCounter counter, uint64_t amount) {
+    addRelaxed(localShard().counters[(int)counter], amount);
+}
+
+void observeMetric(MetricHistogram histogram, double seconds) {
+    MetricsShard& shard = localShard();
+    int bucket = 0;
+    while (bucket < METRIC_BUCKET_COUNT && seconds > BUCKET_LIMITS[bucket]) bucket++;
+    addRelaxed(shard.buckets[(int)histogram][bucket], 1);
+    addRelaxed(shard.sumNs[(int)histogram], seconds > 0.0 ? (uint64_t)(seconds * 1e9) : 0);
+}
+
+void setMetricGauge(MetricGauge gauge, int64_t value) {
+    registry().gauges[(int)gauge].store(value, std::memory_order_relaxed);
+}
+
+uint64_t metricCounterTotal(MetricCounter counter) {
+    MetricsRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    uint64_t total = 0;
+    for (const auto& shard : reg.shards) total += shard->counters[(int)counter].load(std::memory_order_relaxed);
+    return total;
+}
+
+std::string formatMetrics() {
+    uint64_t counters[COUNTER_COUNT] = {};
+    uint64_t buckets[HISTOGRAM_COUNT][METRIC_BUCKET_COUNT + 1] = {};
+    uint64_t sumNs[HISTOGRAM_COUNT] = {};
+
+    MetricsRegistry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& shard : reg.shards) {
+            for (int c = 0; c < COUNTER_COUNT; c++) counters[c] += shard->counters[c].load(std::memory_order_relaxed);
+            for (int h = 0; h < HISTOGRAM_COUNT; h++) {
+                for (int b = 0; b <= METRIC_BUCKET_COUNT; b++) buckets[h][b] += shard->buckets[h][b].load(std::memory_order_relaxed);
+                sumNs[h] += shard->sumNs[h].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static const char* counterNames[COUNTER_COUNT] = {
+        "bhsim_frames_total", "bhsim_gpu_rays_total", "bhsim_cpu_rays_total",
+        "bhsim_cpu_ray_steps_total", "bhsim_bytes_written_total", "bhsim_cpu_rays_doomed_total",
+        "bhsim_cpu_rays_clear_total", "bhsim_cpu_rays_near_total", "bhsim_cpu_disk_crossings_total"
+    };
+    static const char* counterHelp[COUNTER_COUNT] = {
+        "Frames trazados", "Rayos lanzados en la GPU", "Rayos trazados en CPU",
+        "Pasos de integración en CPU", "Bytes escritos a disco",
+        "Rayos de CPU que caen sin remedio (clasificados por E y h)",
+        "Rayos de CPU que no alcanzan ni el disco ni el horizonte", "Rayos de CPU sin clasificar",
+        "Cruces del disco semitransparente en CPU (imágenes de orden superior)"
+    };
+    static const char* stageNames[HISTOGRAM_COUNT] = {"frame_cpu", "frame_gpu", "frame_slot_wait", "frame_swap_wait",
+                                                        "cpu_trace"};
+    static const char* gaugeNames[GAUGE_COUNT] = {"cpu_tiles", "gpu_frames"};
+
+    std::ostringstream out;
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        out << "# HELP " << counterNames[c] << " " << counterHelp[c] << "\n"
+            << "# TYPE " << counterNames[c] << " counter\n"
+            << counterNames[c] << " " << counters[c] << "\n";
+    }
+
+    // Media de pasos por rayo ya calculada, para no tener que dividir en cada panel
+    uint64_t cpuRays = counters[(int)MetricCounter::CpuRays];
+    out << "# HELP bhsim_cpu_steps_per_ray Media de pasos por rayo en CPU\n"
+        << "# TYPE bhsim_cpu_steps_per_ray gauge\n"
+        << "bhsim_cpu_steps_per_ray "
+        << (cpuRays ? double(counters[(int)MetricCounter::CpuRaySteps]) / cpuRays : 0.0) << "\n";
+
+    out << "# HELP bhsim_stage_seconds Tiempo por etapa\n"
+        << "# TYPE bhsim_stage_seconds histogram\n";
+    for (int h = 0; h < HISTOGRAM_COUNT; h++) {
+        uint64_t cumulative = 0;
+        for (int b = 0; b <= METRIC_BUCKET_COUNT; b++) {
+            cumulative += buckets[h][b];
+            out << "bhsim_stage_seconds_bucket{stage=\"" << stageNames[h] << "\",le=\"";
+            if (b < METRIC_BUCKET_COUNT) out << BUCKET_LIMITS[b];
+            else out << "+Inf";
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "bhsim_stage_seconds_sum{stage=\"" << stageNames[h] << "\"} " << sumNs[h] / 1e9 << "\n"
+            << "bhsim_stage_seconds_count{stage=\"" << stageNames[h] << "\"} " << cumulative << "\n";
+    }
+
+    out << "# HELP bhsim_queue_depth Elementos en cola\n"
+        << "# TYPE bhsim_queue_depth gauge\n";
+    for (int g = 0; g < GAUGE_COUNT; g++) {
+        out << "bhsim_queue_depth{queue=\"" << gaugeNames[g] << "\"} "
+            << reg.gauges[g].load(std::memory_order_relaxed) << "\n";
+    }
+    return out.str();
+}
+
+// --- SERVIDOR ---
+
+// Un solo hilo atiende todas las peticiones: un cliente que conecta y no manda nada
+// (un health check TCP, un escáner de puertos) no puede bloquearlo más que esto
+static const int METRICS_CLIENT_TIMEOUT_MS = 2000;
+static const int METRICS_ERROR_BACKOFF_MS = 200;
+
+static void serveClient(NetSocket client) {
+    setNetTimeouts(client, METRICS_CLIENT_TIMEOUT_MS);
+    // La petición no importa: cualquier GET recibe las métricas. Sin petición a tiempo, se cierra.
+    bool readable = false;
+    char request[1024];
+    if (waitReadable(&client, 1, METRICS_CLIENT_TIMEOUT_MS, &readable) <= 0 ||
+        recvSome(client, request, sizeof(request)) <= 0) {
+        closeNetSocket(client);
+        return;
+    }
+
+    std::string body = formatMetrics();
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string data = response.str();
+    sendAll(client, data.data(), data.size());
+    closeNetSocket(client);
+}
+
+static void serverLoop(MetricsServer* server, NetSocket listener) {
+    while (!server->quit.load()) {
+        // select con tope para poder comprobar 'quit' sin cerrar el socket desde fuera
+        bool readable = false;
+        int ready = waitReadable(&listener, 1, 200, &readable);
+        if (ready < 0) {
+            // Error de select (p. ej. EINTR): sin esperar, este bucle se comería un núcleo
+            std::this_thread::sleep_for(std::chrono::milliseconds(METRICS_ERROR_BACKOFF_MS));
+            continue;
+        }
+        if (ready == 0) continue;
+
+        NetSocket client = acceptTcp(listener);
+        if (client != INVALID_NET_SOCKET) serveClient(client);
+    }
+    closeNetSocket(listener);
+}
+
+bool startMetricsServer(MetricsServer& server, int port) {
+    if (!netStartup()) return false;
+    // Solo localhost: las métricas no se exponen fuera del nodo
+    NetSocket listener = listenTcp("127.0.0.1", port, "métricas");
+    if (listener == INVALID_NET_SOCKET) {
+        netCleanup();
+        return false;
+    }
+
+    server.port = port;
+    server.quit = false;
+    server.thread = std::thread(serverLoop, &server, listener);
+    std::cout << "Métricas en http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void stopMetricsServer(MetricsServer& server) {
+    if (!server.thread.joinable()) return;
+    server.quit = true;
+    server.thread.join();
+    netCleanup();
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// --- MÉTRICAS (formato de texto de Prometheus) ---
+// Contadores e histogramas fijos (un enum por tipo, sin buscar por nombre).
+// Cada hilo escribe en su propio bloque de contadores: nada de locks ni de
+// operaciones atómicas con bloqueo en el bucle de render, solo cargas y
+// almacenamientos "relaxed" en memoria que nadie más escribe. El servidor
+// suma los bloques de todos los hilos cuando alguien pide /metrics.
+
+enum class MetricCounter {
+    Frames,          // Frames trazados (ventana o sin ventana)
+    GpuRays,         // Rayos lanzados en la GPU (píxeles trazados + caras del cubemap)
+    CpuRays,         // Rayos trazados por el trazador de CPU
+    CpuRaySteps,     // Pasos de integración en CPU (pasos/rayo = CpuRaySteps / CpuRays)
+    BytesWritten,    // Imágenes, grabaciones de cámara e informes
+    CpuRaysDoomed,   // Clasificados al salir: caen sin remedio (solo falta buscar el disco)
+    CpuRaysClear,    // Clasificados al salir: nunca llegan al disco ni al horizonte
+    CpuRaysNear,     // El resto: bucle completo con todas las comprobaciones
+    CpuDiskCrossings,// Cruces del disco semitransparente (--disk-opacity < 1) en rayos que lo cruzan
+    Count
+};
+
+enum class MetricHistogram {
+    FrameCpu,        // Tiempo de CPU de un frame, sin las esperas de ritmo (ranura y swap)
+    FrameGpu,        // GL_TIME_ELAPSED del frame (se lee cuando la GPU termina)
+    FrameSlotWait,   // Espera por una ranura libre (la GPU va por detrás)
+    FrameSwapWait,   // glfwSwapBuffers (vsync)
+    CpuTrace,        // renderFrameCPU completo
+    Count
+};
+
+enum class MetricGauge {
+    CpuTilesPending, // Teselas que quedan en la cola del trazador de CPU
+    FramesQueued,    // Frames enviados a la GPU y aún sin terminar
+    Count
+};
+
+const int METRIC_BUCKET_COUNT = 14; // Límites en segundos (+Inf aparte), ver metrics.cpp
+
+void countMetric(MetricCounter counter, uint64_t amount = 1);
+void observeMetric(MetricHistogram histogram, double seconds);
+void setMetricGauge(MetricGauge gauge, int64_t value);
+
+// Total de un contador sumando todos los hilos (para los resúmenes por consola)
+uint64_t metricCounterTotal(MetricCounter counter);
+
+// Texto de exposición de Prometheus con la suma de todos los hilos
+std::string formatMetrics();
+
+// Servidor HTTP mínimo en 127.0.0.1 que responde a cualquier GET con formatMetrics()
+struct MetricsServer;
+bool startMetricsServer(MetricsServer& server, int port);
+void stopMetricsServer(MetricsServer& server);
+
+struct MetricsServer {
+    std::thread thread;
+    std::atomic<bool> quit{false};
+    int port = 0;
+    // main() tiene muchas salidas de error: paramos el hilo también en ellas
+    ~MetricsServer() { stopMetricsServer(*this); }
+};
@@ -0,0 +1,164 @@
+#include "net.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+static const int SEND_FLAGS = 0;
+static SocketHandle toHandle(NetSocket s) { return s == INVALID_NET_SOCKET ? INVALID_SOCKET : (SocketHandle)s; }
+static NetSocket fromHandle(SocketHandle s) { return s == INVALID_SOCKET ? INVALID_NET_SOCKET : (NetSocket)s; }
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+typedef int SocketHandle;
+// Escribir en una conexión cerrada no debe matar el proceso con SIGPIPE: send devuelve error
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+static SocketHandle toHandle(NetSocket s) { return (SocketHandle)s; }
+static NetSocket fromHandle(SocketHandle s) { return s < 0 ? INVALID_NET_SOCKET : (NetSocket)s; }
+#endif
+
+bool netStartup() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cout << "ERROR: No se pudo inicializar Winsock" << std::endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void netCleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+NetSocket listenTcp(const std::string& address, int port, const char* what) {
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (fromHandle(listener) == INVALID_NET_SOCKET) {
+        std::cout << "ERROR: No se pudo crear el socket (" << what << ")" << std::endl;
+        return INVALID_NET_SOCKET;
+    }
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+        bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 16) != 0) {
+        std::cout << "ERROR: No se pudo escuchar en " << address << ":" << port << " (" << what << ")" << std::endl;
+        closeNetSocket(fromHandle(listener));
+        return INVALID_NET_SOCKET;
+    }
+    return fromHandle(listener);
+}
+
+NetSocket acceptTcp(NetSocket listener) {
+    SocketHandle client = accept(toHandle(listener), nullptr, nullptr);
+    if (fromHandle(client) != INVALID_NET_SOCKET) {
+        // Mensajes pequeños de ida y vuelta: sin Nagle
+        int noDelay = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+    }
+    return fromHandle(client);
+}
+
+NetSocket connectTcp(const std::string& host, int port) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0 || !result) {
+        std::cout << "ERROR: No se pudo resolver " << host << std::endl;
+        return INVALID_NET_SOCKET;
+    }
+
+    SocketHandle s = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    bool ok = fromHandle(s) != INVALID_NET_SOCKET && connect(s, result->ai_addr, (int)result->ai_addrlen) == 0;
+    freeaddrinfo(result);
+    if (!ok) {
+        if (fromHandle(s) != INVALID_NET_SOCKET) closeNetSocket(fromHandle(s));
+        std::cout << "ERROR: No se pudo conectar a " << host << ":" << port << std::endl;
+        return INVALID_NET_SOCKET;
+    }
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+    return fromHandle(s);
+}
+
+void closeNetSocket(NetSocket socket) {
+    if (socket == INVALID_NET_SOCKET) return;
+#ifdef _WIN32
+    closesocket(toHandle(socket));
+#else
+    close(toHandle(socket));
+#endif
+}
+
+void setNetTimeouts(NetSocket socket, int timeoutMs) {
+#ifdef _WIN32
+    DWORD timeout = (DWORD)timeoutMs;
+#else
+    timeval timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+#endif
+    setsockopt(toHandle(socket), SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(toHandle(socket), SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+
+int waitReadable(const NetSocket* sockets, int count, int timeoutMs, bool* readable) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    SocketHandle maxHandle = 0;
+    for (int i = 0; i < count; i++) {
+        FD_SET(toHandle(sockets[i]), &readSet);
+        maxHandle = std::max(maxHandle, toHandle(sockets[i]));
+    }
+    timeval timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    int ready = select((int)maxHandle + 1, &readSet, nullptr, nullptr, &timeout);
+    for (int i = 0; i < count; i++) readable[i] = ready > 0 && FD_ISSET(toHandle(sockets[i]), &readSet);
+    return ready;
+}
+
+bool sendAll(NetSocket socket, const void* data, size_t bytes) {
+    const char* p = (const char*)data;
+    while (bytes > 0) {
+        int chunk = (int)std::min(bytes, (size_t)1 << 30);
+        long n = (long)send(toHandle(socket), p, chunk, SEND_FLAGS);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return true;
+}
+
+bool recvAll(NetSocket socket, void* data, size_t bytes) {
+    char* p = (char*)data;
+    while (bytes > 0) {
+        long n = recvSome(socket, p, bytes);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= (size_t)n;
+    }
+    return true;
+}
+
+long recvSome(NetSocket socket, void* data, size_t bytes) {
+    int chunk = (int)std::min(bytes, (size_t)1 << 30);
+    return (long)recv(toHandle(socket), (char*)data, chunk, 0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --- SOCKETS TCP MÍNIMOS ---
+// Envoltorio fino sobre BSD sockets / Winsock para el servidor de métricas y
+// la granja de render. El descriptor es opaco (intptr_t) para que los
+// cabeceros de Winsock no lleguen a los .cpp que incluyen GLAD/GLFW.
+
+typedef intptr_t NetSocket;
+const NetSocket INVALID_NET_SOCKET = -1;
+
+// Winsock necesita inicializarse (con recuento); en POSIX no hace nada
+bool netStartup();
+void netCleanup();
+
+// Escucha en address:port ("127.0.0.1" = solo este nodo). 'what' es para el mensaje de error.
+NetSocket listenTcp(const std::string& address, int port, const char* what);
+NetSocket acceptTcp(NetSocket listener);
+NetSocket connectTcp(const std::string& host, int port);
+void closeNetSocket(NetSocket socket);
+// Tope para cada recv/send bloqueante (SO_RCVTIMEO / SO_SNDTIMEO): al pasarlo, fallan como una conexión cerrada
+void setNetTimeouts(NetSocket socket, int timeoutMs);
+
+// Espera hasta timeoutMs a que algún socket tenga datos (o conexiones pendientes).
+// readable[i] indica cuáles. Devuelve cuántos están listos (0 = tope, < 0 = error).
+int waitReadable(const NetSocket* sockets, int count, int timeoutMs, bool* readable);
+
+// Bloqueantes: envían/reciben exactamente 'bytes' o devuelven false (conexión cerrada)
+bool sendAll(NetSocket socket, const void* data, size_t bytes);
+bool recvAll(NetSocket socket, void* data, size_t bytes);
+// Lo que haya disponible (hasta 'bytes'); 0 = conexión cerrada, < 0 = error
+long recvSome(NetSocket socket, void* data, size_t bytes);
@@ -0,0 +1,108 @@
+#include "numa.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Lista de CPUs de sysfs: "0-3,8-11"
+static std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        int first = 0, last = 0;
+        size_t dash = range.find('-');
+        try {
+            first = std::stoi(range.substr(0, dash));
+            last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        } catch (...) {
+            continue;
+        }
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static bool readLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file && std::getline(file, line);
+}
+
+NumaTopology detectNumaTopology() {
+    NumaTopology topology;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAffinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::string online;
+    if (readLine("/sys/devices/system/node/online", online)) {
+        for (int node : parseCpuList(online)) {
+            std::string cpuList;
+            if (!readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", cpuList)) continue;
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(cpuList)) {
+                if (!haveAffinity || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) cpus.push_back(cpu);
+            }
+            // Nodos solo de memoria (o CPUs no permitidas): no hay hilos que poner ahí
+            if (!cpus.empty()) topology.nodeCpus.push_back(cpus);
+        }
+    }
+#endif
+    if (topology.nodeCpus.empty()) {
+        // Sin información: un solo nodo con todas las CPUs, sin fijar hilos
+        int cpus = std::max(1, (int)std::thread::hardware_concurrency());
+        topology.nodeCpus.push_back(std::vector<int>(cpus, -1));
+    }
+    return topology;
+}
+
+int numaCpuCount(const NumaTopology& topology, int nodes) {
+    int count = 0;
+    for (int n = 0; n < nodes && n < (int)topology.nodeCpus.size(); n++) count += (int)topology.nodeCpus[n].size();
+    return count;
+}
+
+void printNumaTopology(const NumaTopology& topology) {
+    std::cout << "Topología NUMA: " << topology.nodeCpus.size() << " nodo(s) (";
+    for (size_t n = 0; n < topology.nodeCpus.size(); n++) {
+        std::cout << (n ? ", " : "") << n << ": " << topology.nodeCpus[n].size() << " CPUs";
+    }
+    std::cout << ")" << std::endl;
+}
+
+bool pinCurrentThread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void adviseHugePages(void* data, size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // madvise necesita direcciones alineadas: solo el interior alineado a 2 MB
+    const uintptr_t HUGE_PAGE_SIZE = 2u * 1024 * 1024;
+    uintptr_t begin = ((uintptr_t)data + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    uintptr_t end = ((uintptr_t)data + bytes) & ~(HUGE_PAGE_SIZE - 1);
+    if (end > begin) madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// --- TOPOLOGÍA NUMA ---
+// En nodos de dos sockets, un hilo que migra de socket o que lee el cielo y
+// el framebuffer de la memoria del otro paga la latencia del interconector.
+// La topología se lee de sysfs (/sys/devices/system/node), restringida a las
+// CPUs que el proceso tiene permitidas. Sin sysfs (o fuera de Linux) se
+// devuelve un único nodo y fijar hilos no hace nada.
+
+struct NumaTopology {
+    std::vector<std::vector<int>> nodeCpus;  // CPUs utilizables de cada nodo (nodos sin CPUs omitidos)
+};
+
+NumaTopology detectNumaTopology();
+int numaCpuCount(const NumaTopology& topology, int nodes);
+void printNumaTopology(const NumaTopology& topology);
+
+// Fija el hilo que llama a una CPU. Devuelve false si no se pudo (o no está soportado).
+bool pinCurrentThread(int cpu);
+
+// Pide páginas enormes transparentes (THP) para [data, data + bytes). Solo
+// afecta a las páginas que aún no se han tocado: llamar antes de escribir.
+void adviseHugePages(void* data, size_t bytes);
+
+// Asignador que no inicializa los elementos al hacer resize(): la memoria se
+// queda sin tocar y la primera escritura (la del hilo dueño de cada tesela)
+// decide en qué nodo se colocan las páginas ("first touch").
+template <typename T>
+struct FirstTouchAllocator : std::allocator<T> {
+    template <typename U> struct rebind { using other = FirstTouchAllocator<U>; };
+
+    FirstTouchAllocator() = default;
+    template <typename U> FirstTouchAllocator(const FirstTouchAllocator<U>&) noexcept {}
+
+    template <typename U> void construct(U* p) noexcept { ::new ((void*)p) U; }
+    template <typename U, typename... Args> void construct(U* p, Args&&... args) {
+        ::new ((void*)p) U(std::forward<Args>(args)...);
+    }
+};
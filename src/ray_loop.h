@@ -0,0 +1,242 @@
+#pragma once
+#include "cpu_tracer.h"
+#include "fast_math.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// --- BUCLE DEL RAYO DEL MOTOR PSEUDO-NEWTONIANO (PLANTILLAS) ---
+// Solo lo incluyen cpu_tracer.cpp y lenses.cpp. Las escenas con varias lentes se
+// instancian en lenses.cpp y no junto a las demás: en la misma unidad, GCC llega
+// al límite de crecimiento por inlining (inline-unit-growth) y deja de integrar
+// parte del bucle de Schwarzschild (medido con --bench-engines: un 20% más lento).
+
+// La fuerza deriva de Φ (Metric::potential): E = |v|² / 2 + Φ se conserva a lo largo del rayo.
+// Es el equivalente de la condición nula de la geodésica exacta; la renormalización
+// devuelve |vel| al valor que marca E en cada paso y evita que el error se acumule.
+template <class Metric>
+static inline float rayEnergy(const vec3& pos, const vec3& vel, const Metric& metric) {
+    return 0.5f * dot(vel, vel) + metric.potential(pos);
+}
+
+template <class Metric>
+static inline void renormalizeNull(const vec3& pos, vec3& vel, float energy, const Metric& metric) {
+    float target = 2.0f * (energy - metric.potential(pos));
+    float current = dot(vel, vel);
+    if (target > 0.0f && current > 0.0f) vel = vel * std::sqrt(target / current);
+}
+
+// --- Clasificación del rayo antes de integrar ---
+// Además de E se conserva h = |x × v| (fuerza central), y el movimiento radial es
+// el de una partícula en V(r) = h² / (2 r²) - rs / (2 r³), con una única barrera
+// en r* = 1.5 rs / h², de altura V* = h⁶ / (13.5 rs²). Para E = 1/2 el rayo cae
+// si h < (6.75 rs²)^(1/6): es el parámetro de impacto crítico de este modelo, no
+// el (3√3 / 2) rs de la métrica exacta (ese ya lo usa --analytic por construcción).
+// Solo para políticas con ese potencial (Metric::barrier).
+// Doomed no es exacto: se da por capturado al bajar de diskInner, y el bucle completo
+// deja en el cielo los que, junto a la barrera, no llegan al horizonte en MAX_STEPS.
+// Algunos píxeles del borde de la sombra cambian; --no-ray-classes integra como antes.
+enum class RayClass {
+    Doomed, // Va hacia dentro y no hay barrera que lo devuelva: r baja sin parar
+    Clear,  // No puede bajar de diskOuter: ni horizonte ni disco
+    Near    // Cualquier otro caso: todas las comprobaciones en cada paso
+};
+
+const float RAY_CLASS_DISK_MARGIN = 1.01f; // Holgura sobre diskOuter para el error de integración
+
+static inline float radialPotential(float r, float h2, float rs) {
+    return 0.5f * h2 / (r * r) - 0.5f * rs / (r * r * r);
+}
+
+template <class Metric>
+static RayClass classifyRay(const vec3& ro, const vec3& rd, const Metric& metric, const BlackHoleParams& params) {
+    const float rs = metric.rs;
+    float r0 = length(ro);
+    vec3 l = ro.cross(rd);
+    float h2 = dot(l, l);
+    float energy = rayEnergy(ro, rd, metric);
+    bool inward = dot(ro, rd) < 0.0f;
+    float rPeak = h2 > 0.0f ? 1.5f * rs / h2 : FLT_MAX;
+
+    if (r0 <= rPeak) {
+        // Dentro de la barrera V crece con r: hacia dentro ya no hay retorno
+        return inward ? RayClass::Doomed : RayClass::Near;
+    }
+    float vPeak = h2 * h2 * h2 / (13.5f * rs * rs);
+    if (inward && energy > vPeak) return RayClass::Doomed;
+
+    // Fuera de la barrera: hacia fuera r solo crece; hacia dentro rebota donde E = V(r)
+    float rDisk = params.diskOuter * RAY_CLASS_DISK_MARGIN;
+    if (r0 > rDisk) {
+        if (!inward) return RayClass::Clear;
+        float barrier = rDisk >= rPeak ? radialPotential(rDisk, h2, rs) : vPeak;
+        if (energy < barrier) return RayClass::Clear;
+    }
+    return RayClass::Near;
+}
+
+// --- Disco semitransparente (--disk-opacity < 1) ---
+// Fuera de línea (cpu_tracer.cpp): el bucle con el disco opaco no crece y no se
+// pasa del límite de inlining de arriba (medido: dentro del bucle, un 15% más lento).
+// Apunta un cruce del disco en 'outcome' y lo descuenta de 'transmittance'. True si
+// el rayo acaba ahí (opacidad acumulada DISK_OPACITY_CUTOFF o diskOrders cruces).
+bool crossDisk(RayOutcome& outcome, float& transmittance, const DiskCrossing& crossing,
+               const BlackHoleParams& params);
+// Con cruces apuntados el resultado sigue siendo el disco y 'kind' es lo que queda detrás
+void endDiskLayers(RayOutcome& outcome, OutcomeKind kind);
+
+static inline void endOutcome(RayOutcome& outcome, OutcomeKind kind) {
+    if (outcome.crossings == 0) outcome.kind = kind;
+    else endDiskLayers(outcome, kind);
+}
+
+// El bucle del rayo, instanciado por integrador, espacio-tiempo, clase y matemática:
+// nada se decide dentro del bucle. La aceleración no cambia con FastMath: sqrtss y
+// divss ya son una instrucción cada una y rsqrtss + Newton no acorta la cadena de
+// dependencias de RK4 (medido: algo más lento), al contrario que en la GPU.
+// La política se construye aquí, con su constructor y no con una función auxiliar,
+// y no se recibe por referencia: así el compilador la ve entera (con Schwarzschild,
+// horizonte = rs) y el bucle queda igual que antes de las políticas (medido con
+// --bench-engines: pasarla, o construirla con una función, costaba un 20%).
+template <class Integrator, class Metric, bool Renormalize, RayClass Class, bool FastMath>
+static RayOutcome traceIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                  const BlackHoleParams& params) {
+    const Metric metric(params.rs, params.charge, params.lambda, params.lenses.get());
+    auto accel = [&metric](const vec3& p) { return metric.accel(p); };
+    // Mismo "tiempo" de integración para todos los integradores y pasos
+    const float duration = MAX_STEPS * STEP_SIZE;
+    const int maxSteps = Integrator::adaptive ? MAX_STEPS * 8 : (int)std::lround(duration / params.stepSize);
+    const float horizon = metric.horizon * 1.01f;
+
+    IntegratorState s;
+    s.pos = ro;
+    s.vel = rd;
+    s.acc = accel(ro);
+    s.dt = params.stepSize;
+    s.evals = 1;
+    float energy = Renormalize ? rayEnergy(ro, rd, metric) : 0.0f;
+    float t = 0.0f;
+    RayOutcome outcome;
+    float transmittance = 1.0f; // Disco semitransparente: lo que aún se ve de lo que hay detrás
+
+    for (steps = 1; steps <= maxSteps; steps++) {
+        vec3 prevPos = s.pos;
+        if constexpr (Integrator::adaptive) s.dt = std::min(s.dt, duration - t);
+        t += Integrator::step(s, accel, params.tolerance);
+        if constexpr (Renormalize) renormalizeNull(s.pos, s.vel, energy, metric);
+
+        if constexpr (Class != RayClass::Clear || Metric::escapeRadius) {
+            // Rápida: se comparan cuadrados (sin raíz)
+            float r = FastMath ? dot(s.pos, s.pos) : length(s.pos);
+            auto below = [r](float radius) { return r < (FastMath ? radius * radius : radius); };
+
+            if constexpr (Class != RayClass::Clear) {
+                // 1. Colisión con el horizonte de eventos (con varias lentes, el de cualquiera)
+                bool captured;
+                if constexpr (Metric::centered) captured = below(horizon);
+                else captured = metric.captured(s.pos);
+                if (captured) {
+                    evals = s.evals;
+                    endOutcome(outcome, OutcomeKind::Captured);
+                    return outcome;
+                }
+
+                // 2. Cruce del plano del disco (y cambia de signo)
+                if (prevPos.y * s.pos.y < 0.0f) {
+                    float f = prevPos.y / (prevPos.y - s.pos.y);
+                    vec3 hitPoint = prevPos + (s.pos - prevPos) * f;
+                    float hitDist = length(hitPoint);
+
+                    if (hitDist > params.diskInner && hitDist < params.diskOuter) {
+                        vec3 diskTangent = normalize({-hitPoint.z, 0.0f, hitPoint.x});
+                        float angle = FastMath ? fastAtan2(hitPoint.z, hitPoint.x) : std::atan2(hitPoint.z, hitPoint.x);
+                        float doppler = dot(normalize(s.vel), diskTangent);
+                        if (params.diskOpacity >= 1.0f) {
+                            evals = s.evals;
+                            outcome.kind = OutcomeKind::Disk;
+                            outcome.hitDist = hitDist;
+                            outcome.angle = angle;
+                            outcome.doppler = doppler;
+                            return outcome;
+                        }
+
+                        // Semitransparente: el rayo sigue hasta que el disco ya lo tapa todo
+                        if (crossDisk(outcome, transmittance, {hitDist, angle, doppler}, params)) {
+                            evals = s.evals;
+                            return outcome;
+                        }
+                    }
+                }
+
+                // 3. Condenado: r solo baja, por dentro de diskInner ya no puede tocar el disco
+                if constexpr (Class == RayClass::Doomed) {
+                    if (below(params.diskInner)) {
+                        evals = s.evals;
+                        endOutcome(outcome, OutcomeKind::Captured);
+                        return outcome;
+                    }
+                }
+            }
+
+            // 4. Horizonte cosmológico: lo que sale por él ya no vuelve
+            if constexpr (Metric::escapeRadius) {
+                if (!below(metric.escape)) break;
+            }
+        }
+
+        if constexpr (Integrator::adaptive) {
+            if (t >= duration) break;
+        }
+    }
+
+    steps = std::min(steps, maxSteps);
+    evals = s.evals;
+    endOutcome(outcome, OutcomeKind::Escaped);
+    outcome.dir = normalize(s.vel);
+    return outcome;
+}
+
+template <class Integrator, class Metric, bool Renormalize, RayClass Class>
+static inline RayOutcome traceIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                         const BlackHoleParams& params) {
+    return params.fastMath ? traceIntegrated<Integrator, Metric, Renormalize, Class, true>(ro, rd, steps, evals, params)
+                           : traceIntegrated<Integrator, Metric, Renormalize, Class, false>(ro, rd, steps, evals, params);
+}
+
+template <class Integrator, class Metric, bool Renormalize>
+static inline RayOutcome traceIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                         const BlackHoleParams& params) {
+    if constexpr (!Metric::barrier) {
+        countMetric(MetricCounter::CpuRaysNear);
+        return traceIntegrated<Integrator, Metric, Renormalize, RayClass::Near>(ro, rd, steps, evals, params);
+    } else {
+        if (!params.rayClasses) {
+            countMetric(MetricCounter::CpuRaysNear);
+            return traceIntegrated<Integrator, Metric, Renormalize, RayClass::Near>(ro, rd, steps, evals, params);
+        }
+        switch (classifyRay(ro, rd, Metric(params.rs, params.charge, params.lambda, params.lenses.get()), params)) {
+            case RayClass::Doomed:
+                countMetric(MetricCounter::CpuRaysDoomed);
+                return traceIntegrated<Integrator, Metric, Renormalize, RayClass::Doomed>(ro, rd, steps, evals, params);
+            case RayClass::Clear:
+                countMetric(MetricCounter::CpuRaysClear);
+                return traceIntegrated<Integrator, Metric, Renormalize, RayClass::Clear>(ro, rd, steps, evals, params);
+            case RayClass::Near:
+            default:
+                countMetric(MetricCounter::CpuRaysNear);
+                return traceIntegrated<Integrator, Metric, Renormalize, RayClass::Near>(ro, rd, steps, evals, params);
+        }
+    }
+}
+
+template <class Integrator, class Metric>
+static inline RayOutcome traceIntegrated(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                         const BlackHoleParams& params) {
+    return params.nullRenorm ? traceIntegrated<Integrator, Metric, true>(ro, rd, steps, evals, params)
+                             : traceIntegrated<Integrator, Metric, false>(ro, rd, steps, evals, params);
+}
+
+// Varias lentes (SpacetimeMultiLens), en su propia unidad de compilación (lenses.cpp)
+RayOutcome traceOutcomeMultiLens(const vec3& ro, const vec3& rd, int& steps, int& evals,
+                                 const BlackHoleParams& params);
@@ -0,0 +1,158 @@
+#include <glad/gl.h>
+#include "render_targets.h"
+#include <iostream>
+
+// Bytes por píxel de GL_RGBA32F
+static const long long RT_BYTES_PER_PIXEL = 16;
+
+// Crea una textura de alta precisión (32-bit Float) para escritura arbitraria
+unsigned int createComputeTexture(int width, int height){
+    unsigned int texID;
+    glGenTextures(1, &texID);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    // GL_RGBA32F: Aquí está la clave. 32 bits flotantes por canal (R,G,B,A).
+    // Pasamos NULL al final porque no estamos copiando una imagen desde la CPU,
+    // solo reservamos la memoria en la GPU.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+
+    // Filtros básicos
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    // --- MAGIA DE COMPUTE SHADER ---
+    // glBindImageTexture conecta la textura a una "Image Unit" (unidad de imagen).
+    // Esto permite que el shader escriba en ella usando imageStore().
+    // 0 = Binding Unit (debe coincidir con el shader: layout(rgba32f, binding = 0))
+    // GL_WRITE_ONLY = El shader solo escribirá en ella (optimización).
+    glBindImageTexture(0, texID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+    return texID;
+}
+
+static int bucketCapacity(int size) {
+    int wanted = (int)(size * RT_HEADROOM);
+    return (wanted + RT_BUCKET_SIZE - 1) / RT_BUCKET_SIZE * RT_BUCKET_SIZE;
+}
+
+static long long textureBytes(int capacityWidth, int capacityHeight) {
+    return RT_BYTES_PER_PIXEL * capacityWidth * capacityHeight;
+}
+
+// La textura libre más pequeña en la que cabe width x height, siempre que no pase del
+// doble de la cubeta que se reservaría (una rejilla pequeña no se queda la de 4K). -1 si no hay.
+static int findFreeTexture(const RenderTargetPool& pool, int width, int height) {
+    long long limit = 2LL * bucketCapacity(width) * bucketCapacity(height);
+    int best = -1;
+    long long bestArea = 0;
+    for (size_t i = 0; i < pool.free.size(); i++) {
+        const FreeRenderTexture& t = pool.free[i];
+        long long area = (long long)t.capacityWidth * t.capacityHeight;
+        if (t.capacityWidth < width || t.capacityHeight < height || area > limit) continue;
+        if (best < 0 || area < bestArea) {
+            best = (int)i;
+            bestArea = area;
+        }
+    }
+    return best;
+}
+
+// Borra las texturas libres en las que no cabe width x height: al crecer la ventana se quedan
+// atrás, y sin esto ocuparían la lista (y la memoria) hasta que las echara RT_MAX_FREE
+static void evictSmallerTextures(RenderTargetPool& pool, int width, int height) {
+    for (size_t i = 0; i < pool.free.size();) {
+        const FreeRenderTexture& t = pool.free[i];
+        if (t.capacityWidth >= width && t.capacityHeight >= height) {
+            i++;
+            continue;
+        }
+        long long bytes = textureBytes(t.capacityWidth, t.capacityHeight);
+        glDeleteTextures(1, &t.texture);
+        pool.bytesLive -= bytes;
+        pool.bytesFree -= bytes;
+        pool.evictions++;
+        pool.free.erase(pool.free.begin() + i);
+    }
+}
+
+bool resizeRenderTarget(RenderTargetPool& pool, RenderTarget& target, int width, int height) {
+    target.width = width;
+    target.height = height;
+
+    if (target.texture != 0 && width <= target.capacityWidth && height <= target.capacityHeight) {
+        pool.resizesAbsorbed++;
+        return false;
+    }
+
+    // No cabe: a la lista libre, y de ella si hay una que sirva; si no, nueva cubeta con margen en ambos ejes
+    releaseRenderTarget(pool, target);
+    target.width = width;
+    target.height = height;
+    evictSmallerTextures(pool, width, height);
+    int index = findFreeTexture(pool, width, height);
+    if (index >= 0) {
+        const FreeRenderTexture& t = pool.free[index];
+        target.texture = t.texture;
+        target.capacityWidth = t.capacityWidth;
+        target.capacityHeight = t.capacityHeight;
+        pool.bytesFree -= textureBytes(t.capacityWidth, t.capacityHeight);
+        pool.free.erase(pool.free.begin() + index);
+        pool.reuses++;
+        return true;
+    }
+
+    target.capacityWidth = bucketCapacity(width);
+    target.capacityHeight = bucketCapacity(height);
+    target.texture = createComputeTexture(target.capacityWidth, target.capacityHeight);
+
+    long long bytes = textureBytes(target.capacityWidth, target.capacityHeight);
+    pool.allocations++;
+    pool.bytesAllocated += bytes;
+    pool.bytesLive += bytes;
+    return true;
+}
+
+void releaseRenderTarget(RenderTargetPool& pool, RenderTarget& target) {
+    if (target.texture == 0) return;
+    if ((int)pool.free.size() >= RT_MAX_FREE) {
+        // Lista llena: se borra la más antigua
+        FreeRenderTexture& oldest = pool.free.front();
+        long long bytes = textureBytes(oldest.capacityWidth, oldest.capacityHeight);
+        glDeleteTextures(1, &oldest.texture);
+        pool.bytesLive -= bytes;
+        pool.bytesFree -= bytes;
+        pool.free.erase(pool.free.begin());
+    }
+    pool.free.push_back({target.texture, target.capacityWidth, target.capacityHeight});
+    pool.bytesFree += textureBytes(target.capacityWidth, target.capacityHeight);
+    target.texture = 0;
+    target.capacityWidth = target.capacityHeight = 0;
+}
+
+void destroyRenderTargetPool(RenderTargetPool& pool) {
+    for (FreeRenderTexture& t : pool.free) {
+        glDeleteTextures(1, &t.texture);
+        pool.bytesLive -= textureBytes(t.capacityWidth, t.capacityHeight);
+    }
+    pool.free.clear();
+    pool.bytesFree = 0;
+}
+
+float renderTargetUVScaleX(const RenderTarget& target) {
+    return target.capacityWidth > 0 ? float(target.width) / float(target.capacityWidth) : 1.0f;
+}
+
+float renderTargetUVScaleY(const RenderTarget& target) {
+    return target.capacityHeight > 0 ? float(target.height) / float(target.capacityHeight) : 1.0f;
+}
+
+void printRenderTargetStats(const RenderTargetPool& pool) {
+    std::cout << "Render targets: " << pool.allocations << " reservas ("
+              << pool.bytesAllocated / (1024.0 * 1024.0) << " MB en total, "
+              << pool.bytesLive / (1024.0 * 1024.0) << " MB ocupados, de ellos "
+              << pool.bytesFree / (1024.0 * 1024.0) << " MB libres), "
+              << pool.reuses << " reutilizadas de la lista libre, "
+              << pool.evictions << " descartadas por pequeñas, "
+              << pool.resizesAbsorbed << " redimensionados sin reservar" << std::endl;
+}
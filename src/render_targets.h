@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+// --- POOL DE RENDER TARGETS REDIMENSIONABLES ---
+// Al arrastrar el borde de la ventana el tamaño cambia en cada frame. En vez
+// de borrar y crear las texturas cada vez, reservamos por "cubetas" con
+// margen (capacidad >= tamaño pedido) y los shaders solo trabajan sobre el
+// sub-rectángulo activo (uniform u_viewport). Solo se reasigna memoria de
+// verdad cuando el nuevo tamaño no cabe en la capacidad actual.
+// Las texturas que se sueltan (un target que se queda pequeño, o el del
+// muestreo adaptativo y el entrelazado al apagarlos) quedan en una lista
+// libre del pool y las reutiliza el siguiente target que quepa en ellas; las
+// que se quedan pequeñas para un target que crece se borran.
+
+const int RT_BUCKET_SIZE = 256;    // La capacidad se redondea a múltiplos de esto
+const float RT_HEADROOM = 1.25f;   // Margen extra al reservar (25%)
+const int RT_MAX_FREE = 8;         // Texturas libres guardadas como máximo (se borra la más antigua)
+
+struct RenderTarget {
+    unsigned int texture = 0;
+    int width = 0, height = 0;                  // Sub-rectángulo en uso (viewport)
+    int capacityWidth = 0, capacityHeight = 0;  // Tamaño real de la textura
+};
+
+struct FreeRenderTexture {
+    unsigned int texture;
+    int capacityWidth, capacityHeight;
+};
+
+struct RenderTargetPool {
+    std::vector<FreeRenderTexture> free; // Texturas sin target, de la más antigua a la más reciente
+    long allocations = 0;        // Reservas reales (glTexImage2D)
+    long reuses = 0;             // Texturas sacadas de la lista libre en vez de reservar
+    long evictions = 0;          // Texturas libres borradas por no caber en un target que creció
+    long resizesAbsorbed = 0;    // Cambios de tamaño que cupieron en la capacidad existente
+    long long bytesAllocated = 0; // Bytes reservados en total (histórico)
+    long long bytesLive = 0;      // Bytes ocupados ahora mismo (en uso y libres)
+    long long bytesFree = 0;      // De ellos, en la lista libre
+};
+
+// Textura RGBA32F lista para imageStore (conectada a la unidad de imagen 0)
+unsigned int createComputeTexture(int width, int height);
+
+// Ajusta el target al tamaño pedido. Devuelve true si cambió de textura (nueva o de la lista libre).
+bool resizeRenderTarget(RenderTargetPool& pool, RenderTarget& target, int width, int height);
+// Devuelve la textura del target a la lista libre del pool
+void releaseRenderTarget(RenderTargetPool& pool, RenderTarget& target);
+// Borra las texturas libres (las de los targets se sueltan antes con releaseRenderTarget)
+void destroyRenderTargetPool(RenderTargetPool& pool);
+
+// Fracción de la textura que ocupa el viewport (para escalar coordenadas UV)
+float renderTargetUVScaleX(const RenderTarget& target);
+float renderTargetUVScaleY(const RenderTarget& target);
+
+void printRenderTargetStats(const RenderTargetPool& pool);
@@ -0,0 +1,58 @@
+#include "scheduler.h"
+#include <iostream>
+#include <algorithm>
+
+void markDirty(FrameScheduler& scheduler) {
+    scheduler.dirty = true;
+}
+
+FrameDecision decideFrame(FrameScheduler& scheduler, float camX, float camY, float camZ,
+                          int fbWidth, int fbHeight, double now) {
+    // 1. Invisible: ni trazamos ni presentamos
+    if (scheduler.iconified || fbWidth == 0 || fbHeight == 0) {
+        scheduler.framesHidden++;
+        scheduler.waitTime = SCHEDULER_IDLE_WAIT;
+        // Al volver a mostrarse hay que redibujar sí o sí
+        scheduler.dirty = true;
+        return FrameDecision::Hidden;
+    }
+
+    // 2. ¿Ha cambiado algo desde el último frame trazado?
+    bool camMoved = !scheduler.hasLastCam || camX != scheduler.lastCam[0] ||
+                    camY != scheduler.lastCam[1] || camZ != scheduler.lastCam[2];
+    bool changed = scheduler.dirty || camMoved || scheduler.animateDisk;
+
+    if (!changed) {
+        scheduler.framesIdle++;
+        scheduler.waitTime = SCHEDULER_IDLE_WAIT;
+        return FrameDecision::Idle;
+    }
+
+    // 3. Sin foco: limitamos la frecuencia (la animación sigue, pero a menos fps)
+    if (!scheduler.focused && !scheduler.replaying && scheduler.backgroundFps > 0.0f && scheduler.lastRenderTime >= 0.0) {
+        double interval = 1.0 / scheduler.backgroundFps;
+        double elapsed = now - scheduler.lastRenderTime;
+        if (elapsed < interval) {
+            scheduler.framesThrottled++;
+            scheduler.waitTime = std::min(interval - elapsed, SCHEDULER_IDLE_WAIT);
+            return FrameDecision::Throttle;
+        }
+    }
+
+    scheduler.lastCam[0] = camX;
+    scheduler.lastCam[1] = camY;
+    scheduler.lastCam[2] = camZ;
+    scheduler.hasLastCam = true;
+    scheduler.dirty = false;
+    scheduler.lastRenderTime = now;
+    scheduler.waitTime = 0.0;
+    scheduler.framesRendered++;
+    return FrameDecision::Render;
+}
+
+void printSchedulerStats(const FrameScheduler& scheduler) {
+    long skipped = scheduler.framesIdle + scheduler.framesThrottled + scheduler.framesHidden;
+    std::cout << "Planificador: " << scheduler.framesRendered << " frames trazados, " << skipped
+              << " saltados (" << scheduler.framesIdle << " sin cambios, " << scheduler.framesThrottled
+              << " sin foco, " << scheduler.framesHidden << " minimizada)" << std::endl;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// --- PLANIFICADOR DE RENDER BAJO DEMANDA ---
+// Solo lanzamos los compute shaders cuando algo ha cambiado: la cámara, el
+// tamaño de la ventana o el tiempo (si la animación del disco está activa).
+// Con la ventana minimizada no se hace nada, y sin foco se limita la
+// frecuencia. Lo que no se traza se cuenta como frame saltado.
+
+const double SCHEDULER_IDLE_WAIT = 0.1; // Espera máxima por eventos cuando no hay nada que hacer (s)
+
+enum class FrameDecision {
+    Render,   // Hay que trazar y presentar
+    Idle,     // Nada ha cambiado: esperar eventos
+    Throttle, // Sin foco: esperar a que toque el siguiente frame
+    Hidden    // Minimizada o framebuffer 0x0: no tiene sentido dibujar
+};
+
+struct FrameScheduler {
+    bool animateDisk = true;       // Tecla P: congela/reanuda la animación del disco
+    bool iconified = false;        // Callback de iconificación
+    bool focused = true;           // Callback de foco
+    bool dirty = true;             // Cambio pendiente (resize, tecla, exposición inicial...)
+    float backgroundFps = 10.0f;   // Frecuencia máxima sin foco (0 = sin límite)
+    bool replaying = false;        // --replay: sin límite sin foco (la grabación marca el ritmo)
+
+    float lastCam[3] = {0.0f, 0.0f, 0.0f};
+    bool hasLastCam = false;
+    double lastRenderTime = -1.0;
+    double waitTime = 0.0;         // Cuánto esperar por eventos si no se renderiza
+
+    long framesRendered = 0;
+    long framesIdle = 0;
+    long framesThrottled = 0;
+    long framesHidden = 0;
+};
+
+// Marca que el próximo frame debe trazarse aunque la cámara no se haya movido
+void markDirty(FrameScheduler& scheduler);
+
+// Decide qué hacer este frame. Si no es Render, scheduler.waitTime indica
+// cuánto esperar por eventos antes de volver a preguntar.
+FrameDecision decideFrame(FrameScheduler& scheduler, float camX, float camY, float camZ,
+                          int fbWidth, int fbHeight, double now);
+
+void printSchedulerStats(const FrameScheduler& scheduler);
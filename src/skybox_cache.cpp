@@ -0,0 +1,258 @@
+#include "skybox_cache.h"
+#include "stb_image.h"
+#include "trace.h"
+#include <glad/gl.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// =========================================================
+//            FICHERO MAPEADO EN MEMORIA
+// =========================================================
+
+bool mapFile(const std::string& path, MappedFile& mapped) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    const void* view = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mapped.data = (const unsigned char*)view;
+    mapped.size = (size_t)size.QuadPart;
+    mapped.file = file;
+    mapped.mapping = mapping;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    // Se lee de principio a fin una sola vez: que el kernel lea por delante
+    madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+    mapped.data = (const unsigned char*)view;
+    mapped.size = (size_t)info.st_size;
+    mapped.fd = fd;
+#endif
+    return true;
+}
+
+void unmapFile(MappedFile& mapped) {
+    if (!mapped.data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapped.data);
+    CloseHandle(mapped.mapping);
+    CloseHandle(mapped.file);
+    mapped.mapping = nullptr;
+    mapped.file = nullptr;
+#else
+    munmap((void*)mapped.data, mapped.size);
+    close(mapped.fd);
+    mapped.fd = -1;
+#endif
+    mapped.data = nullptr;
+    mapped.size = 0;
+}
+
+// =========================================================
+//            CONVERSOR
+// =========================================================
+
+std::string skyboxCachePath(const std::string& sourcePath) {
+    return std::filesystem::path(sourcePath).replace_extension(".bhsky").string();
+}
+
+static bool sourceSignature(const std::string& sourcePath, uint64_t& size, int64_t& mtime) {
+    std::error_code error;
+    size = std::filesystem::file_size(sourcePath, error);
+    if (error) return false;
+    mtime = (int64_t)std::filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+    return !error;
+}
+
+// Siguiente nivel: media de bloques 2x2 (en los bordes impares se repite la última fila/columna),
+// lo mismo que hace glGenerateMipmap con un filtro de caja
+static void downsampleLevel(const std::vector<unsigned char>& src, int srcWidth, int srcHeight,
+                            std::vector<unsigned char>& dst, int dstWidth, int dstHeight) {
+    dst.resize((size_t)dstWidth * dstHeight * 4);
+    for (int y = 0; y < dstHeight; y++) {
+        int y0 = std::min(2 * y, srcHeight - 1), y1 = std::min(2 * y + 1, srcHeight - 1);
+        for (int x = 0; x < dstWidth; x++) {
+            int x0 = std::min(2 * x, srcWidth - 1), x1 = std::min(2 * x + 1, srcWidth - 1);
+            const unsigned char* a = &src[((size_t)y0 * srcWidth + x0) * 4];
+            const unsigned char* b = &src[((size_t)y0 * srcWidth + x1) * 4];
+            const unsigned char* c = &src[((size_t)y1 * srcWidth + x0) * 4];
+            const unsigned char* d = &src[((size_t)y1 * srcWidth + x1) * 4];
+            unsigned char* out = &dst[((size_t)y * dstWidth + x) * 4];
+            for (int i = 0; i < 4; i++) out[i] = (unsigned char)((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+        }
+    }
+}
+
+static uint64_t alignUp(uint64_t value) {
+    return (value + SKYBOX_CACHE_ALIGNMENT - 1) / SKYBOX_CACHE_ALIGNMENT * SKYBOX_CACHE_ALIGNMENT;
+}
+
+bool convertSkybox(const std::string& sourcePath, const std::string& cachePath) {
+    SkyboxCacheHeader header = {};
+    std::memcpy(header.magic, SKYBOX_CACHE_MAGIC, 4);
+    header.version = SKYBOX_CACHE_VERSION;
+    if (!sourceSignature(sourcePath, header.sourceSize, header.sourceMtime)) {
+        std::cout << "ERROR: No se encuentra la imagen del cielo: " << sourcePath << std::endl;
+        return false;
+    }
+
+    int width, height, channels;
+    unsigned char* data = stbi_load(sourcePath.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cout << "ERROR: No se pudo cargar la textura: " << sourcePath << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> level(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+
+    header.width = width;
+    header.height = height;
+    header.levels = 1;
+    for (int w = width, h = height; w > 1 || h > 1; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) header.levels++;
+
+    std::ofstream file(cachePath, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR: No se pudo crear la caché del cielo: " << cachePath << std::endl;
+        return false;
+    }
+
+    // Tabla de niveles primero (los offsets se conocen de antemano)
+    std::vector<SkyboxCacheLevel> table(header.levels);
+    uint64_t offset = alignUp(sizeof(header) + sizeof(SkyboxCacheLevel) * header.levels);
+    for (uint32_t i = 0, w = width, h = height; i < header.levels; i++, w = std::max(w / 2, 1u), h = std::max(h / 2, 1u)) {
+        table[i] = {offset, w, h};
+        offset = alignUp(offset + (uint64_t)w * h * 4);
+    }
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)table.data(), sizeof(SkyboxCacheLevel) * table.size());
+
+    std::vector<unsigned char> next;
+    for (uint32_t i = 0; i < header.levels; i++) {
+        file.seekp((std::streamoff)table[i].offset);
+        file.write((const char*)level.data(), level.size());
+        if (i + 1 < header.levels) {
+            downsampleLevel(level, table[i].width, table[i].height, next, table[i + 1].width, table[i + 1].height);
+            level.swap(next);
+        }
+    }
+    // Relleno final para que el último nivel también ocupe páginas completas
+    file.seekp((std::streamoff)(offset - 1));
+    file.put(0);
+
+    if (!file) {
+        std::cout << "ERROR: Fallo al escribir la caché del cielo: " << cachePath << std::endl;
+        return false;
+    }
+    std::cout << "Caché del cielo: " << cachePath << " (" << width << "x" << height << ", "
+              << header.levels << " niveles, " << offset / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+// =========================================================
+//            CARGA EN EJECUCIÓN
+// =========================================================
+
+bool openSkyboxCache(const std::string& cachePath, const std::string& sourcePath, MappedFile& mapped) {
+    if (!mapFile(cachePath, mapped)) return false;
+
+    const SkyboxCacheHeader* header = skyboxCacheHeader(mapped);
+    const SkyboxCacheLevel* table = skyboxCacheLevels(mapped);
+    bool valid = mapped.size >= sizeof(SkyboxCacheHeader) &&
+                 std::memcmp(header->magic, SKYBOX_CACHE_MAGIC, 4) == 0 &&
+                 header->version == SKYBOX_CACHE_VERSION && header->levels > 0 && header->levels <= 32 &&
+                 mapped.size >= sizeof(SkyboxCacheHeader) + sizeof(SkyboxCacheLevel) * header->levels;
+    // Los niveles tienen que ser la cadena de mipmaps de width x height (la que reserva glTexStorage2D):
+    // el 0 del tamaño de la cabecera y cada uno la mitad del anterior, sin pasar de 1x1
+    uint32_t levelWidth = valid ? header->width : 0, levelHeight = valid ? header->height : 0;
+    valid = valid && levelWidth > 0 && levelHeight > 0;
+    for (uint32_t i = 0; valid && i < header->levels; i++) {
+        valid = table[i].width == levelWidth && table[i].height == levelHeight &&
+                (i + 1 == header->levels || levelWidth > 1 || levelHeight > 1) &&
+                table[i].offset <= mapped.size &&
+                (uint64_t)table[i].width * table[i].height * 4 <= mapped.size - table[i].offset;
+        levelWidth = std::max(levelWidth / 2, 1u);
+        levelHeight = std::max(levelHeight / 2, 1u);
+    }
+    if (!valid) {
+        std::cout << "ERROR: Caché del cielo dañada o de otra versión: " << cachePath << std::endl;
+        unmapFile(mapped);
+        return false;
+    }
+
+    // Si la imagen original sigue ahí y ha cambiado, la caché no vale
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    if (sourceSignature(sourcePath, sourceSize, sourceMtime) &&
+        (sourceSize != header->sourceSize || sourceMtime != header->sourceMtime)) {
+        std::cout << "Caché del cielo obsoleta (" << cachePath << "): vuelve a generarla con --convert-skybox "
+                  << sourcePath << std::endl;
+        unmapFile(mapped);
+        return false;
+    }
+    return true;
+}
+
+unsigned int loadSkyboxCache(const std::string& cachePath, const std::string& sourcePath) {
+    TRACE_SCOPE("loadSkyboxCache");
+    MappedFile mapped;
+    if (!openSkyboxCache(cachePath, sourcePath, mapped)) return 0;
+    const SkyboxCacheHeader* header = skyboxCacheHeader(mapped);
+    const SkyboxCacheLevel* table = skyboxCacheLevels(mapped);
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    // Almacenamiento inmutable con todos los niveles y subida nivel a nivel desde el mapeo
+    glTexStorage2D(GL_TEXTURE_2D, header->levels, GL_RGBA8, header->width, header->height);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (uint32_t i = 0; i < header->levels; i++) {
+        glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, table[i].width, table[i].height, GL_RGBA, GL_UNSIGNED_BYTE,
+                        mapped.data + table[i].offset);
+    }
+
+    // Mismos parámetros que loadTexture
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    std::cout << "Textura cargada desde la caché: " << cachePath << " (" << header->width << "x" << header->height
+              << ", " << header->levels << " niveles)" << std::endl;
+    // glTexSubImage2D ya ha copiado los datos: se puede soltar el mapeo
+    unmapFile(mapped);
+    return textureID;
+}
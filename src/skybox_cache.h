@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --- CACHÉ PREPROCESADA DEL CIELO (.bhsky) ---
+// Decodificar un panorama de 8k-16k con stb_image y generar los mipmaps en
+// cada arranque cuesta segundos y una copia entera en RAM. El conversor lo
+// hace una vez y guarda todos los niveles ya listos para subir (RGBA8, filas
+// sin relleno, cada nivel alineado a página). En ejecución el fichero se
+// mapea en memoria y cada nivel va directo del mapeo a glTexSubImage2D.
+//
+// Formato: cabecera SkyboxCacheHeader, tabla de 'levels' SkyboxCacheLevel y
+// los datos de cada nivel en su offset.
+
+const char SKYBOX_CACHE_MAGIC[4] = {'B', 'H', 'S', 'K'};
+const uint32_t SKYBOX_CACHE_VERSION = 1;
+const uint64_t SKYBOX_CACHE_ALIGNMENT = 4096;
+
+struct SkyboxCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width, height;
+    uint32_t levels;
+    uint32_t reserved;
+    uint64_t sourceSize;     // Tamaño y fecha de la imagen original: si cambian,
+    int64_t sourceMtime;     // la caché está obsoleta
+};
+
+struct SkyboxCacheLevel {
+    uint64_t offset;
+    uint32_t width, height;
+};
+
+// Fichero mapeado en memoria (solo lectura)
+struct MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+bool mapFile(const std::string& path, MappedFile& mapped);
+void unmapFile(MappedFile& mapped);
+
+// textures/background.jpg -> textures/background.bhsky
+std::string skyboxCachePath(const std::string& sourcePath);
+
+// Conversor (--convert-skybox): decodifica, genera la cadena de mipmaps y escribe el .bhsky
+bool convertSkybox(const std::string& sourcePath, const std::string& cachePath);
+
+// Mapea la caché y comprueba cabecera, tabla de niveles y que no esté obsoleta
+// respecto a 'sourcePath'. Si devuelve true, el llamador tiene que hacer unmapFile().
+bool openSkyboxCache(const std::string& cachePath, const std::string& sourcePath, MappedFile& mapped);
+
+inline const SkyboxCacheHeader* skyboxCacheHeader(const MappedFile& mapped) {
+    return (const SkyboxCacheHeader*)mapped.data;
+}
+inline const SkyboxCacheLevel* skyboxCacheLevels(const MappedFile& mapped) {
+    return (const SkyboxCacheLevel*)(mapped.data + sizeof(SkyboxCacheHeader));
+}
+
+// Crea la textura desde la caché. Devuelve 0 si no existe o está obsoleta
+// respecto a 'sourcePath' (entonces hay que cargar la imagen original).
+unsigned int loadSkyboxCache(const std::string& cachePath, const std::string& sourcePath);
@@ -0,0 +1,173 @@
+#include "skybox_cube.h"
+#include "skybox_cache.h"
+#include "stb_image.h"
+#include "trace.h"
+#include <glad/gl.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+static const float PI = 3.14159265f;
+static const int CUBE_SUPERSAMPLE = 2; // Muestras por eje y texel (filtro de caja)
+
+int defaultCubeFaceSize(int equirectWidth) {
+    return std::clamp(equirectWidth / 4, 16, 4096);
+}
+
+vec3 cubeFaceDirection(int face, float s, float t) {
+    switch (face) {
+        case 0: return { 1.0f,   -t,   -s}; // +X
+        case 1: return {-1.0f,   -t,    s}; // -X
+        case 2: return {    s, 1.0f,    t}; // +Y
+        case 3: return {    s,-1.0f,   -t}; // -Y
+        case 4: return {    s,   -t, 1.0f}; // +Z
+        default: return {  -s,   -t,-1.0f}; // -Z
+    }
+}
+
+// Bilineal en el panorama con REPEAT en horizontal y CLAMP en vertical (como loadTexture)
+static void sampleEquirect(const unsigned char* pixels, int width, int height, int channels, float u, float v,
+                           float out[3]) {
+    float x = u * width - 0.5f;
+    float y = std::clamp(v * height - 0.5f, 0.0f, float(height - 1));
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+    int y1 = std::min(y0 + 1, height - 1);
+    int xa = ((x0 % width) + width) % width;
+    int xb = (xa + 1) % width;
+
+    const unsigned char* p00 = pixels + ((size_t)y0 * width + xa) * channels;
+    const unsigned char* p10 = pixels + ((size_t)y0 * width + xb) * channels;
+    const unsigned char* p01 = pixels + ((size_t)y1 * width + xa) * channels;
+    const unsigned char* p11 = pixels + ((size_t)y1 * width + xb) * channels;
+    for (int c = 0; c < 3; c++) {
+        float top = p00[c] + (p10[c] - p00[c]) * fx;
+        float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+        out[c] = top + (bottom - top) * fy;
+    }
+}
+
+void equirectToCube(const unsigned char* pixels, int width, int height, int channels, int faceSize,
+                    ThreadPool& pool, CubeSkybox& cube) {
+    TRACE_SCOPE("equirectToCube");
+    cube.faceSize = faceSize;
+    for (auto& face : cube.faces) face.resize((size_t)faceSize * faceSize * 4);
+
+    // Una fila de una cara por tarea: 6 * faceSize tareas para repartir
+    int rowCount = 6 * faceSize;
+    std::atomic<int> nextRow(0);
+    runOnPool(pool, [&](int) {
+        for (int row = nextRow++; row < rowCount; row = nextRow++) {
+            int face = row / faceSize;
+            int y = row % faceSize;
+            unsigned char* out = &cube.faces[face][(size_t)y * faceSize * 4];
+
+            for (int x = 0; x < faceSize; x++) {
+                float sum[3] = {0.0f, 0.0f, 0.0f};
+                for (int sy = 0; sy < CUBE_SUPERSAMPLE; sy++) {
+                    for (int sx = 0; sx < CUBE_SUPERSAMPLE; sx++) {
+                        float s = (x + (sx + 0.5f) / CUBE_SUPERSAMPLE) / faceSize * 2.0f - 1.0f;
+                        float t = (y + (sy + 0.5f) / CUBE_SUPERSAMPLE) / faceSize * 2.0f - 1.0f;
+                        vec3 d = normalize(cubeFaceDirection(face, s, t));
+                        // Mismo mapeo que el getBackground equirectangular
+                        float u = 0.5f + std::atan2(d.z, d.x) / (2.0f * PI);
+                        float v = 0.5f + std::asin(std::clamp(d.y, -1.0f, 1.0f)) / PI;
+                        float sample[3];
+                        sampleEquirect(pixels, width, height, channels, u, v, sample);
+                        for (int c = 0; c < 3; c++) sum[c] += sample[c];
+                    }
+                }
+                const float norm = 1.0f / (CUBE_SUPERSAMPLE * CUBE_SUPERSAMPLE);
+                for (int c = 0; c < 3; c++) out[x * 4 + c] = (unsigned char)std::lround(sum[c] * norm);
+                out[x * 4 + 3] = 255;
+            }
+        }
+    });
+}
+
+bool buildCubeSkybox(const std::string& sourcePath, int faceSize, ThreadPool& pool, CubeSkybox& cube) {
+    TRACE_SCOPE("buildCubeSkybox");
+    // El nivel 0 de la caché ya está decodificado: se remuestrea directamente desde el mapeo
+    MappedFile mapped;
+    if (openSkyboxCache(skyboxCachePath(sourcePath), sourcePath, mapped)) {
+        const SkyboxCacheHeader* header = skyboxCacheHeader(mapped);
+        const SkyboxCacheLevel& level = skyboxCacheLevels(mapped)[0];
+        if (faceSize <= 0) faceSize = defaultCubeFaceSize(header->width);
+        equirectToCube(mapped.data + level.offset, level.width, level.height, 4, faceSize, pool, cube);
+        unmapFile(mapped);
+    } else {
+        int width, height, channels;
+        unsigned char* data = stbi_load(sourcePath.c_str(), &width, &height, &channels, 3);
+        if (!data) {
+            std::cout << "ERROR: No se pudo cargar la textura: " << sourcePath << std::endl;
+            return false;
+        }
+        if (faceSize <= 0) faceSize = defaultCubeFaceSize(width);
+        equirectToCube(data, width, height, 3, faceSize, pool, cube);
+        stbi_image_free(data);
+    }
+    std::cout << "Cielo remuestreado a cubemap: 6 x " << cube.faceSize << "x" << cube.faceSize << std::endl;
+    return true;
+}
+
+unsigned int uploadCubeSkybox(const CubeSkybox& cube) {
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGBA8, cube.faceSize, cube.faceSize);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int face = 0; face < 6; face++) {
+        glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, cube.faceSize, cube.faceSize,
+                        GL_RGBA, GL_UNSIGNED_BYTE, cube.faces[face].data());
+    }
+    // Los compute shaders leen siempre el nivel 0: el filtrado ya se hizo al remuestrear
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    // Sin costuras entre caras al interpolar
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+    return textureID;
+}
+
+vec3 sampleCubeSkybox(const CubeSkybox& cube, const vec3& dir) {
+    // Cara = eje dominante; (sc, tc) según la tabla de OpenGL
+    float ax = std::fabs(dir.x), ay = std::fabs(dir.y), az = std::fabs(dir.z);
+    int face;
+    float sc, tc, ma;
+    if (ax >= ay && ax >= az) {
+        ma = ax;
+        face = dir.x > 0.0f ? 0 : 1;
+        sc = dir.x > 0.0f ? -dir.z : dir.z;
+        tc = -dir.y;
+    } else if (ay >= az) {
+        ma = ay;
+        face = dir.y > 0.0f ? 2 : 3;
+        sc = dir.x;
+        tc = dir.y > 0.0f ? dir.z : -dir.z;
+    } else {
+        ma = az;
+        face = dir.z > 0.0f ? 4 : 5;
+        sc = dir.z > 0.0f ? dir.x : -dir.x;
+        tc = -dir.y;
+    }
+    if (ma == 0.0f) return {0.0f, 0.0f, 0.0f};
+
+    int n = cube.faceSize;
+    float x = std::clamp((sc / ma * 0.5f + 0.5f) * n - 0.5f, 0.0f, float(n - 1));
+    float y = std::clamp((tc / ma * 0.5f + 0.5f) * n - 0.5f, 0.0f, float(n - 1));
+    int x0 = (int)x, y0 = (int)y;
+    int x1 = std::min(x0 + 1, n - 1), y1 = std::min(y0 + 1, n - 1);
+    float fx = x - x0, fy = y - y0;
+
+    const unsigned char* texels = cube.faces[face].data();
+    auto texel = [&](int tx, int ty) {
+        const unsigned char* p = &texels[((size_t)ty * n + tx) * 4];
+        return vec3{p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f};
+    };
+    vec3 top = texel(x0, y0) * (1.0f - fx) + texel(x1, y0) * fx;
+    vec3 bottom = texel(x0, y1) * (1.0f - fx) + texel(x1, y1) * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
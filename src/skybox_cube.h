@@ -0,0 +1,36 @@
+#pragma once
+#include "vec3.h"
+#include "thread_pool.h"
+#include <string>
+#include <vector>
+
+// --- CIELO EN CUBEMAP ---
+// getBackground() pasaba cada dirección a coordenadas equirectangulares con
+// atan + asin y en los polos leía filas enteras de la textura para unos pocos
+// píxeles. Al cargar, remuestreamos el panorama a un cubemap (en paralelo, con
+// 2x2 muestras por texel para filtrar) y tanto el shader como el trazador de
+// CPU buscan directamente por dirección.
+
+// Caras en el orden de OpenGL: +X, -X, +Y, -Y, +Z, -Z. RGBA8, fila 0 = t = -1.
+struct CubeSkybox {
+    int faceSize = 0;
+    std::vector<unsigned char> faces[6];
+};
+
+// Tamaño de cara por defecto: width/4 conserva la densidad del panorama en el ecuador
+int defaultCubeFaceSize(int equirectWidth);
+
+// Remuestrea un panorama equirectangular (filas de arriba a abajo, 'channels' de 8 bits)
+void equirectToCube(const unsigned char* pixels, int width, int height, int channels, int faceSize,
+                    ThreadPool& pool, CubeSkybox& cube);
+
+// Panorama -> cubemap desde la caché .bhsky (si es válida) o decodificando la imagen
+bool buildCubeSkybox(const std::string& sourcePath, int faceSize, ThreadPool& pool, CubeSkybox& cube);
+
+// Textura GL_TEXTURE_CUBE_MAP lista para el sampler skyboxCube de blackhole_common.glsl
+unsigned int uploadCubeSkybox(const CubeSkybox& cube);
+
+// Dirección del centro de (s, t) en [-1, 1] de una cara (convención de OpenGL)
+vec3 cubeFaceDirection(int face, float s, float t);
+// Lectura bilineal por dirección (sin filtrar entre caras)
+vec3 sampleCubeSkybox(const CubeSkybox& cube, const vec3& dir);
@@ -0,0 +1,128 @@
+#pragma once
+#include "vec3.h"
+#include <cfloat>
+#include <cmath>
+
+// --- ESPACIOS-TIEMPO DEL MOTOR PSEUDO-NEWTONIANO (POLÍTICAS) ---
+// La fuerza sale de la ecuación de Binet de la órbita nula, u'' + u = F(u) con
+// u = 1 / r, llevada a una aceleración central (con h² = 1, como siempre ha
+// hecho calculateAccel):
+//   Schwarzschild          F = 3/2 rs u²            a = -1.5 rs x / r⁵
+//   Reissner-Nordström     F = 3/2 rs u² - 2 Q² u³  a = (-1.5 rs / r⁵ + 2 Q² / r⁶) x
+//   Schwarzschild-de Sitter F = 3/2 rs u²  (Λ se cancela en la órbita de la luz)
+// Λ solo cambia los horizontes: el del agujero crece un poco y aparece uno
+// cosmológico; lo que lo cruza hacia fuera ya no vuelve y cuenta como escapado.
+// Igual que los integradores, el bucle del rayo es una plantilla sobre la
+// política: la elección se hace una vez por rayo. En la GPU son permutaciones
+// del shader (METRIC_CHARGE, METRIC_HORIZON, METRIC_ESCAPE; ver main.cpp).
+// Las escenas con varias lentes (SpacetimeMultiLens) están en lenses.h. Todas las
+// políticas se construyen con los mismos argumentos (rs, Q, Λ, escena) y cada una
+// usa los suyos.
+
+struct LensField;
+
+enum class SpacetimeKind { Schwarzschild, ReissnerNordstrom, SchwarzschildDeSitter, MultiLens };
+
+inline const char* spacetimeName(SpacetimeKind kind) {
+    switch (kind) {
+        case SpacetimeKind::Schwarzschild: return "schwarzschild";
+        case SpacetimeKind::ReissnerNordstrom: return "reissner-nordstrom";
+        case SpacetimeKind::SchwarzschildDeSitter: return "schwarzschild-de-sitter";
+        case SpacetimeKind::MultiLens: return "multi-lens";
+    }
+    return "?";
+}
+
+// --charge Q elige Reissner-Nordström y --lambda L Schwarzschild-de Sitter (no ambos)
+inline SpacetimeKind spacetimeFor(float charge, float lambda) {
+    if (charge != 0.0f) return SpacetimeKind::ReissnerNordstrom;
+    if (lambda != 0.0f) return SpacetimeKind::SchwarzschildDeSitter;
+    return SpacetimeKind::Schwarzschild;
+}
+
+// Radio del horizonte y radio a partir del cual el rayo ya ha escapado (FLT_MAX si
+// no hay horizonte cosmológico). Falso si con esos valores no hay agujero
+// (|Q| > rs / 2) o Λ es tan grande que los dos horizontes se juntan (9 Λ M² >= 1).
+// Con varias lentes cada una tiene el suyo (lenses.h): aquí se queda en rs.
+inline bool spacetimeHorizons(SpacetimeKind kind, float rs, float charge, float lambda, float& horizon,
+                              float& escape) {
+    horizon = rs;
+    escape = FLT_MAX;
+    if (kind == SpacetimeKind::ReissnerNordstrom) {
+        float disc = rs * rs - 4.0f * charge * charge;
+        if (disc < 0.0f) return false;
+        horizon = 0.5f * (rs + std::sqrt(disc)); // r+ (el interior r- no se llega a ver)
+    } else if (kind == SpacetimeKind::SchwarzschildDeSitter) {
+        if (lambda < 0.0f || 9.0f * lambda * (0.25f * rs * rs) >= 1.0f) return false;
+        if (lambda == 0.0f) return true;
+        // Raíces de r - rs - Λ r³ / 3 = 0 por Newton, desde rs y desde sqrt(3 / Λ).
+        // Se calcula por rayo (el bucle construye su política): cortar al converger
+        auto root = [rs, lambda](float r) {
+            for (int i = 0; i < 32; i++) {
+                float delta = (r - rs - lambda * r * r * r / 3.0f) / (1.0f - lambda * r * r);
+                r -= delta;
+                if (std::fabs(delta) <= 1e-6f * r) break;
+            }
+            return r;
+        };
+        horizon = root(rs);
+        escape = root(std::sqrt(3.0f / lambda));
+    }
+    return true;
+}
+
+struct SpacetimeSchwarzschild {
+    static constexpr SpacetimeKind kind = SpacetimeKind::Schwarzschild;
+    static constexpr bool barrier = true;      // Potencial de Schwarzschild: vale la clasificación de cpu_tracer.cpp
+    static constexpr bool escapeRadius = false;
+    static constexpr bool centered = true;     // Una sola lente en el origen: horizonte = esfera de radio 'horizon'
+    float rs, horizon, escape;
+
+    SpacetimeSchwarzschild(float rs_, float charge, float lambda, const LensField* /*lenses*/) : rs(rs_) {
+        spacetimeHorizons(kind, rs, charge, lambda, horizon, escape);
+    }
+    vec3 accel(const vec3& pos) const {
+        float r2 = dot(pos, pos);
+        float r = std::sqrt(r2);
+        // Gravedad Newtoniana modificada (Pseudo-Schwarzschild simple)
+        return pos * (-1.5f * rs / (r2 * r2 * r));
+    }
+    // a = -∇Φ: la energía del rayo E = |v|² / 2 + Φ se conserva
+    float potential(const vec3& pos) const {
+        float r = length(pos);
+        return -0.5f * rs / (r * r * r);
+    }
+};
+
+struct SpacetimeReissnerNordstrom {
+    static constexpr SpacetimeKind kind = SpacetimeKind::ReissnerNordstrom;
+    static constexpr bool barrier = false;     // Otra barrera (y un núcleo repulsivo): todo rayo pasa por el bucle completo
+    static constexpr bool escapeRadius = false;
+    static constexpr bool centered = true;
+    float rs, charge2, horizon, escape;
+
+    SpacetimeReissnerNordstrom(float rs_, float charge, float lambda, const LensField* /*lenses*/)
+        : rs(rs_), charge2(charge * charge) {
+        spacetimeHorizons(kind, rs, charge, lambda, horizon, escape);
+    }
+    vec3 accel(const vec3& pos) const {
+        float r2 = dot(pos, pos);
+        float r = std::sqrt(r2);
+        return pos * ((-1.5f * rs + 2.0f * charge2 / r) / (r2 * r2 * r));
+    }
+    float potential(const vec3& pos) const {
+        float r = length(pos);
+        float r3 = r * r * r;
+        return -0.5f * rs / r3 + 0.5f * charge2 / (r3 * r);
+    }
+};
+
+struct SpacetimeSchwarzschildDeSitter : SpacetimeSchwarzschild {
+    static constexpr SpacetimeKind kind = SpacetimeKind::SchwarzschildDeSitter;
+    static constexpr bool escapeRadius = true;
+
+    SpacetimeSchwarzschildDeSitter(float rs_, float charge, float lambda, const LensField* lenses)
+        : SpacetimeSchwarzschild(rs_, charge, 0.0f, lenses) {
+        spacetimeHorizons(kind, rs, charge, lambda, horizon, escape);
+    }
+};
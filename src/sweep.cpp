@@ -0,0 +1,238 @@
+#include "sweep.h"
+#include "cpu_tracer.h"
+#include "hdr.h"
+#include "image_io.h"
+#include "metrics.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct SweepEntry {
+    int row = 0;              // Número de imagen (orden en la tabla)
+    CameraState camera;
+    BlackHoleParams params;
+    float time = 0.0f;
+};
+
+enum class SweepColumn { X, Y, Z, Yaw, Pitch, Focal, Rs, DiskInner, DiskOuter, Spin, Time };
+
+static bool parseColumn(const std::string& name, SweepColumn& column) {
+    static const struct { const char* name; SweepColumn column; } COLUMNS[] = {
+        {"x", SweepColumn::X}, {"y", SweepColumn::Y}, {"z", SweepColumn::Z},
+        {"yaw", SweepColumn::Yaw}, {"pitch", SweepColumn::Pitch}, {"focal", SweepColumn::Focal},
+        {"rs", SweepColumn::Rs}, {"disk_inner", SweepColumn::DiskInner}, {"disk_outer", SweepColumn::DiskOuter},
+        {"spin", SweepColumn::Spin}, {"time", SweepColumn::Time}};
+    for (const auto& c : COLUMNS) {
+        if (name == c.name) {
+            column = c.column;
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        size_t first = field.find_first_not_of(" \t\r");
+        size_t last = field.find_last_not_of(" \t\r");
+        fields.push_back(first == std::string::npos ? "" : field.substr(first, last - first + 1));
+    }
+    return fields;
+}
+
+static bool loadSweepTable(const std::string& path, const BlackHoleParams& defaults,
+                           std::vector<SweepEntry>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "ERROR: No se pudo abrir la tabla del barrido: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<SweepColumn> columns;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::vector<std::string> fields = splitCsv(line);
+        if (fields.empty() || fields[0].empty() || fields[0][0] == '#') continue;
+
+        if (columns.empty()) {
+            for (const std::string& name : fields) {
+                SweepColumn column;
+                if (!parseColumn(name, column)) {
+                    std::cout << "ERROR: " << path << ":" << lineNumber << ": columna desconocida '" << name << "'"
+                              << std::endl;
+                    return false;
+                }
+                columns.push_back(column);
+            }
+            continue;
+        }
+        if (fields.size() != columns.size()) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": se esperaban " << columns.size()
+                      << " valores" << std::endl;
+            return false;
+        }
+
+        SweepEntry entry;
+        entry.row = (int)entries.size();
+        entry.params = defaults;
+        bool hasInner = false, hasOuter = false;
+        for (size_t c = 0; c < columns.size(); c++) {
+            char* end = nullptr;
+            float value = std::strtof(fields[c].c_str(), &end);
+            if (fields[c].empty() || *end != '\0') {
+                std::cout << "ERROR: " << path << ":" << lineNumber << ": valor no numérico '" << fields[c] << "'"
+                          << std::endl;
+                return false;
+            }
+            switch (columns[c]) {
+                case SweepColumn::X: entry.camera.x = value; break;
+                case SweepColumn::Y: entry.camera.y = value; break;
+                case SweepColumn::Z: entry.camera.z = value; break;
+                case SweepColumn::Yaw: entry.camera.yaw = value; break;
+                case SweepColumn::Pitch: entry.camera.pitch = value; break;
+                case SweepColumn::Focal: entry.camera.focal = value; break;
+                case SweepColumn::Rs: entry.params.rs = value; break;
+                case SweepColumn::DiskInner: entry.params.diskInner = value; hasInner = true; break;
+                case SweepColumn::DiskOuter: entry.params.diskOuter = value; hasOuter = true; break;
+                case SweepColumn::Spin: entry.params.kerr = true; entry.params.spin = value; break;
+                case SweepColumn::Time: entry.time = value; break;
+            }
+        }
+        // Sin radios explícitos, el disco escala con el horizonte (ISCO = 3 rs, borde = 6 rs)
+        if (!hasInner) entry.params.diskInner = 3.0f * entry.params.rs;
+        if (!hasOuter) entry.params.diskOuter = 6.0f * entry.params.rs;
+        if (entry.params.rs <= 0.0f || entry.params.diskInner <= 0.0f ||
+            entry.params.diskOuter <= entry.params.diskInner) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": hace falta rs > 0 y 0 < disk_inner < disk_outer"
+                      << std::endl;
+            return false;
+        }
+        float horizon, escape;
+        if (!entry.params.kerr && !spacetimeHorizons(entry.params.spacetime, entry.params.rs, entry.params.charge,
+                                                     entry.params.lambda, horizon, escape)) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": con este rs, --charge o --lambda no dejan horizonte"
+                      << std::endl;
+            return false;
+        }
+        if (entry.params.kerr && entry.params.spacetime != SpacetimeKind::Schwarzschild) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": la columna spin no admite --charge, --lambda ni varias lentes"
+                      << std::endl;
+            return false;
+        }
+        if (entry.params.spin < -0.999f || entry.params.spin > 0.999f) {
+            std::cout << "ERROR: " << path << ":" << lineNumber << ": spin debe estar entre -0.999 y 0.999"
+                      << std::endl;
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    if (entries.empty()) {
+        std::cout << "ERROR: La tabla del barrido no tiene filas: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Lo que determina las geodésicas: dos filas con la misma clave comparten el trazado
+static auto geodesicKey(const SweepEntry& e) {
+    return std::make_tuple(e.camera.x, e.camera.y, e.camera.z, e.camera.yaw, e.camera.pitch, e.camera.focal,
+                           e.params.rs, e.params.diskInner, e.params.diskOuter, e.params.kerr, e.params.spin);
+}
+
+int runSweep(const AppConfig& config) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepEntry> entries;
+    BlackHoleParams defaults;
+    defaults.kerr = config.kerr;
+    defaults.spin = config.kerrSpin;
+    defaults.analytic = config.analytic;
+    parseIntegratorKind(config.integrator, defaults.integrator);
+    defaults.nullRenorm = config.nullRenorm;
+    defaults.rayClasses = config.rayClasses;
+    defaults.fastMath = config.fastMath;
+    defaults.diskOpacity = config.diskOpacity;  // Filas con spin: Kerr para en el primer cruce (opaco)
+    defaults.diskOrders = config.diskOrders;
+    defaults.spacetime = spacetimeFor(config.charge, config.lambda);
+    defaults.charge = config.charge;
+    defaults.lambda = config.lambda;
+    if (!lensFieldFromConfig(config, defaults.lenses)) return -1;
+    if (defaults.lenses) defaults.spacetime = SpacetimeKind::MultiLens; // La columna rs ya no cambia las lentes
+    if (!loadSweepTable(config.sweepPath, defaults, entries)) return -1;
+
+    CpuTracer tracer;
+    if (config.numa) tracer.numaNodes = config.numaNodes > 0 ? config.numaNodes : 1 << 16;
+    tracer.hugePages = config.hugePages;
+    int cubeFaceSize = config.equirectSkybox ? -1 : config.skyboxFaceSize;
+    if (!startCpuTracer(tracer, config.threads, config.skyboxPath.c_str(), cubeFaceSize,
+                        config.diskNoiseSize, config.diskOctaves)) return -1;
+    double setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Agrupar por cámara + agujero; dentro de cada grupo, por tiempo
+    std::vector<int> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return std::make_tuple(geodesicKey(entries[a]), entries[a].time) <
+               std::make_tuple(geodesicKey(entries[b]), entries[b].time);
+    });
+
+    CpuFrame frame;
+    frame.width = config.width;
+    frame.height = config.height;
+    std::vector<RayOutcome> outcomes;
+    int groups = 0;
+    long long rays = 0, steps = 0;
+    double traceMs = 0.0, shadeMs = 0.0, writeMs = 0.0;
+    auto sweepStart = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < order.size(); i++) {
+        const SweepEntry& entry = entries[order[i]];
+        if (i == 0 || geodesicKey(entry) != geodesicKey(entries[order[i - 1]])) {
+            TRACE_SCOPE("sweepGroup");
+            tracer.params = entry.params;
+            CpuFrameStats stats;
+            traceOutcomesCPU(tracer, entry.camera, frame.width, frame.height, outcomes, stats);
+            traceMs += stats.ms;
+            rays += stats.rays;
+            steps += stats.steps;
+            groups++;
+        }
+
+        auto shadeStart = std::chrono::steady_clock::now();
+        shadeOutcomesCPU(tracer, outcomes, entry.time, frame);
+        auto shadeEnd = std::chrono::steady_clock::now();
+        shadeMs += std::chrono::duration<double, std::milli>(shadeEnd - shadeStart).count();
+        countMetric(MetricCounter::Frames);
+
+        if (!config.outputDir.empty()) {
+            // Imágenes independientes: exposición ya adaptada a la luminancia de cada una
+            LuminanceStats lumStats = computeLuminanceStatsCPU(frame.rgb.data(), frame.width * frame.height, 1.0f);
+            float exposure = updateExposure(1.0f, lumStats, 1e6f);
+            char name[64];
+            std::snprintf(name, sizeof(name), "/sweep_%05d.ppm", entry.row);
+            writeImagePPM(config.outputDir + name, frame.rgb.data(), frame.width, frame.height, exposure);
+            writeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shadeEnd).count();
+        }
+    }
+    double sweepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sweepStart).count();
+    stopCpuTracer(tracer);
+
+    std::cout << "Barrido: " << entries.size() << " imágenes en " << sweepMs / 1000.0 << " s ("
+              << entries.size() / (sweepMs / 1000.0) << " imágenes/s), preparación " << setupMs << " ms" << std::endl;
+    std::cout << "  " << groups << " grupos de cámara + agujero: trazado " << traceMs << " ms ("
+              << rays / (traceMs / 1000.0) / 1e6 << " Mrayos/s, " << double(steps) / rays << " pasos/rayo), sombreado "
+              << shadeMs << " ms, escritura " << writeMs << " ms" << std::endl;
+    return 0;
+}
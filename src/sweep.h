@@ -0,0 +1,15 @@
+#pragma once
+#include "config.h"
+
+// --- BARRIDO DE PARÁMETROS ---
+// Genera muchas imágenes en un solo proceso a partir de una tabla CSV: el
+// trazador de CPU (hilos, cielo, ruido del disco) se prepara una vez. Las
+// filas con la misma cámara y el mismo agujero (rs y radios del disco) se
+// agrupan: sus geodésicas se trazan una sola vez y solo se vuelve a sombrear
+// para cada instante.
+//
+// Cabecera con cualquier subconjunto de: x,y,z,yaw,pitch,focal,rs,disk_inner,disk_outer,spin,time
+// (lo que falte toma el valor por defecto; los radios del disco, 3 rs y 6 rs; la columna
+// spin traza esa fila con el motor de Kerr, sin ella manda --kerr).
+// Líneas vacías y las que empiezan por '#' se ignoran. Salida: sweep_NNNNN.ppm por fila.
+int runSweep(const AppConfig& config);
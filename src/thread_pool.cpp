@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <string>
+
+static void workerLoop(ThreadPool* pool, int index, int cpu) {
+    setTraceThreadName("worker " + std::to_string(index));
+    // Antes de tocar memoria: lo que este hilo escriba primero quedará en su nodo
+    if (cpu >= 0) pinCurrentThread(cpu);
+    long seenGeneration = 0;
+    while (true) {
+        std::function<void(int)> job;
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->wake.wait(lock, [&] { return pool->quit || pool->generation != seenGeneration; });
+            if (pool->quit) return;
+            seenGeneration = pool->generation;
+            job = pool->job;
+        }
+
+        job(index);
+
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (--pool->pending == 0) pool->done.notify_all();
+    }
+}
+
+void startThreadPool(ThreadPool& pool, int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    pool.quit = false;
+    pool.nodeCount = 1;
+    pool.workerNode.assign(threads, 0);
+    for (int i = 0; i < threads; i++) {
+        pool.workers.emplace_back(workerLoop, &pool, i, -1);
+    }
+}
+
+void startThreadPoolNuma(ThreadPool& pool, int threads, const NumaTopology& topology, int nodes) {
+    nodes = std::max(1, std::min(nodes, (int)topology.nodeCpus.size()));
+    if (threads <= 0) threads = numaCpuCount(topology, nodes);
+
+    pool.quit = false;
+    pool.nodeCount = nodes;
+    pool.workerNode.resize(threads);
+    for (int i = 0; i < threads; i++) {
+        // Bloques contiguos de hilos por nodo; dentro del nodo, CPUs en orden
+        int node = (int)((long long)i * nodes / threads);
+        int firstInNode = (int)(((long long)node * threads + nodes - 1) / nodes);
+        const std::vector<int>& cpus = topology.nodeCpus[node];
+        int cpu = cpus[(i - firstInNode) % cpus.size()];
+        pool.workerNode[i] = node;
+        pool.workers.emplace_back(workerLoop, &pool, i, cpu);
+    }
+}
+
+void stopThreadPool(ThreadPool& pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.quit = true;
+    }
+    pool.wake.notify_all();
+    for (std::thread& worker : pool.workers) worker.join();
+    pool.workers.clear();
+    pool.workerNode.clear();
+}
+
+int threadPoolSize(const ThreadPool& pool) {
+    return (int)pool.workers.size();
+}
+
+void runOnPool(ThreadPool& pool, const std::function<void(int)>& job) {
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.job = job;
+    pool.pending = (int)pool.workers.size();
+    pool.generation++;
+    pool.wake.notify_all();
+    pool.done.wait(lock, [&] { return pool.pending == 0; });
+}
+
+void initNodeWorkQueue(NodeWorkQueue& queue, int count, int nodeCount) {
+    queue.nodeCount = nodeCount;
+    queue.begin.resize(nodeCount);
+    queue.end.resize(nodeCount);
+    queue.next.reset(new std::atomic<int>[nodeCount]);
+    for (int n = 0; n < nodeCount; n++) {
+        queue.begin[n] = (int)((long long)count * n / nodeCount);
+        queue.end[n] = (int)((long long)count * (n + 1) / nodeCount);
+        queue.next[n] = queue.begin[n];
+    }
+}
+
+int takeNodeWork(NodeWorkQueue& queue, int node) {
+    for (int k = 0; k < queue.nodeCount; k++) {
+        int n = (node + k) % queue.nodeCount;
+        if (queue.next[n].load(std::memory_order_relaxed) >= queue.end[n]) continue;
+        int index = queue.next[n]++;
+        if (index < queue.end[n]) return index;
+    }
+    return -1;
+}
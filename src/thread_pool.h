@@ -0,0 +1,51 @@
+#pragma once
+#include "numa.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// --- POOL DE HILOS PERSISTENTE ---
+// Los hilos se crean una vez y esperan trabajo. runOnPool() ejecuta la misma
+// función en todos los hilos (cada uno recibe su índice) y espera a que
+// terminen; el reparto del trabajo (teselas) lo hace la propia función.
+struct ThreadPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void(int)> job;
+    long generation = 0;  // Se incrementa con cada trabajo nuevo
+    int pending = 0;      // Hilos que aún no han terminado el trabajo actual
+    bool quit = false;
+
+    int nodeCount = 1;              // Nodos NUMA en uso
+    std::vector<int> workerNode;    // Nodo de cada hilo (todos 0 sin NUMA)
+};
+
+// threads <= 0 usa std::thread::hardware_concurrency()
+void startThreadPool(ThreadPool& pool, int threads);
+// Reparte los hilos en bloques entre los 'nodes' primeros nodos y fija cada
+// uno a una CPU de su nodo. threads <= 0 = una por CPU de esos nodos.
+void startThreadPoolNuma(ThreadPool& pool, int threads, const NumaTopology& topology, int nodes);
+void stopThreadPool(ThreadPool& pool);
+int threadPoolSize(const ThreadPool& pool);
+
+// Ejecuta job(workerIndex) en todos los hilos y bloquea hasta que acaben
+void runOnPool(ThreadPool& pool, const std::function<void(int)>& job);
+
+// Índices [0, count) repartidos en franjas contiguas, una por nodo. Los hilos
+// vacían primero la franja de su nodo (memoria local) y después ayudan a las
+// demás, así un nodo más lento no deja a los otros parados.
+struct NodeWorkQueue {
+    int nodeCount = 0;
+    std::vector<int> begin, end;
+    std::unique_ptr<std::atomic<int>[]> next;
+};
+
+void initNodeWorkQueue(NodeWorkQueue& queue, int count, int nodeCount);
+// Siguiente índice para un hilo del nodo 'node', o -1 si ya no queda trabajo
+int takeNodeWork(NodeWorkQueue& queue, int node);
@@ -0,0 +1,44 @@
+#include "timing_report.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+void addFrameTiming(TimingReport& report, double cpuMs, double waitMs, double gpuMs) {
+    report.cpuMs.push_back(cpuMs);
+    report.waitMs.push_back(waitMs);
+    report.gpuMs.push_back(gpuMs);
+}
+
+// Media, p50, p95 y máximo de una serie (ignorando valores negativos)
+static void printSeries(const char* name, std::vector<double> values) {
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return v < 0.0; }), values.end());
+    if (values.empty()) return;
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    auto percentile = [&](double p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+
+    std::cout << "  " << name << ": media " << sum / values.size() << " ms, p50 " << percentile(0.50)
+              << " ms, p95 " << percentile(0.95) << " ms, máx " << values.back() << " ms" << std::endl;
+}
+
+void writeTimingReport(const TimingReport& report, const std::string& path) {
+    if (!path.empty()) {
+        std::ofstream file(path);
+        if (!file) {
+            std::cout << "ERROR: No se pudo escribir el informe de tiempos: " << path << std::endl;
+        } else {
+            file << "frame,cpu_ms,wait_ms,gpu_ms\n";
+            for (size_t i = 0; i < report.cpuMs.size(); i++) {
+                file << i << "," << report.cpuMs[i] << "," << report.waitMs[i] << "," << report.gpuMs[i] << "\n";
+            }
+            std::cout << "Informe de tiempos guardado en " << path << std::endl;
+        }
+    }
+
+    std::cout << "Tiempos por frame (" << report.cpuMs.size() << " frames):" << std::endl;
+    printSeries("CPU", report.cpuMs);
+    printSeries("Esperas (ranura y vsync)", report.waitMs);
+    printSeries("GPU", report.gpuMs);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// --- INFORME DE TIEMPOS POR FRAME ---
+// Para comparar cambios del trazador sobre la misma secuencia de frames
+// (reproducción de un recorrido). cpuMs es el trabajo del frame; las esperas
+// de ritmo (ranura libre y vsync) van aparte en waitMs para que no tapen los
+// cambios del trazador. Negativo significa "no medido".
+struct TimingReport {
+    std::vector<double> cpuMs;
+    std::vector<double> waitMs;
+    std::vector<double> gpuMs;
+};
+
+void addFrameTiming(TimingReport& report, double cpuMs, double waitMs, double gpuMs);
+// CSV (frame,cpu_ms,wait_ms,gpu_ms) si 'path' no está vacío, más un resumen por consola
+void writeTimingReport(const TimingReport& report, const std::string& path);
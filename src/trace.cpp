@@ -0,0 +1,165 @@
+#include "trace.h"
+#include <glad/gl.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+struct TraceEvent {
+    const char* name;
+    int64_t startUs;
+    int64_t durationUs;
+};
+
+// Buffer de un hilo: solo lo toca su dueño hasta writeTrace()
+struct TraceThreadBuffer {
+    int tid = 0;
+    std::string name;
+    std::vector<TraceEvent> events;
+};
+
+static const int GPU_TRACE_TID = 0; // Pista "GPU" del visor
+
+static std::atomic<bool> traceOn(false);
+static std::chrono::steady_clock::time_point traceEpoch;
+static std::mutex traceBuffersMutex; // Solo al registrar un hilo nuevo y al escribir
+static std::vector<std::unique_ptr<TraceThreadBuffer>> traceBuffers;
+static std::vector<TraceEvent> gpuEvents; // Las escribe el hilo que tiene el contexto GL
+
+static TraceThreadBuffer& localBuffer() {
+    thread_local TraceThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(traceBuffersMutex);
+        traceBuffers.emplace_back(new TraceThreadBuffer());
+        buffer = traceBuffers.back().get();
+        buffer->tid = (int)traceBuffers.size();
+        buffer->name = "hilo " + std::to_string(buffer->tid);
+        buffer->events.reserve(4096);
+    }
+    return *buffer;
+}
+
+void startTrace() {
+    traceEpoch = std::chrono::steady_clock::now();
+    traceOn = true;
+    setTraceThreadName("main");
+}
+
+bool traceEnabled() {
+    return traceOn.load(std::memory_order_relaxed);
+}
+
+void setTraceThreadName(const std::string& name) {
+    if (!traceEnabled()) return;
+    localBuffer().name = name;
+}
+
+int64_t traceNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void addTraceEvent(const char* name, int64_t startUs, int64_t durationUs) {
+    if (!traceEnabled()) return;
+    localBuffer().events.push_back({name, startUs, durationUs});
+}
+
+TraceScope::TraceScope(const char* name) : name(name), startUs(traceEnabled() ? traceNowUs() : 0) {}
+
+TraceScope::~TraceScope() {
+    if (traceEnabled()) addTraceEvent(name, startUs, traceNowUs() - startUs);
+}
+
+static void writeEvents(std::ofstream& file, const std::vector<TraceEvent>& events, int tid, bool& first) {
+    for (const TraceEvent& e : events) {
+        file << (first ? "\n" : ",\n") << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"ts\":" << e.startUs
+             << ",\"dur\":" << e.durationUs << ",\"pid\":1,\"tid\":" << tid << "}";
+        first = false;
+    }
+}
+
+static void writeThreadName(std::ofstream& file, int tid, const std::string& name, bool& first) {
+    file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+         << ",\"args\":{\"name\":\"" << name << "\"}}";
+    first = false;
+}
+
+bool writeTrace(const std::string& path) {
+    if (!traceEnabled()) return true;
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "ERROR: No se pudo escribir la traza: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(traceBuffersMutex);
+    size_t eventCount = gpuEvents.size();
+    bool first = true;
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    if (!gpuEvents.empty()) {
+        writeThreadName(file, GPU_TRACE_TID, "GPU", first);
+        writeEvents(file, gpuEvents, GPU_TRACE_TID, first);
+    }
+    for (const auto& buffer : traceBuffers) {
+        writeThreadName(file, buffer->tid, buffer->name, first);
+        writeEvents(file, buffer->events, buffer->tid, first);
+        eventCount += buffer->events.size();
+    }
+    file << "\n]}\n";
+
+    std::cout << "Traza: " << eventCount << " eventos en " << path << std::endl;
+    return (bool)file;
+}
+
+// --- GPU ---
+
+static int64_t traceNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void beginGpuTraceFrame(GpuTrace& trace) {
+    if (!traceEnabled()) return;
+    if (!trace.calibrated) {
+        // Lectura síncrona del reloj de la GPU: solo una vez, para alinear los dos relojes
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        trace.gpuToCpuOffsetNs = traceNowNs() - gpuNow;
+        trace.calibrated = true;
+    }
+    trace.pendingFrames.emplace_back();
+    markGpuTrace(trace, nullptr);
+}
+
+void markGpuTrace(GpuTrace& trace, const char* stageName) {
+    if (!traceEnabled() || trace.pendingFrames.empty()) return;
+    unsigned int query;
+    glGenQueries(1, &query);
+    glQueryCounter(query, GL_TIMESTAMP);
+    trace.pendingFrames.back().push_back({stageName, query});
+}
+
+void collectGpuTrace(GpuTrace& trace, bool wait) {
+    while (!trace.pendingFrames.empty()) {
+        std::vector<GpuTraceMark>& marks = trace.pendingFrames.front();
+        // Las marcas se completan en orden: si la última está, están todas
+        if (!wait && !marks.empty()) {
+            GLint available = 0;
+            glGetQueryObjectiv(marks.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+        }
+
+        int64_t previousNs = 0;
+        for (size_t i = 0; i < marks.size(); i++) {
+            GLuint64 gpuNs = 0;
+            glGetQueryObjectui64v(marks[i].query, GL_QUERY_RESULT, &gpuNs);
+            glDeleteQueries(1, &marks[i].query);
+
+            int64_t cpuNs = (int64_t)gpuNs + trace.gpuToCpuOffsetNs;
+            if (i > 0 && marks[i].name) gpuEvents.push_back({marks[i].name, previousNs / 1000, (cpuNs - previousNs) / 1000});
+            previousNs = cpuNs;
+        }
+        trace.pendingFrames.pop_front();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// --- LÍNEA DE TIEMPO (Chrome trace-event JSON, se abre en Perfetto / chrome://tracing) ---
+// Marcadores con ámbito (TraceScope) en el bucle principal, la carga de
+// texturas y shaders y los hilos del trazador de CPU. Cada hilo apunta sus
+// eventos en su propio buffer, sin locks; el fichero se escribe al final,
+// cuando ya no queda ningún hilo de trabajo activo.
+// Desactivado (sin --trace) cada marcador cuesta una comprobación de un bool.
+
+void startTrace();
+bool traceEnabled();
+// Nombre del hilo actual en el visor (por defecto "hilo N")
+void setTraceThreadName(const std::string& name);
+// Microsegundos desde startTrace()
+int64_t traceNowUs();
+void addTraceEvent(const char* name, int64_t startUs, int64_t durationUs);
+
+// 'name' tiene que vivir hasta writeTrace (normalmente un literal)
+struct TraceScope {
+    const char* name;
+    int64_t startUs;
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+bool writeTrace(const std::string& path);
+
+// --- TIEMPOS DE GPU EN LA MISMA LÍNEA ---
+// Una query GL_TIMESTAMP por marca; cada etapa va de la marca anterior a la
+// suya. El reloj de la GPU se traslada al de la CPU con una lectura síncrona
+// de GL_TIMESTAMP al empezar. Las queries se leen cuando están disponibles.
+struct GpuTraceMark {
+    const char* name;     // Etapa que termina en esta marca (nullptr = inicio del frame)
+    unsigned int query;
+};
+
+struct GpuTrace {
+    std::deque<std::vector<GpuTraceMark>> pendingFrames;
+    bool calibrated = false;
+    int64_t gpuToCpuOffsetNs = 0;  // tiempo CPU (ns desde startTrace) - tiempo GPU
+};
+
+void beginGpuTraceFrame(GpuTrace& trace);
+void markGpuTrace(GpuTrace& trace, const char* stageName);
+// wait = true bloquea hasta tener todas las queries (al salir)
+void collectGpuTrace(GpuTrace& trace, bool wait);
@@ -0,0 +1,27 @@
+#pragma once
+#include <cmath>
+
+//--- ESTRUCTURA MATEMÁTICA VECTORIAL ---
+struct vec3 {
+    float x,y,z;
+
+    //Sobrecarga de operadores para facilitar las matemáticas
+    vec3 operator+(const vec3& v) const {return {x + v.x, y + v.y, z + v.z};}
+    vec3 operator-(const vec3& v) const {return {x - v.x, y - v.y, z - v.z};}
+    vec3 operator*(float s) const {return {x * s, y * s, z * s};}
+
+    //Necesario para la física: Producto Cruz
+    vec3 cross(const vec3& v) const {
+        return{y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x};
+    }
+};
+
+//Funciones auxiliares para vectores
+inline float dot(const vec3& a, const vec3& b){return a.x*b.x + a.y*b.y + a.z*b.z;}
+inline float length_sq(const vec3& v){return dot(v,v);}
+inline float length(const vec3& v){return std::sqrt(length_sq(v));}
+
+inline vec3 normalize(const vec3& v){
+    float len = length(v);
+    return (len > 0) ? vec3{v.x/len, v.y/len, v.z/len} : vec3{0,0,0};
+}